@@ -585,6 +585,10 @@ Status CheckCompletion(BehaviourClient& c)
     blackboard.Set("CheckCompletion.log_errors", false);
     blackboard.Set("CheckCompletion.full_check", false);
 
+    // Copy the whole structure area at once instead of locking the world for each block
+    const std::vector<const Blockstate*> world_blocks = world->GetBlocks(start, end);
+    const Position size = end - start + Position(1, 1, 1);
+
     for (int x = start.x; x <= end.x; ++x)
     {
         world_pos.x = x;
@@ -599,7 +603,7 @@ Status CheckCompletion(BehaviourClient& c)
                 target_pos.z = z - start.z;
 
                 const short target_id = target[target_pos.x][target_pos.y][target_pos.z];
-                const Blockstate* blockstate = world->GetBlock(world_pos);
+                const Blockstate* blockstate = world_blocks[(target_pos.y * size.z + target_pos.z) * size.x + target_pos.x];
                 if (blockstate == nullptr)
                 {
                     if (target_id != -1)
@@ -4,6 +4,7 @@
 #include <botcraft/Game/Vector3.hpp>
 #include <botcraft/Game/World/World.hpp>
 #include <botcraft/AI/SimpleBehaviourClient.hpp>
+#include <botcraft/Network/NetworkManager.hpp>
 #include <botcraft/Utilities/Logger.hpp>
 #include <botcraft/Utilities/SleepUtilities.hpp>
 
@@ -97,9 +98,13 @@ int main(int argc, char* argv[])
             names[i] = i < base_names.size() ? base_names[i] : (base_names[i % base_names.size()] + std::to_string(i / base_names.size()));
             // Create the bot client and connect to the server
             clients[i] = std::make_shared<WorldEaterClient>(args.stopword, false);
+            // Bots sharing a world also share their pathfinding graph, and all bots compute their paths on the same threads
             clients[i]->SetSharedWorld(shared_worlds[i % args.num_world]);
             clients[i]->SetAutoRespawn(true);
             clients[i]->Connect(args.address, names[i], false);
+            // Many bots, don't spend time parsing packets they don't use
+            clients[i]->GetNetworkManager()->SetSkipUnhandledPackets(true);
+            clients[i]->GetNetworkManager()->SetLazyParsing(true);
             // Start behaviour thread and set active tree
             clients[i]->StartBehaviour();
             clients[i]->SetBehaviourTree(eater_behaviour_tree, { 
@@ -5,6 +5,9 @@
 
 namespace Botcraft
 {
+    class PathfindingGraph;
+    class PathfindingService;
+
     /// @brief A ManagersClient extended with a blackboard that can store any
     /// kind of data and a virtual Yield function.
     /// You should **not** inherit from this class, but from TemplatedBehaviourClient
@@ -12,6 +15,9 @@ namespace Botcraft
     class BehaviourClient : public ManagersClient, private BlackboardObserver
     {
     public:
+        /// @brief Create a client. Unless SetSharedPathfindingService is called, all
+        /// clients compute their paths on the same default PathfindingService, and
+        /// clients using the same World share the same default PathfindingGraph
         BehaviourClient(const bool use_renderer_);
         virtual ~BehaviourClient();
 
@@ -19,6 +25,24 @@ namespace Botcraft
 
         Blackboard& GetBlackboard();
 
+        /// @brief Set the graph used to plan long paths. Clients using the same
+        /// World can share the same graph, so clusters are computed only once
+        /// @param graph The graph to use
+        void SetSharedPathfindingGraph(const std::shared_ptr<PathfindingGraph> graph);
+
+        /// @brief Get the graph used to plan long paths
+        /// @return The graph set with SetSharedPathfindingGraph, or the default graph of this client World
+        std::shared_ptr<PathfindingGraph> GetPathfindingGraph() const;
+
+        /// @brief Set the threads used to compute paths. Clients can share the same
+        /// service so they don't each need their own pathfinding thread
+        /// @param service The service to use
+        void SetSharedPathfindingService(const std::shared_ptr<PathfindingService> service);
+
+        /// @brief Get the threads used to compute paths
+        /// @return The service set with SetSharedPathfindingService, or the default service shared by all clients
+        std::shared_ptr<PathfindingService> GetPathfindingService() const;
+
     public:
         void OnReset() override;
         void OnValueChanged(const std::string& key, const std::any& value) override;
@@ -26,5 +50,8 @@ namespace Botcraft
 
     protected:
         Blackboard blackboard;
+        /// @brief nullptr to use the default graph of the client World
+        std::shared_ptr<PathfindingGraph> pathfinding_graph;
+        std::shared_ptr<PathfindingService> pathfinding_service;
     };
 } // namespace Botcraft
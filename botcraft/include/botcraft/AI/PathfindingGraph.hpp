@@ -0,0 +1,98 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "botcraft/Game/Vector3.hpp"
+
+namespace Botcraft
+{
+    class PathfindingGrid;
+    class PathfindingSearch;
+    class World;
+
+    /// @brief Abstract graph of the world used to plan long paths. Each chunk section is
+    /// a cluster, linked to its neighbours by the moves crossing its borders (one move for
+    /// each contiguous portal). Clusters are computed the first time a search goes through
+    /// them and kept until blocks around them are modified, so later searches only
+    /// recompute the sections that changed. Paths are first searched in this graph, then
+    /// refined with FindPath between the portals.
+    /// Can be shared between clients using the same World. Thread-safe, the lock is only
+    /// held to get or store clusters, so multiple searches can run at the same time
+    class PathfindingGraph
+    {
+    public:
+        /// @param max_clusters_ Max number of clusters kept in memory, the least recently used ones are removed first. 0 for no limit
+        PathfindingGraph(const size_t max_clusters_ = 8192);
+        ~PathfindingGraph();
+
+        /// @brief Find a path between two positions far from each other
+        /// @param world World to search the path in
+        /// @param start Start position
+        /// @param end Goal position
+        /// @param allow_jump If true, allow to jump above 1-wide gaps
+        /// @param take_damage If true, avoid walking through or on hazardous blocks
+        /// @param budget_visit Max number of explored portals before stopping the search
+        /// @param cancelled If not nullptr, the search is stopped as soon as it's set to true
+        /// @return A vector of positions to go through to enter the section containing end, start excluded. If not possible,
+        /// a path to the portal the closest to end. Empty if start and end are in the same section, no portal is closer to end or cancelled
+        std::vector<Position> FindPath(const World& world, const Position& start, const Position& end, const bool allow_jump, const bool take_damage, const int budget_visit = 20000, const std::atomic<bool>* cancelled = nullptr);
+
+        /// @brief Remove all the computed clusters
+        void Clear();
+
+        /// @brief Get the number of computed clusters
+        /// @return The number of clusters kept in memory
+        size_t GetNumClusters() const;
+
+    private:
+        /// @brief A move from a cluster to another
+        struct Transition
+        {
+            Position from;
+            Position to;
+            float cost;
+        };
+
+        struct Cluster;
+        using ClusterMap = std::unordered_map<uint64_t, std::shared_ptr<Cluster>>;
+
+        /// @brief Get a cluster, computing it if it doesn't exist or is outdated. Must be called without holding the mutex
+        /// @param world World the cluster is in
+        /// @param grid Blocks of the current search
+        /// @param section Coordinates of the cluster section
+        /// @param allow_jump If true, allow to jump above 1-wide gaps
+        /// @param cluster_map Clusters computed with the same allow_jump/take_damage values
+        /// @return The up to date cluster, kept valid even if it's removed from the graph in the meantime
+        std::shared_ptr<Cluster> GetCluster(const World& world, PathfindingGrid& grid, const Position& section, const bool allow_jump, ClusterMap& cluster_map);
+
+        /// @brief Remove the least recently used clusters if there are more than max_clusters. Must be called with the mutex held
+        void EvictClusters();
+
+        /// @brief Find all the exits of a cluster reachable from a position without leaving it
+        /// @param cluster Cluster to search in
+        /// @param section Coordinates of the cluster section
+        /// @param grid Blocks of the current search
+        /// @param search Search used for the local exploration
+        /// @param pos Position in the cluster
+        /// @param allow_jump If true, allow to jump above 1-wide gaps
+        /// @return Index of all reachable exits and the cost to reach their start
+        std::vector<std::pair<size_t, float>> GetReachableExits(const Cluster& cluster, const Position& section,
+            PathfindingGrid& grid, PathfindingSearch& search, const Position& pos, const bool allow_jump) const;
+
+    private:
+        const size_t max_clusters;
+
+        mutable std::mutex mutex;
+        /// @brief Computed clusters for each allow_jump/take_damage combination
+        std::array<ClusterMap, 4> clusters;
+        /// @brief Incremented each time a cluster is used, to find the least recently used ones
+        uint64_t use_counter;
+    };
+} // Botcraft
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "botcraft/Game/Vector3.hpp"
+
+namespace Botcraft
+{
+    /// @brief A fixed number of threads computing paths so the behaviour
+    /// threads can keep running (and yielding) during long searches. Can be
+    /// shared between multiple clients (see BehaviourClient::SetSharedPathfindingService)
+    /// so they don't each need their own pathfinding thread.
+    class PathfindingService
+    {
+    public:
+        /// @brief Function computing a path. The bool is set when the request
+        /// is cancelled, the search can be stopped early if it's the case
+        using Search = std::function<std::vector<Position>(const std::atomic<bool>&)>;
+
+        /// @brief A search submitted to the service
+        class Request
+        {
+        public:
+            /// @brief Check if the search is finished (or was cancelled)
+            /// @return True if GetPath can be called
+            bool IsDone() const;
+
+            /// @brief Ask for the search to stop as soon as possible. The result is then empty
+            void Cancel();
+
+            /// @brief Check if the request has been cancelled
+            /// @return True if Cancel was called or the request was replaced by a newer one
+            bool IsCancelled() const;
+
+            /// @brief Get the computed path. Should only be called once IsDone returns true
+            /// @return The result of the search, empty if cancelled
+            const std::vector<Position>& GetPath() const;
+
+        private:
+            friend class PathfindingService;
+
+            const void* owner = nullptr;
+            Search search;
+            std::atomic<bool> cancelled = false;
+            std::atomic<bool> done = false;
+            std::vector<Position> path;
+        };
+
+        /// @brief Create a service. Threads are started when the first request is submitted
+        /// @param num_threads Number of pathfinding threads, if 0 std::thread::hardware_concurrency() is used
+        PathfindingService(const unsigned int num_threads = 1);
+        ~PathfindingService();
+
+        PathfindingService(const PathfindingService&) = delete;
+        PathfindingService& operator=(const PathfindingService&) = delete;
+
+        /// @brief Add a search to the queue. The previous request of the same owner
+        /// is cancelled if it's not done yet, as its result is not needed anymore
+        /// @param owner Identifier of the requester (for example the client)
+        /// @param search The function computing the path, called from one of the pathfinding threads
+        /// @return The submitted request
+        std::shared_ptr<Request> Submit(const void* owner, const Search& search);
+
+        /// @brief Get the number of threads running in this service
+        /// @return The number of pathfinding threads
+        unsigned int GetNumThreads() const;
+
+        /// @brief Get the number of requests waiting for a free thread
+        /// @return The number of queued requests
+        size_t GetNumPendingRequests() const;
+
+    private:
+        /// @brief Loop run by each pathfinding thread
+        void Run(const unsigned int index);
+
+    private:
+        const unsigned int num_threads;
+        std::vector<std::thread> threads;
+
+        std::deque<std::shared_ptr<Request>> requests;
+        /// @brief Last unfinished request of each owner
+        std::unordered_map<const void*, std::shared_ptr<Request>> last_requests;
+        bool running;
+
+        mutable std::mutex mutex;
+        std::condition_variable condition;
+    };
+} // Botcraft
@@ -3,9 +3,16 @@
 #include "botcraft/AI/Status.hpp"
 #include "botcraft/Game/Vector3.hpp"
 
+#include <atomic>
+#include <vector>
+
 namespace Botcraft
 {
     class BehaviourClient;
+    class World;
+
+    /// @brief Default max number of explored positions of a path search
+    constexpr int default_pathfinding_budget_visit = 15000;
 
     /// @brief Not actually a task. Helper function to compute path between start and end. Does not perfom any movement.
     /// @param client Client used to do the pathfinding
@@ -18,6 +25,20 @@ namespace Botcraft
     /// @return A vector of positions to go through to reach end +/- min_end_dist. If not possible, will return a path to get as close as possible
     std::vector<Position> FindPath(const BehaviourClient& client, const Position& start, const Position& end, const int dist_tolerance, const int min_end_dist, const int min_end_dist_xz, const bool allow_jump);
 
+    /// @brief Same as FindPath, without any client. Can be used from any thread
+    /// @param world World to search the path in
+    /// @param start Start position
+    /// @param end End position
+    /// @param dist_tolerance Stop the search earlier if you get closer than dist_tolerance from the end position
+    /// @param min_end_dist Desired minimal checkboard distance between the final position and goal
+    /// @param min_end_dist_xz Same as min_end_dist but only considering the XZ plane
+    /// @param allow_jump If true, allow to jump above 1-wide gaps
+    /// @param take_damage If true, avoid walking through or on hazardous blocks
+    /// @param budget_visit Max number of explored positions before stopping the search
+    /// @param cancelled If not nullptr, the search is stopped as soon as it's set to true
+    /// @return A vector of positions to go through to reach end +/- min_end_dist. If not possible, will return a path to get as close as possible. Empty if cancelled
+    std::vector<Position> FindPath(const World& world, const Position& start, const Position& end, const int dist_tolerance, const int min_end_dist, const int min_end_dist_xz, const bool allow_jump, const bool take_damage, const int budget_visit = default_pathfinding_budget_visit, const std::atomic<bool>* cancelled = nullptr);
+
     /// @brief Find a path to a position and navigate to it.
     /// @param client The client performing the action
     /// @param goal The end goal
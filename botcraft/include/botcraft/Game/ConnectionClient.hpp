@@ -2,9 +2,12 @@
 
 #include "protocolCraft/Handler.hpp"
 
+#include "botcraft/Network/PacketFilter.hpp"
+
 namespace Botcraft
 {
     class NetworkManager;
+    class NetworkThreadPool;
     
     /// @brief The base client handling connection with a server.
     /// Only processes packets required to maintain the connection.
@@ -21,6 +24,12 @@ namespace Botcraft
         void Connect(const std::string& address, const std::string& login, const bool force_microsoft_account = false);
         virtual void Disconnect();
 
+        /// @brief Set a network thread pool to use for the next connections instead of a dedicated network thread.
+        /// The same pool can be shared between many clients so the number of network threads doesn't depend on
+        /// the number of connections.
+        /// @param pool The pool to use, nullptr to go back to one thread per connection
+        void SetSharedNetworkThreadPool(const std::shared_ptr<NetworkThreadPool> pool);
+
         bool GetShouldBeClosed() const;
         void SetShouldBeClosed(const bool b);
 
@@ -37,6 +46,12 @@ namespace Botcraft
         /// @brief Ask to respawn when dead
         void Respawn();
 
+        /// @brief Get the packets this client is subscribed to when connecting. Default is all packets,
+        /// as any derived class can handle any packet. Override it to only get the packets you handle, so
+        /// the packets no one is interested in are not parsed at all
+        /// @return A filter with the packets to dispatch to this client
+        virtual PacketFilter GetPacketFilter() const;
+
     protected:
         virtual void Handle(ProtocolCraft::Message& msg) override;
         virtual void Handle(ProtocolCraft::ClientboundLoginDisconnectPacket& msg) override;
@@ -51,6 +66,7 @@ namespace Botcraft
         
     protected:
         std::shared_ptr<NetworkManager> network_manager;
+        std::shared_ptr<NetworkThreadPool> network_thread_pool;
 
         bool should_be_closed;
     };
@@ -6,6 +6,7 @@
 
 #include "protocolCraft/Handler.hpp"
 
+#include "botcraft/Network/PacketFilter.hpp"
 #include "botcraft/Utilities/ScopeLockedWrapper.hpp"
 
 namespace Botcraft
@@ -29,6 +30,10 @@ namespace Botcraft
         /// as soon as you don't need it.
         Utilities::ScopeLockedWrapper<const std::unordered_map<int, std::shared_ptr<Entity>>, std::shared_mutex, std::shared_lock> GetEntities() const;
 
+        /// @brief Get the packets handled by this manager, to subscribe it to a NetworkManager
+        /// @return A filter with all the packets this class has a Handle overload for
+        virtual PacketFilter GetPacketFilter() const;
+
     protected:
         virtual void Handle(ProtocolCraft::ClientboundLoginPacket& msg) override;
         virtual void Handle(ProtocolCraft::ClientboundPlayerPositionPacket& msg) override;
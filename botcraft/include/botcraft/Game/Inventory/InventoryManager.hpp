@@ -8,6 +8,7 @@
 #include "protocolCraft/Handler.hpp"
 
 #include "botcraft/Game/Enums.hpp"
+#include "botcraft/Network/PacketFilter.hpp"
 
 namespace Botcraft
 {
@@ -61,6 +62,10 @@ namespace Botcraft
         void IncrementTradeUse(const int index);
 #endif
 
+        /// @brief Get the packets handled by this manager, to subscribe it to a NetworkManager
+        /// @return A filter with all the packets this class has a Handle overload for
+        virtual PacketFilter GetPacketFilter() const;
+
     private:
         void SetHotbarSelected(const short index);
         void SetCursor(const ProtocolCraft::Slot& c);
@@ -75,7 +80,6 @@ namespace Botcraft
 #endif
 
     private:
-        virtual void Handle(ProtocolCraft::Message& msg) override;
         virtual void Handle(ProtocolCraft::ClientboundContainerSetSlotPacket& msg) override;
         virtual void Handle(ProtocolCraft::ClientboundContainerSetContentPacket& msg) override;
         virtual void Handle(ProtocolCraft::ClientboundOpenScreenPacket& msg) override;
@@ -23,13 +23,20 @@ namespace Botcraft
 
     class Chunk
     {
+        friend class ChunkCache;
+
     public:
 #if PROTOCOL_VERSION < 757 /* < 1.18 */
         Chunk(const size_t dim_index, const bool has_sky_light_);
 #else
         Chunk(const int min_y_, const unsigned int height_, const size_t dim_index, const bool has_sky_light_);
 #endif
+        /// @brief Copy a chunk. Sections are shared until one of the chunks modifies them, so
+        /// copying a chunk is cheap and the copy can be read without locking the original
         Chunk(const Chunk& c);
+        Chunk(Chunk&& c) = default;
+        Chunk& operator=(const Chunk& c);
+        Chunk& operator=(Chunk&& c) = default;
 
         static Position BlockCoordsToChunkCoords(const Position& pos);
 
@@ -70,11 +77,29 @@ namespace Botcraft
         unsigned char GetSkyLight(const Position& pos) const;
         void SetSkyLight(const Position& pos, const unsigned char v);
 
+        /// @brief Replace all the light values of a section, adding the section if it doesn't exist
+        /// @param section_y Index of the section
+        /// @param light Light values in the network format (two values per byte, ordered by y, z then x),
+        /// or empty if all values are 0. Moved into the section without copy
+        /// @param sky If true, set sky light, block light otherwise
+        /// @return False if the data are invalid, the section is not modified in this case
+        bool SetSectionLight(const int section_y, std::vector<char>&& light, const bool sky);
+
         size_t GetDimensionIndex() const;
         bool GetHasSkyLight() const;
 
+        /// @brief Get an estimation of the memory used by this chunk
+        /// @return Size in bytes of the blocks, lights and biomes data (block entities are not counted)
+        size_t GetMemoryUsage() const;
+
         bool HasSection(const int y) const;
         void AddSection(const int y);
+        /// @brief Get the revision of the blocks of a section. It changes every time a block of the section
+        /// is modified, and is never reused by another section, even in another chunk. Copies of a chunk
+        /// share the revisions of the original until they are modified
+        /// @param y Index of the section
+        /// @return The current revision of the section blocks
+        unsigned long long int GetSectionRevision(const int y) const;
 
 #if PROTOCOL_VERSION < 552 /* < 1.15 */
         const Biome* GetBiome(const int x, const int z) const;
@@ -98,14 +123,39 @@ namespace Botcraft
         /// @param thread_id Id of the thread
         /// @return Number of remaining loaders
         size_t RemoveLoader(const std::thread::id& thread_id);
+        /// @brief Get all the threads in the loaders list
+        /// @return Ids of the loaders of this chunk
+        const std::unordered_set<std::thread::id>& GetLoaders() const;
+
+        /// @brief Get the hash of the network data this chunk was loaded from
+        /// @return The hash set with SetContentHash, or 0 if the chunk has been modified since
+        size_t GetContentHash() const;
+        /// @brief Set the hash of the network data this chunk was just loaded from.
+        /// Any later modification of the chunk resets it to 0
+        /// @param hash Hash of the data, 0 for unknown
+        /// @param content Block data (sections and block entities) the hash was computed from, used to check for collisions
+        void SetContentHash(const size_t hash, const std::shared_ptr<const std::vector<unsigned char>>& content = nullptr);
+        /// @brief Check if this chunk was loaded from the given data and has not been modified since
+        /// @param hash Hash of the data
+        /// @param content Block data (sections and block entities) the hash was computed from
+        /// @return True if both the hash and the data match the ones set with SetContentHash
+        bool IsLoadedFrom(const size_t hash, const std::vector<unsigned char>& content) const;
         
     private:
         bool IsInsideChunk(const Position& pos, const bool ignore_gui_borders) const;
+        /// @brief Get a section before modifying it, cloning it first if it's shared with another chunk
+        /// @param section_y Index of the section, must not be nullptr
+        /// @return A pointer to a section owned only by this chunk
+        Section* GetWritableSection(const int section_y);
+        /// @brief Give a new revision to a section after its blocks have been modified
+        /// @param section_y Index of the section
+        void UpdateSectionRevision(const int section_y);
 #if PROTOCOL_VERSION > 756 /* > 1.17.1 */
         void LoadSectionBiomeData(const int section_y, ProtocolCraft::ReadIterator& iter, size_t& length);
 #endif
     private:
         std::vector<std::shared_ptr<Section> > sections;
+        std::vector<unsigned long long int> section_revisions;
         std::vector<unsigned char> biomes;
 
         std::unordered_map<Position, ProtocolCraft::NBT::Value> block_entities_data;
@@ -124,5 +174,7 @@ namespace Botcraft
         bool modified_since_last_rendered;
 #endif
         std::unordered_set<std::thread::id> loaded_from;
+        size_t content_hash;
+        std::shared_ptr<const std::vector<unsigned char>> content_data;
     };
 } // Botcraft
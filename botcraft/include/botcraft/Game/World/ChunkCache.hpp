@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "botcraft/Game/World/Chunk.hpp"
+#include "botcraft/Game/Vector3.hpp"
+
+namespace Botcraft
+{
+    class Blockstate;
+
+    /// @brief Persistent storage of chunks on disk, to know the last state of chunks
+    /// that are not loaded anymore. Chunks are grouped in region files of 32x32 chunks
+    /// per dimension, each starting with a table of the chunks offsets. Region files
+    /// are memory-mapped for reading, and chunks are stored in the same layout as in
+    /// memory, so loading a chunk is mostly a copy. Block entities are not stored.
+    /// Files are specific to the botcraft build (game version and GUI), files written
+    /// by another build are overwritten. All functions are thread-safe.
+    class ChunkCache
+    {
+    public:
+        /// @brief Create a cache. Only one cache should use a given folder at the same time
+        /// @param folder_ Folder to store the region files in, created if it doesn't exist
+        /// @param max_decoded_chunks_ Number of chunks kept decoded in memory for GetBlock queries
+        ChunkCache(const std::string& folder_, const size_t max_decoded_chunks_ = 256);
+        ~ChunkCache();
+
+        ChunkCache(const ChunkCache&) = delete;
+        ChunkCache& operator=(const ChunkCache&) = delete;
+
+        /// @brief Store a chunk, replacing the previous version if any
+        /// @param dimension Dimension of the chunk
+        /// @param x Chunk X coordinate
+        /// @param z Chunk Z coordinate
+        /// @param chunk Chunk to store
+        void Save(const std::string& dimension, const int x, const int z, const Chunk& chunk);
+
+        /// @brief Check if a chunk is stored
+        /// @param dimension Dimension of the chunk
+        /// @param x Chunk X coordinate
+        /// @param z Chunk Z coordinate
+        /// @return True if the chunk is in the cache, false otherwise
+        bool Contains(const std::string& dimension, const int x, const int z);
+
+        /// @brief Read a chunk from the cache
+        /// @param dimension Dimension of the chunk
+        /// @param x Chunk X coordinate
+        /// @param z Chunk Z coordinate
+        /// @param dim_index Dimension index to give to the chunk
+        /// @return The chunk as it was when saved, or nothing if not in the cache
+        std::optional<Chunk> Load(const std::string& dimension, const int x, const int z, const size_t dim_index = 0);
+
+        /// @brief Get the last known blockstate at a given position
+        /// @param dimension Dimension of the block
+        /// @param pos Position of the block
+        /// @return A const pointer to the blockstate at position, nullptr if the chunk is not in the cache
+        const Blockstate* GetBlock(const std::string& dimension, const Position& pos);
+
+        /// @brief Write all pending data and close all the region files
+        void Flush();
+
+    private:
+        class Region;
+        using RegionKey = std::tuple<std::string, int, int>;
+        using ChunkKey = std::tuple<std::string, int, int>;
+
+        /// @brief Get a region, opening it if necessary. Not thread-safe
+        /// @param dimension Dimension of the region
+        /// @param region_x Region X coordinate
+        /// @param region_z Region Z coordinate
+        /// @param create If true, the region file is created if it doesn't exist
+        /// @return A pointer to the region, nullptr if it doesn't exist and create is false
+        Region* GetRegion(const std::string& dimension, const int region_x, const int region_z, const bool create);
+
+        /// @brief Get a chunk from the decoded chunks, reading it from disk if necessary. Not thread-safe
+        /// @param dimension Dimension of the chunk
+        /// @param x Chunk X coordinate
+        /// @param z Chunk Z coordinate
+        /// @return A pointer to the chunk, nullptr if not in the cache
+        const Chunk* GetDecodedChunk(const std::string& dimension, const int x, const int z);
+
+        /// @brief Write a chunk in the cache format
+        /// @param chunk Chunk to write
+        /// @param output Vector to append the data to
+        static void WriteChunk(const Chunk& chunk, std::vector<unsigned char>& output);
+        /// @brief Read a chunk in the cache format
+        /// @param data Data to read
+        /// @param length Size of data
+        /// @param dim_index Dimension index to give to the chunk
+        /// @return The chunk, or nothing if the data are invalid
+        static std::optional<Chunk> ReadChunk(const unsigned char* data, const size_t length, const size_t dim_index);
+
+    private:
+        struct DecodedChunk
+        {
+            std::optional<Chunk> chunk;
+            size_t last_used;
+        };
+
+        struct OpenedRegion
+        {
+            /// @brief nullptr if the region file doesn't exist
+            std::unique_ptr<Region> region;
+            size_t last_used;
+        };
+
+        const std::string folder;
+        const size_t max_decoded_chunks;
+
+        std::mutex cache_mutex;
+        /// @brief Recently used regions
+        std::map<RegionKey, OpenedRegion> regions;
+        size_t regions_counter;
+        /// @brief Recently read chunks, nothing if the chunk is not in the cache
+        std::map<ChunkKey, DecodedChunk> decoded_chunks;
+        size_t decoded_chunks_counter;
+    };
+} // Botcraft
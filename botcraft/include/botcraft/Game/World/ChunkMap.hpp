@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "botcraft/Game/World/Chunk.hpp"
+#include "botcraft/Utilities/OpenAddressingIndex.hpp"
+
+namespace Botcraft
+{
+    /// @brief Container for the loaded chunks, indexed by chunk coordinates.
+    /// Chunks are stored contiguously and indexed by an open addressing table
+    /// with linear probing, keys being the two coordinates packed in 64 bits.
+    /// Iterators, pointers and references are invalidated by insert and erase.
+    class ChunkMap
+    {
+    public:
+        using key_type = std::pair<int, int>;
+        using mapped_type = Chunk;
+        using value_type = std::pair<key_type, Chunk>;
+        using iterator = std::vector<value_type>::iterator;
+        using const_iterator = std::vector<value_type>::const_iterator;
+
+        ChunkMap();
+        ChunkMap(const ChunkMap& other);
+        ChunkMap(ChunkMap&& other);
+        ChunkMap& operator=(const ChunkMap& other);
+        ChunkMap& operator=(ChunkMap&& other);
+
+        iterator begin();
+        iterator end();
+        const_iterator begin() const;
+        const_iterator end() const;
+
+        size_t size() const;
+        bool empty() const;
+        void clear();
+
+        /// @brief Find a chunk. The last found chunk is cached, so consecutive
+        /// queries in the same chunk don't go through the index. Thread-safe with
+        /// other const member functions
+        /// @param key Chunk coordinates
+        /// @return Iterator to the chunk, or end() if not loaded
+        iterator find(const key_type& key);
+        const_iterator find(const key_type& key) const;
+
+        /// @brief Get a chunk, throws std::out_of_range if not loaded
+        /// @param key Chunk coordinates
+        /// @return A reference to the chunk
+        Chunk& at(const key_type& key);
+        const Chunk& at(const key_type& key) const;
+
+        /// @brief Add a chunk if not already present
+        /// @param value Chunk coordinates and chunk
+        /// @return An iterator to the chunk with these coordinates and a bool set to true if the insertion took place
+        std::pair<iterator, bool> insert(value_type&& value);
+
+        /// @brief Remove a chunk. The last chunk is moved in its place
+        /// @param it Iterator to the chunk to remove
+        /// @return Iterator to the element following the removed one in the iteration order
+        iterator erase(const_iterator it);
+        size_t erase(const key_type& key);
+
+    private:
+        static uint64_t PackKey(const key_type& key);
+        /// @brief Get the packed key of an entry
+        /// @param index Index of the entry
+        /// @return Packed coordinates of the chunk at index
+        uint64_t GetEntryKey(const size_t index) const;
+
+        /// @brief Find the index of a chunk in entries
+        /// @param key Chunk coordinates
+        /// @return The index of the chunk, or entries.size() if not loaded
+        size_t FindIndex(const key_type& key) const;
+        /// @brief Find the slot of a chunk in the table
+        /// @param key Chunk coordinates
+        /// @return Index of the slot, or of the first empty slot found if not present
+        size_t FindSlot(const key_type& key) const;
+
+    private:
+        static constexpr size_t initial_num_slots = 16;
+
+        std::vector<value_type> entries;
+        /// @brief Index of the chunks in entries
+        Utilities::OpenAddressingIndex slots;
+        /// @brief Index in entries of the last chunk found
+        mutable std::atomic<size_t> last_found;
+    };
+} // Botcraft
@@ -8,7 +8,10 @@
 #include "botcraft/Game/Enums.hpp"
 #include "botcraft/Game/World/Blockstate.hpp"
 #include "botcraft/Game/World/Chunk.hpp"
+#include "botcraft/Game/World/ChunkMap.hpp"
+#include "botcraft/Game/World/WorldView.hpp"
 #include "botcraft/Game/Vector3.hpp"
+#include "botcraft/Network/PacketFilter.hpp"
 #include "botcraft/Utilities/ScopeLockedWrapper.hpp"
 
 #include "protocolCraft/Handler.hpp"
@@ -20,10 +23,9 @@ namespace std
     {
         inline size_t operator()(const pair<int, int>& p) const
         {
-            hash<float> hasher;
-            size_t value = hasher(p.first);
-            value ^= hasher(p.second) + 0x9e3779b9 + (value << 6) + (value >> 2);
-            return value;
+            // Pack both coordinates in 64 bits, and mix them so neighbouring coordinates don't collide
+            hash<unsigned long long int> hasher;
+            return hasher(((static_cast<unsigned long long int>(static_cast<unsigned int>(p.first)) << 32) | static_cast<unsigned int>(p.second)) * 0x9e3779b97f4a7c15ULL);
         }
     };
 }
@@ -31,6 +33,21 @@ namespace std
 namespace Botcraft
 {
     class Biome;
+    class ChunkCache;
+
+    /// @brief What a World does with the light data received from the server
+    enum class LightPolicy
+    {
+        /// @brief Light data are not stored, and light packets are not even parsed.
+        /// All light values are 0
+        Ignore,
+        /// @brief Light arrays are moved from the packets into the chunks without copy.
+        /// Light packets are left empty for the handlers after the world
+        Raw,
+        /// @brief Light arrays are copied into the chunks, and the packets are kept intact.
+        /// Sections without light don't use any memory for it
+        Eager
+    };
 
     class World : public ProtocolCraft::Handler
     {
@@ -38,7 +55,8 @@ namespace Botcraft
         /// @brief
         /// @param is_shared_ If true, this world can be shared by multiple bot
         /// instances (assuming they all are and stay in the **same dimension**)
-        World(const bool is_shared_);
+        /// @param light_policy_ What to do with the light data sent by the server
+        World(const bool is_shared_, const LightPolicy light_policy_ = LightPolicy::Eager);
 
         ~World();
 
@@ -51,6 +69,10 @@ namespace Botcraft
         /// @return True if world is a shared one, false otherwise
         bool IsShared() const;
 
+        /// @brief light_policy getter
+        /// @return What this world does with the light data sent by the server
+        LightPolicy GetLightPolicy() const;
+
         /// @brief Get height of the current dimension
         /// @return 256 for versions prior to 1.18, current dimension height otherwise
         int GetHeight() const;
@@ -116,6 +138,48 @@ namespace Botcraft
         /// @return A vector of const pointer to the blockstate at each position, nullptr if not loaded
         std::vector<const Blockstate*> GetBlocks(const std::vector<Position>& pos) const;
 
+        /// @brief Copy all the blockstates of a box into a dense array. Thread-safe
+        /// @param min Min corner of the box
+        /// @param max Max corner of the box, included
+        /// @return The blockstates, nullptr if not loaded. Blockstate at (x, y, z) is at index
+        /// ((y - min.y) * size.z + (z - min.z)) * size.x + (x - min.x), with size = max - min + 1
+        std::vector<const Blockstate*> GetBlocks(const Position& min, const Position& max) const;
+
+        /// @brief Get a copy of all the loaded chunks intersecting a box. Thread-safe. Copying chunks
+        /// is cheap as their sections are shared until the world modifies them, so this can be used
+        /// to read a consistent state of a region for a long time without blocking the world.
+        /// Use WorldView(snapshot) to query blocks in it
+        /// @param min Min corner of the box
+        /// @param max Max corner of the box, included
+        /// @return Copy of the chunks, not updated when the world changes
+        ChunkMap GetChunksSnapshot(const Position& min, const Position& max) const;
+
+        /// @brief Set the cache in which chunks are saved when unloaded. Thread-safe. Chunks are
+        /// written synchronously by the thread unloading them, usually the network processing thread
+        /// @param cache Cache to use, can be shared by multiple worlds. nullptr to disable saving
+        void SetChunkCache(const std::shared_ptr<ChunkCache>& cache);
+
+        /// @brief Get the cache in which chunks are saved when unloaded. Thread-safe
+        /// @return The cache, nullptr if not set
+        std::shared_ptr<ChunkCache> GetChunkCache() const;
+
+        /// @brief Get the blockstate at a given position, from the chunk cache if the chunk is not loaded. Thread-safe
+        /// @param pos Position of the block
+        /// @return A const pointer to the blockstate at position, nullptr if neither loaded nor cached
+        const Blockstate* GetLastKnownBlock(const Position& pos) const;
+
+        /// @brief Same as GetChunksSnapshot, with the missing chunks read from the chunk cache. Thread-safe
+        /// @param min Min corner of the box
+        /// @param max Max corner of the box, included
+        /// @return Copy of the loaded chunks, and of the last known version of the cached ones
+        ChunkMap GetLastKnownChunks(const Position& min, const Position& max) const;
+
+        /// @brief Get a read-only view of the world, to perform many block queries with a single lock
+        /// @return A WorldView, keeping the world locked until destroyed.
+        /// **ALL WORLD UPDATES WILL BE BLOCKED WHILE THIS OBJECT IS ALIVE**, make sure it goes out of scope
+        /// as soon as you don't need it.
+        WorldView GetView() const;
+
         /// @brief Get all colliders that could collide with a given AABB. Thread-safe
         /// @param aabb AABB of the blocks to search for
         /// @param movement Optional movement vector that will be added to the AABB
@@ -128,10 +192,10 @@ namespace Botcraft
         Vector3<double> GetFlow(const Position& pos);
 
         /// @brief Get a read-only locked version of all the loaded chunks
-        /// @return Basically an object you can use as a std::unordered_map<std::pair<int, int>, Chunk>*.
+        /// @return Basically an object you can use as a ChunkMap*.
         /// **ALL WORLD UPDATE WILL BE BLOCKED WHILE THIS OBJECT IS ALIVE**, make sure it goes out of scope
         /// as soon as you don't need it.
-        Utilities::ScopeLockedWrapper<const std::unordered_map<std::pair<int, int>, Chunk>, std::shared_mutex, std::shared_lock> GetChunks() const;
+        Utilities::ScopeLockedWrapper<const ChunkMap, std::shared_mutex, std::shared_lock> GetChunks() const;
 
 #if PROTOCOL_VERSION < 358 /* < 1.13 */
         /// @brief Set biome of given block column. Does nothing if not loaded. Thread-safe
@@ -249,6 +313,10 @@ namespace Botcraft
         /// @return True if collision false otherwise
         bool IsFree(const AABB& aabb, const bool fluid_collide) const;
 
+        /// @brief Get the packets handled by this world, to subscribe it to a NetworkManager
+        /// @return A filter with all the packets this class has a Handle overload for
+        virtual PacketFilter GetPacketFilter() const;
+
     protected:
         virtual void Handle(ProtocolCraft::ClientboundLoginPacket& msg) override;
         virtual void Handle(ProtocolCraft::ClientboundRespawnPacket& msg) override;
@@ -277,10 +345,14 @@ namespace Botcraft
 #else
         void LoadChunkImpl(const int x, const int z, const std::string& dim, const std::thread::id& loader_id);
 #endif
-        void UnloadChunkImpl(const int x, const int z, const std::thread::id& loader_id);
+        /// @brief Remove a loader of a chunk, and the chunk if it was the last one. Not thread-safe
+        /// @param x Chunk X coordinate
+        /// @param z Chunk Z coordinate
+        /// @param loader_id Id of the loader
+        /// @return The removed chunk if it has to be saved in the chunk cache, nothing otherwise
+        std::optional<Chunk> UnloadChunkImpl(const int x, const int z, const std::thread::id& loader_id);
 
         void SetBlockImpl(const Position& pos, const BlockstateId id);
-        const Blockstate* GetBlockImpl(const Position& pos) const;
 
 #if PROTOCOL_VERSION < 719 /* < 1.16 */
         void SetCurrentDimensionImpl(const Dimension dimension);
@@ -340,13 +412,41 @@ namespace Botcraft
 #endif
 
 #if PROTOCOL_VERSION > 404 /* > 1.13.2 */ && PROTOCOL_VERSION < 719 /* < 1.16 */
-        void UpdateChunkLight(const int x, const int z, const Dimension dim, const int light_mask, const int empty_light_mask, const std::vector<std::vector<char> >& data, const bool sky);
+        void UpdateChunkLight(const int x, const int z, const Dimension dim, const int light_mask, const int empty_light_mask, std::vector<std::vector<char> >& data, const bool sky);
 #elif PROTOCOL_VERSION > 718 /* > 1.15.2 */ && PROTOCOL_VERSION < 755 /* < 1.17 */
-        void UpdateChunkLight(const int x, const int z, const std::string& dim, const int light_mask, const int empty_light_mask, const std::vector<std::vector<char> >& data, const bool sky);
+        void UpdateChunkLight(const int x, const int z, const std::string& dim, const int light_mask, const int empty_light_mask, std::vector<std::vector<char> >& data, const bool sky);
 #elif PROTOCOL_VERSION > 754 /* > 1.16.5 */
         void UpdateChunkLight(const int x, const int z, const std::string& dim,
             const std::vector<unsigned long long int>& light_mask, const std::vector<unsigned long long int>& empty_light_mask,
-            const std::vector<std::vector<char> >& data, const bool sky);
+            std::vector<std::vector<char> >& data, const bool sky);
+#endif
+
+#if PROTOCOL_VERSION > 404 /* > 1.13.2 */ && PROTOCOL_VERSION < 755 /* < 1.17 */
+        /// @brief Load light arrays in a chunk, following the light policy
+        /// @param chunk Chunk to update
+        /// @param light_mask Sections with data in data
+        /// @param empty_light_mask Sections with only 0 values
+        /// @param data Light arrays of the sections in light_mask, moved from with LightPolicy::Raw
+        /// @param sky If true, update sky light, block light otherwise
+        void LoadLightInChunk(Chunk& chunk, const int light_mask, const int empty_light_mask, std::vector<std::vector<char> >& data, const bool sky) const;
+#elif PROTOCOL_VERSION > 754 /* > 1.16.5 */
+        /// @brief Load light arrays in a chunk, following the light policy
+        /// @param chunk Chunk to update
+        /// @param light_mask Sections with data in data
+        /// @param empty_light_mask Sections with only 0 values
+        /// @param data Light arrays of the sections in light_mask, moved from with LightPolicy::Raw
+        /// @param sky If true, update sky light, block light otherwise
+        void LoadLightInChunk(Chunk& chunk,
+            const std::vector<unsigned long long int>& light_mask, const std::vector<unsigned long long int>& empty_light_mask,
+            std::vector<std::vector<char> >& data, const bool sky) const;
+#endif
+
+#if PROTOCOL_VERSION > 756 /* > 1.17.1 */
+        /// @brief Compute a hash of all the data used to load a chunk
+        /// @param msg Chunk packet
+        /// @param content Output, sections and block entities bytes of the chunk, to fully compare chunks with the same hash
+        /// @return A hash of msg chunk and light data, never 0
+        static size_t ComputeChunkContentHash(const ProtocolCraft::ClientboundLevelChunkWithLightPacket& msg, std::vector<unsigned char>& content);
 #endif
 
 #if PROTOCOL_VERSION < 719 /* < 1.16 */
@@ -355,15 +455,31 @@ namespace Botcraft
         size_t GetDimIndex(const std::string& dim);
 #endif
 
+#if PROTOCOL_VERSION < 719 /* < 1.16 */
+        /// @brief Get the name of a dimension in the chunk cache
+        /// @param dim Dimension
+        /// @return Name of the dimension
+        static std::string GetCacheDimensionName(const Dimension dim);
+#else
+        /// @brief Get the name of a dimension in the chunk cache
+        /// @param dim Dimension
+        /// @return Name of the dimension
+        static std::string GetCacheDimensionName(const std::string& dim);
+#endif
+
     private:
-        std::unordered_map<std::pair<int, int>, Chunk> terrain;
+        ChunkMap terrain;
         mutable std::shared_mutex world_mutex;
 
+        /// @brief Where chunks are saved when unloaded, can be nullptr
+        std::shared_ptr<ChunkCache> chunk_cache;
+
 #if PROTOCOL_VERSION > 404 /* > 1.13.2 */ && PROTOCOL_VERSION < 757 /* < 1.18 */
         std::unordered_map<std::pair<int, int>, ProtocolCraft::ClientboundLightUpdatePacket> delayed_light_updates;
 #endif
 
         const bool is_shared;
+        const LightPolicy light_policy;
 #if PROTOCOL_VERSION < 719 /* < 1.16 */
         Dimension current_dimension;
         std::unordered_map<Dimension, size_t> dimension_index_map;
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <shared_mutex>
+#include <vector>
+
+#include "botcraft/Game/Vector3.hpp"
+
+namespace Botcraft
+{
+    class Blockstate;
+    class Chunk;
+    class ChunkMap;
+
+    /// @brief Read-only access to the blocks of a World, with the world locked once
+    /// for all the queries instead of once per block. The last accessed chunk is
+    /// cached, so queries close to each other don't search the chunk index again.
+    /// When obtained with World::GetView, **ALL WORLD UPDATES WILL BE BLOCKED WHILE THIS OBJECT IS ALIVE**,
+    /// make sure it goes out of scope as soon as you don't need it, and don't call World functions while
+    /// holding it in the same thread. A view must not be shared between threads.
+    class WorldView
+    {
+        friend class World;
+
+    public:
+        /// @brief Create a view on chunks that are not modified by other threads, e.g. a World::GetChunksSnapshot result.
+        /// Use World::GetView to get a view of a World
+        /// @param terrain_ Chunks to read, must outlive this view
+        WorldView(const ChunkMap& terrain_);
+        WorldView(WorldView&& other) = default;
+        WorldView(const WorldView&) = delete;
+        WorldView& operator=(const WorldView&) = delete;
+
+        /// @brief Get the blockstate at a given position
+        /// @param pos Position of the block
+        /// @return A const pointer to the blockstate at position, nullptr if not loaded
+        const Blockstate* GetBlock(const Position& pos);
+
+        /// @brief Get blockstates for a set of positions
+        /// @param pos Positions of the blocks
+        /// @return A vector of const pointer to the blockstate at each position, nullptr if not loaded
+        std::vector<const Blockstate*> GetBlocks(const std::vector<Position>& pos);
+
+        /// @brief Copy all the blockstates of a box into a dense array
+        /// @param min Min corner of the box
+        /// @param max Max corner of the box, included
+        /// @return The blockstates, nullptr if not loaded. Blockstate at (x, y, z) is at index
+        /// ((y - min.y) * size.z + (z - min.z)) * size.x + (x - min.x), with size = max - min + 1
+        std::vector<const Blockstate*> GetBlocks(const Position& min, const Position& max);
+
+        /// @brief Get a chunk
+        /// @param x Chunk X coordinate
+        /// @param z Chunk Z coordinate
+        /// @return A pointer to the chunk, nullptr if not loaded
+        const Chunk* GetChunk(const int x, const int z);
+
+    private:
+        /// @brief Create a view locking the world
+        /// @param terrain_ Chunks of the world
+        /// @param mutex Mutex of the world
+        WorldView(const ChunkMap& terrain_, std::shared_mutex& mutex);
+
+    private:
+        std::shared_lock<std::shared_mutex> lock;
+        const ChunkMap& terrain;
+
+        int cached_chunk_x;
+        int cached_chunk_z;
+        const Chunk* cached_chunk;
+        bool has_cached_chunk;
+    };
+} // Botcraft
@@ -2,9 +2,15 @@
 
 #include "protocolCraft/Handler.hpp"
 #include "protocolCraft/enums.hpp"
+#include "protocolCraft/MessageFactory.hpp"
 
+#include "botcraft/Network/PacketBufferPool.hpp"
+#include "botcraft/Network/PacketFilter.hpp"
+#include "botcraft/Utilities/SPSCQueue.hpp"
+
+#include <atomic>
 #include <vector>
-#include <queue>
+#include <deque>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
@@ -12,19 +18,51 @@
 #if PROTOCOL_VERSION > 759 /* > 1.19 */
 #include "botcraft/Network/LastSeenMessagesTracker.hpp"
 #endif
-#if PROTOCOL_VERSION > 760 /* > 1.19.2 */
-#include <atomic>
-#endif
 
 namespace Botcraft
 {
     class TCP_Com;
     class Authentifier;
+    class NetworkThreadPool;
+    class CompressionContext;
+
+    /// @brief What to do when a packet is received while the processing queue is full
+    enum class PacketQueuePolicy
+    {
+        /// @brief Store the packet in an unbounded overflow queue, the network thread never waits
+        Grow,
+        /// @brief Wait until the processing thread frees some space. This stops reading from
+        /// the socket, so the server is slowed down by TCP flow control. If the network IO runs
+        /// on a shared NetworkThreadPool, the other connections on the same thread are blocked too
+        Block
+    };
+
+    /// @brief Snapshot of the state of a NetworkManager processing queue
+    struct PacketQueueMetrics
+    {
+        /// @brief Number of packets the lock-free queue can hold
+        size_t capacity = 0;
+        /// @brief Number of packets currently waiting to be processed
+        size_t depth = 0;
+        /// @brief Max number of packets waiting to be processed since the connection started
+        size_t max_depth = 0;
+        /// @brief Total number of packets received
+        size_t num_packets = 0;
+        /// @brief Number of packets received while the lock-free queue was full
+        size_t num_full = 0;
+        /// @brief Number of times the network thread had to wake up the processing thread
+        size_t num_wakeups = 0;
+    };
 
     class NetworkManager : public ProtocolCraft::Handler
     {
     public:
-        NetworkManager(const std::string& address, const std::string& login, const bool force_microsoft_auth);
+        /// @brief Create a network manager and connect to the server
+        /// @param address Address of the server
+        /// @param login Login to use, if empty, Microsoft auth flow will be used
+        /// @param force_microsoft_auth If true, Microsoft auth flow will be used even if login is not empty
+        /// @param network_thread_pool If not null, the network IO will run on this shared pool instead of a dedicated thread
+        NetworkManager(const std::string& address, const std::string& login, const bool force_microsoft_auth, const std::shared_ptr<NetworkThreadPool>& network_thread_pool = nullptr);
         // Used to create a dummy network manager that does not fire any message
         // but is always in constant_connection_state
         NetworkManager(const ProtocolCraft::ConnectionState constant_connection_state);
@@ -32,7 +70,13 @@ namespace Botcraft
 
         void Close();
 
+        /// @brief Register a handler receiving all the packets
+        /// @param h Handler to register
         void AddHandler(ProtocolCraft::Handler* h);
+        /// @brief Register a handler only receiving the packets in a filter
+        /// @param h Handler to register
+        /// @param filter Packets dispatched to this handler
+        void AddHandler(ProtocolCraft::Handler* h, const PacketFilter& filter);
         void Send(const std::shared_ptr<ProtocolCraft::Message> msg);
         const ProtocolCraft::ConnectionState GetConnectionState() const;
         const std::string& GetMyName() const;
@@ -42,13 +86,53 @@ namespace Botcraft
 
         std::thread::id GetProcessingThreadId() const;
 
+        /// @brief Set the zlib compression level used for outgoing packets, once the server enabled compression
+        /// @param level Compression level, from 0 (no compression) to 9 (best compression), or -1 for zlib default
+        void SetCompressionLevel(const int level);
+
+        /// @brief Get the pool recycling the buffers of the received packets
+        /// @return A const reference to the pool, to check its allocation counters
+        const PacketBufferPool& GetPacketBufferPool() const;
+
+        /// @brief Set the behaviour of the network thread when the processing queue is full
+        /// @param policy New policy, default is PacketQueuePolicy::Grow
+        void SetPacketQueuePolicy(const PacketQueuePolicy policy);
+
+        /// @brief Get the current state of the processing queue, to detect if the processing thread is falling behind
+        /// @return A snapshot of the queue metrics
+        PacketQueueMetrics GetPacketQueueMetrics() const;
+
+        /// @brief Set whether or not packets no handler is interested in are parsed
+        /// @param skip If true, these packets are dropped without being parsed. Default is false
+        void SetSkipUnhandledPackets(const bool skip);
+
+        /// @brief Set whether or not big packets (recipes, advancements, commands...) are parsed only when a handler accesses them
+        /// @param lazy If true, these packets are kept as raw data until one of their getters is called. Default is false
+        void SetLazyParsing(const bool lazy);
+
     private:
+        struct InterestedHandlers;
+
         void WaitForNewPackets();
-        void ProcessPacket(const std::vector<unsigned char>& packet);
-        void OnNewRawData(const std::vector<unsigned char>& packet);
+        /// @brief Parse and dispatch one uncompressed packet
+        /// @param packet_iterator Iterator to the beginning of the packet
+        /// @param length Size of the packet
+        void ProcessPacket(ProtocolCraft::ReadIterator packet_iterator, size_t length);
+        /// @brief Called by the TCP connection for each received packet
+        /// @param data Pointer to the packet data, only valid during the call
+        /// @param length Size of the packet
+        void OnNewRawData(const unsigned char* data, const size_t length);
+        /// @brief Get the next packet to process, called by the processing thread only
+        /// @param packet Output packet
+        /// @return False if there is no packet waiting
+        bool PopPacket(std::vector<unsigned char>& packet);
+        /// @brief Get the handlers interested in a packet, in registration order. mutex_handlers must be locked
+        /// @param state Connection state of the packet
+        /// @param packet_id Id of the packet
+        /// @return All the registered handlers with a filter containing this packet, and whether one of their filters needs light data
+        const InterestedHandlers& GetInterestedHandlers(const ProtocolCraft::ConnectionState state, const int packet_id);
 
 
-        virtual void Handle(ProtocolCraft::Message& msg) override;
         virtual void Handle(ProtocolCraft::ClientboundLoginCompressionPacket& msg) override;
         virtual void Handle(ProtocolCraft::ClientboundGameProfilePacket& msg) override;
         virtual void Handle(ProtocolCraft::ClientboundHelloPacket& msg) override;
@@ -78,7 +162,28 @@ namespace Botcraft
 #endif
 
     private:
-        std::vector<ProtocolCraft::Handler*> subscribed;
+        struct HandlerRegistration
+        {
+            ProtocolCraft::Handler* handler;
+            PacketFilter filter;
+        };
+
+        struct InterestedHandlers
+        {
+            bool valid = false;
+            /// @brief True if at least one of the handlers needs the light data of chunk packets
+            bool light_data = false;
+            std::vector<ProtocolCraft::Handler*> handlers;
+        };
+
+        std::vector<HandlerRegistration> subscribed;
+        /// @brief Lazily computed subscribers of each packet, indexed by state then packet id
+        std::vector<std::vector<InterestedHandlers> > interested_handlers;
+        /// @brief Copy of the handlers of the packet being dispatched, only used by the processing thread
+        std::vector<ProtocolCraft::Handler*> dispatch_handlers;
+        std::mutex mutex_handlers;
+        std::atomic<bool> skip_unhandled_packets = false;
+        std::atomic<bool> lazy_parsing = false;
 
         std::shared_ptr<TCP_Com> com;
         std::shared_ptr<Authentifier> authentifier;
@@ -86,10 +191,31 @@ namespace Botcraft
 
         std::thread m_thread_process;//Thread running to process incoming packets without blocking com
 
-        std::queue<std::vector<unsigned char> > packets_to_process;
+        static constexpr size_t packet_queue_capacity = 1024;
+        /// @brief Lock-free hand-off between the network thread and the processing thread
+        Utilities::SPSCQueue<std::vector<unsigned char> > packets_to_process{ packet_queue_capacity };
+        /// @brief Packets received while packets_to_process was full, protected by mutex_process
+        std::deque<std::vector<unsigned char> > overflow_packets;
+        std::atomic<size_t> overflow_size = 0;
+        std::atomic<PacketQueuePolicy> packet_queue_policy = PacketQueuePolicy::Grow;
+        /// @brief Only used to sleep/wake up threads, the queue itself is lock-free
         std::mutex mutex_process;
         std::condition_variable process_condition;
+        std::condition_variable queue_space_condition;
+        std::atomic<bool> processing_thread_waiting = false;
+        std::atomic<bool> network_thread_waiting = false;
+        std::atomic<size_t> max_queue_depth = 0;
+        std::atomic<size_t> num_queue_packets = 0;
+        std::atomic<size_t> num_queue_full = 0;
+        std::atomic<size_t> num_queue_wakeups = 0;
+        /// @brief Recycled buffers for both the received and the decompressed packets
+        PacketBufferPool packet_buffer_pool;
+        /// @brief Recycled messages, only used by the processing thread
+        ProtocolCraft::MessagePool message_pool;
         int compression;
+        /// @brief Persistent compression streams, created when the server enables compression
+        std::shared_ptr<CompressionContext> compression_context;
+        int compression_level = -1;
 
         std::mutex mutex_send;
 
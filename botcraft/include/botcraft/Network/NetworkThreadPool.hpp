@@ -0,0 +1,54 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Botcraft
+{
+    class TCP_Com;
+
+    /// @brief A fixed number of threads running the network IO of
+    /// several connections. Can be shared between multiple clients
+    /// (see ConnectionClient::SetSharedNetworkThreadPool) so they
+    /// don't each spawn their own network thread.
+    class NetworkThreadPool
+    {
+    public:
+        /// @brief Create a pool and start all its threads
+        /// @param num_threads Number of network threads, if 0 std::thread::hardware_concurrency() is used
+        NetworkThreadPool(const unsigned int num_threads = 0);
+        ~NetworkThreadPool();
+
+        NetworkThreadPool(const NetworkThreadPool&) = delete;
+        NetworkThreadPool& operator=(const NetworkThreadPool&) = delete;
+
+        /// @brief Get the number of threads running in this pool
+        /// @return The number of network threads
+        unsigned int GetNumThreads() const;
+
+        /// @brief Get the number of connections currently using this pool
+        /// @return The number of connections
+        unsigned int GetNumConnections() const;
+
+    private:
+        friend class TCP_Com;
+
+        /// @brief One asio io_context and its worker thread, defined in private headers
+        struct IOContext;
+
+        /// @brief Get the io context with the lowest number of connections and register a new connection on it
+        /// @return A reference to the chosen context
+        IOContext& AcquireIOContext();
+
+        /// @brief Unregister a connection from its io context
+        /// @param context The context returned by AcquireIOContext
+        void ReleaseIOContext(IOContext& context);
+
+    private:
+        std::vector<std::unique_ptr<IOContext> > io_contexts;
+        std::vector<std::thread> threads;
+        mutable std::mutex mutex_contexts;
+    };
+} // Botcraft
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+namespace Botcraft
+{
+    /// @brief A thread-safe pool of byte buffers. Buffers are
+    /// recycled with their capacity, so once enough buffers big
+    /// enough have been created, acquiring one doesn't allocate.
+    class PacketBufferPool
+    {
+    public:
+        /// @brief Create an empty pool
+        /// @param max_pooled_buffers Maximum number of buffers kept in the pool, other released buffers are freed
+        /// @param max_pooled_capacity Buffers with a bigger capacity are freed when released instead of kept in the pool
+        PacketBufferPool(const size_t max_pooled_buffers = 64, const size_t max_pooled_capacity = 4 * 1024 * 1024);
+
+        PacketBufferPool(const PacketBufferPool&) = delete;
+        PacketBufferPool& operator=(const PacketBufferPool&) = delete;
+
+        /// @brief Get an empty buffer from the pool
+        /// @param min_capacity The returned buffer is guaranteed to have at least this capacity
+        /// @return An empty buffer with capacity >= min_capacity
+        std::vector<unsigned char> Acquire(const size_t min_capacity);
+
+        /// @brief Give a buffer back to the pool
+        /// @param buffer Buffer to recycle, will be empty after this call
+        void Release(std::vector<unsigned char>&& buffer);
+
+        /// @brief Get the number of heap allocations done by Acquire, either for new buffers or to grow recycled ones
+        /// @return The number of allocations since the creation of the pool
+        size_t GetNumAllocations() const;
+
+        /// @brief Get the number of Acquire calls
+        /// @return The number of buffers given by this pool
+        size_t GetNumAcquired() const;
+
+        /// @brief Get the number of buffers currently available in the pool
+        /// @return The number of buffers ready to be reused
+        size_t GetNumPooled() const;
+
+    private:
+        std::vector<std::vector<unsigned char> > buffers;
+        const size_t max_pooled_buffers;
+        const size_t max_pooled_capacity;
+
+        size_t num_allocations;
+        size_t num_acquired;
+
+        mutable std::mutex mutex_buffers;
+    };
+} // Botcraft
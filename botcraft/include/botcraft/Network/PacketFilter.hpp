@@ -0,0 +1,166 @@
+#pragma once
+
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "protocolCraft/Handler.hpp"
+#include "protocolCraft/enums.hpp"
+
+namespace Botcraft
+{
+    /// @brief A set of clientbound packets, used to only dispatch
+    /// to a handler the packets it is interested in
+    class PacketFilter
+    {
+    public:
+        /// @brief Create an empty filter
+        PacketFilter();
+
+        /// @brief Create a filter accepting all packets
+        /// @return A filter containing everything
+        static PacketFilter All();
+
+        /// @brief Create a filter with a list of packet types
+        /// @tparam ...TPackets Clientbound packet types
+        /// @return A filter containing these packets
+        template<typename... TPackets>
+        static PacketFilter Of()
+        {
+            PacketFilter output;
+            (output.Add<TPackets>(), ...);
+            return output;
+        }
+
+        /// @brief Create a filter with all the packets a handler class has a Handle overload for.
+        /// Handle overloads are usually not public, so use HANDLED_PACKETS_FILTER(THandler) from
+        /// THandler scope instead of calling this directly
+        /// @tparam TDetector Generic lambda, invocable with a TMessage* only if there is a Handle(TMessage&) overload
+        /// @return A filter containing all handled packets, or all packets if Handle(Message&) is overriden
+        template<typename TDetector>
+        static PacketFilter FromHandleOverloads(TDetector detector)
+        {
+            if constexpr (IsHandledBy<TDetector, ProtocolCraft::Message>())
+            {
+                return All();
+            }
+            else
+            {
+                PacketFilter output;
+                output.AddHandled<TDetector, ProtocolCraft::AllClientboundLoginMessages>(ProtocolCraft::ConnectionState::Login);
+                output.AddHandled<TDetector, ProtocolCraft::AllClientboundStatusMessages>(ProtocolCraft::ConnectionState::Status);
+                output.AddHandled<TDetector, ProtocolCraft::AllClientboundPlayMessages>(ProtocolCraft::ConnectionState::Play);
+#if PROTOCOL_VERSION > 763 /* > 1.20.1 */
+                output.AddHandled<TDetector, ProtocolCraft::AllClientboundConfigurationMessages>(ProtocolCraft::ConnectionState::Configuration);
+#endif
+                return output;
+            }
+        }
+
+        /// @brief Only used in decltype to get the class declaring Handle(TMessage&)
+        template<typename TMessage, typename TOwner>
+        static TOwner* HandleOwner(void (TOwner::*)(TMessage&));
+
+        /// @brief Add a packet to this filter
+        /// @param state Connection state of the packet
+        /// @param packet_id Id of the packet
+        void Add(const ProtocolCraft::ConnectionState state, const int packet_id);
+
+        /// @brief Add a packet type to this filter
+        /// @tparam TPacket Clientbound packet type
+        template<typename TPacket>
+        void Add()
+        {
+            if constexpr (TupleContains<TPacket, ProtocolCraft::AllClientboundLoginMessages>::value)
+            {
+                Add(ProtocolCraft::ConnectionState::Login, TPacket::packet_id);
+            }
+            if constexpr (TupleContains<TPacket, ProtocolCraft::AllClientboundStatusMessages>::value)
+            {
+                Add(ProtocolCraft::ConnectionState::Status, TPacket::packet_id);
+            }
+            if constexpr (TupleContains<TPacket, ProtocolCraft::AllClientboundPlayMessages>::value)
+            {
+                Add(ProtocolCraft::ConnectionState::Play, TPacket::packet_id);
+            }
+#if PROTOCOL_VERSION > 763 /* > 1.20.1 */
+            if constexpr (TupleContains<TPacket, ProtocolCraft::AllClientboundConfigurationMessages>::value)
+            {
+                Add(ProtocolCraft::ConnectionState::Configuration, TPacket::packet_id);
+            }
+#endif
+        }
+
+        /// @brief Remove a packet from this filter. Does nothing on a filter created with All()
+        /// @param state Connection state of the packet
+        /// @param packet_id Id of the packet
+        void Remove(const ProtocolCraft::ConnectionState state, const int packet_id);
+
+        /// @brief Set whether the light data of chunk packets can be skipped during parsing.
+        /// Only effective if all the handlers receiving the chunk packets skip them
+        /// @param skip_light_data_ True if the handler doesn't read light in chunk packets
+        void SetSkipLightData(const bool skip_light_data_);
+
+        /// @brief Check if the light data of chunk packets can be skipped for this filter
+        /// @return True if the light data of chunk packets are not needed
+        bool GetSkipLightData() const;
+
+        /// @brief Add all the packets of another filter to this one
+        PacketFilter& operator|=(const PacketFilter& other);
+
+        /// @brief Check if a packet is in this filter
+        /// @param state Connection state of the packet
+        /// @param packet_id Id of the packet
+        /// @return True if the packet is accepted by this filter
+        bool Contains(const ProtocolCraft::ConnectionState state, const int packet_id) const;
+
+        /// @brief Check if this filter accepts all packets
+        /// @return True if created with All()
+        bool IsAll() const;
+
+    private:
+        template<typename T, typename Tuple>
+        struct TupleContains;
+
+        template<typename T, typename... Ts>
+        struct TupleContains<T, std::tuple<Ts...> > : std::disjunction<std::is_same<T, Ts>...> {};
+
+        template<typename TDetector, typename TMessage>
+        static constexpr bool IsHandledBy()
+        {
+            if constexpr (std::is_invocable_v<TDetector, TMessage*>)
+            {
+                // Handle overloads inherited from GenericHandler are the default ones, ignore them
+                return std::is_base_of_v<ProtocolCraft::Handler, std::remove_pointer_t<std::invoke_result_t<TDetector, TMessage*> > >;
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        template<typename TDetector, typename TMessagesTuple, size_t... indices>
+        void AddHandled(const ProtocolCraft::ConnectionState state, std::index_sequence<indices...>)
+        {
+            ((IsHandledBy<TDetector, std::tuple_element_t<indices, TMessagesTuple> >() ? Add(state, std::tuple_element_t<indices, TMessagesTuple>::packet_id) : void()), ...);
+        }
+
+        template<typename TDetector, typename TMessagesTuple>
+        void AddHandled(const ProtocolCraft::ConnectionState state)
+        {
+            AddHandled<TDetector, TMessagesTuple>(state, std::make_index_sequence<std::tuple_size_v<TMessagesTuple> >{});
+        }
+
+    private:
+        bool all;
+        bool skip_light_data;
+        /// @brief Accepted packets, indexed by state then packet id
+        std::vector<std::vector<bool> > packets;
+    };
+} // Botcraft
+
+/// @brief Get a PacketFilter with all the packets THandler has a Handle overload for. Must be used
+/// in THandler scope (e.g. in one of its member functions), as Handle overloads are usually not public
+#define HANDLED_PACKETS_FILTER(THandler) ::Botcraft::PacketFilter::FromHandleOverloads( \
+    [](auto* msg) -> decltype(::Botcraft::PacketFilter::HandleOwner<std::remove_pointer_t<decltype(msg)> >(&THandler::Handle)) { return nullptr; })
@@ -11,6 +11,7 @@
 
 #include "botcraft/Game/Enums.hpp"
 #include "botcraft/Game/Vector3.hpp"
+#include "botcraft/Network/PacketFilter.hpp"
 
 #include "protocolCraft/Handler.hpp"
 
@@ -87,12 +88,12 @@ namespace Botcraft
             void UpdateBlackboardValue(const std::string& key, const std::any& value) const;
             void RemoveBlackboardValue(const std::string& key) const;
 
+            // Get the packets handled by this manager, to subscribe it to a NetworkManager
+            virtual PacketFilter GetPacketFilter() const;
 
         protected:
             void WaitForRenderingUpdate();
 
-            virtual void Handle(ProtocolCraft::Message& msg) override;
-            
             // Chunk stuff
             virtual void Handle(ProtocolCraft::ClientboundBlockUpdatePacket& msg) override;
             virtual void Handle(ProtocolCraft::ClientboundSectionBlocksUpdatePacket& msg) override;
@@ -19,4 +19,13 @@ namespace Botcraft::Utilities
     private:
         std::function<void()> callback;
     };
+
+    /// @brief Integer division rounded towards -inf
+    /// @param a Dividend
+    /// @param b Divisor, must be positive
+    /// @return floor(a / b)
+    inline int FloorDiv(const int a, const int b)
+    {
+        return (a >= 0 ? a : a - b + 1) / b;
+    }
 }
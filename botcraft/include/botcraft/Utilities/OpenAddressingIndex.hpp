@@ -0,0 +1,143 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Botcraft::Utilities
+{
+    /// @brief Hash a key made of packed coordinates
+    /// @param packed_key Coordinates packed in 64 bits
+    /// @return splitmix64 finalizer of the key, neighbouring coordinates end up in unrelated slots
+    inline size_t HashPackedKey(const uint64_t packed_key)
+    {
+        uint64_t h = packed_key;
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+        return static_cast<size_t>(h ^ (h >> 31));
+    }
+
+    /// @brief Open addressing table with linear probing, mapping 64 bits packed keys to the
+    /// index of entries stored contiguously by the owner. Keys are not stored in the table,
+    /// functions probing it take a callable returning the packed key of an entry index
+    class OpenAddressingIndex
+    {
+    public:
+        /// @brief Create an empty table
+        /// @param num_slots Number of slots, must be a power of 2
+        OpenAddressingIndex(const size_t num_slots)
+        {
+            slots = std::vector<uint32_t>(num_slots, empty_slot);
+            slot_mask = num_slots - 1;
+        }
+
+        size_t GetNumSlots() const
+        {
+            return slots.size();
+        }
+
+        /// @brief Find the slot of a key
+        /// @param packed_key Key to look for
+        /// @param key_of Callable returning the packed key of an entry index
+        /// @return Index of the slot, or of the first empty slot found if not present
+        template<class KeyOf>
+        size_t FindSlot(const uint64_t packed_key, const KeyOf& key_of) const
+        {
+            size_t slot = HashPackedKey(packed_key) & slot_mask;
+            while (slots[slot] != empty_slot && key_of(slots[slot] - 1) != packed_key)
+            {
+                slot = (slot + 1) & slot_mask;
+            }
+            return slot;
+        }
+
+        bool IsEmpty(const size_t slot) const
+        {
+            return slots[slot] == empty_slot;
+        }
+
+        /// @brief Get the entry index of a non empty slot
+        uint32_t GetIndex(const size_t slot) const
+        {
+            return slots[slot] - 1;
+        }
+
+        void SetIndex(const size_t slot, const uint32_t index)
+        {
+            slots[slot] = index + 1;
+        }
+
+        /// @brief Empty a slot without moving the following ones. Only valid if the
+        /// entries are removed in the reverse order of their insertion
+        void ResetSlot(const size_t slot)
+        {
+            slots[slot] = empty_slot;
+        }
+
+        /// @brief Empty all the slots
+        void Clear()
+        {
+            std::fill(slots.begin(), slots.end(), empty_slot);
+        }
+
+        /// @brief Grow the table if needed before adding an entry. The load factor is
+        /// kept under 0.5 so probe sequences stay short
+        /// @param num_entries Number of entries already indexed, in [0, num_entries)
+        /// @param key_of Callable returning the packed key of an entry index
+        /// @return True if the table was grown, previously found slots are then invalidated
+        template<class KeyOf>
+        bool ReserveOneMore(const size_t num_entries, const KeyOf& key_of)
+        {
+            if ((num_entries + 1) * 2 <= slots.size())
+            {
+                return false;
+            }
+            Rebuild(slots.size() * 2, num_entries, key_of);
+            return true;
+        }
+
+        /// @brief Resize the table and index all the entries again
+        /// @param num_slots New number of slots, must be a power of 2
+        /// @param num_entries Number of entries to index, in [0, num_entries)
+        /// @param key_of Callable returning the packed key of an entry index
+        template<class KeyOf>
+        void Rebuild(const size_t num_slots, const size_t num_entries, const KeyOf& key_of)
+        {
+            slots = std::vector<uint32_t>(num_slots, empty_slot);
+            slot_mask = num_slots - 1;
+            for (size_t i = 0; i < num_entries; ++i)
+            {
+                slots[FindSlot(key_of(i), key_of)] = static_cast<uint32_t>(i + 1);
+            }
+        }
+
+        /// @brief Empty a slot, moving back the following entries of the probe sequence so no tombstone is needed
+        /// @param slot Slot to empty
+        /// @param key_of Callable returning the packed key of an entry index
+        template<class KeyOf>
+        void Erase(size_t slot, const KeyOf& key_of)
+        {
+            size_t next = (slot + 1) & slot_mask;
+            while (slots[next] != empty_slot)
+            {
+                const size_t ideal = HashPackedKey(key_of(slots[next] - 1)) & slot_mask;
+                // Move the entry in the hole only if its ideal slot is not between the hole and its current position
+                if (((next - ideal) & slot_mask) >= ((next - slot) & slot_mask))
+                {
+                    slots[slot] = slots[next];
+                    slot = next;
+                }
+                next = (next + 1) & slot_mask;
+            }
+            slots[slot] = empty_slot;
+        }
+
+    private:
+        static constexpr uint32_t empty_slot = 0;
+
+        /// @brief Index of the entry + 1 for each slot, empty_slot if not used. Size is always a power of 2
+        std::vector<uint32_t> slots;
+        size_t slot_mask;
+    };
+} // Botcraft::Utilities
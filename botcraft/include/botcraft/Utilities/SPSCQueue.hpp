@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace Botcraft::Utilities
+{
+    /// @brief Bounded lock-free queue for exactly one producer
+    /// thread and one consumer thread
+    /// @tparam T Type of the stored elements, must be default constructible and movable
+    template<class T>
+    class SPSCQueue
+    {
+    public:
+        /// @brief Create an empty queue
+        /// @param min_capacity Minimum number of elements the queue can hold, rounded up to the next power of two
+        SPSCQueue(const size_t min_capacity)
+        {
+            size_t capacity = 1;
+            while (capacity < min_capacity)
+            {
+                capacity <<= 1;
+            }
+            slots.resize(capacity);
+            mask = capacity - 1;
+        }
+
+        SPSCQueue(const SPSCQueue&) = delete;
+        SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+        /// @brief Add an element at the end of the queue. Must only be called by the producer thread
+        /// @param value Element to add, only moved from if the push succeeds
+        /// @return True if the element was added, false if the queue is full
+        bool TryPush(T&& value)
+        {
+            const size_t current_tail = tail.load(std::memory_order_relaxed);
+            if (current_tail - cached_head > mask)
+            {
+                cached_head = head.load(std::memory_order_acquire);
+                if (current_tail - cached_head > mask)
+                {
+                    return false;
+                }
+            }
+            slots[current_tail & mask] = std::move(value);
+            tail.store(current_tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /// @brief Remove the first element of the queue. Must only be called by the consumer thread
+        /// @param value Output element, only modified if the pop succeeds
+        /// @return True if an element was removed, false if the queue is empty
+        bool TryPop(T& value)
+        {
+            const size_t current_head = head.load(std::memory_order_relaxed);
+            if (current_head == cached_tail)
+            {
+                cached_tail = tail.load(std::memory_order_acquire);
+                if (current_head == cached_tail)
+                {
+                    return false;
+                }
+            }
+            value = std::move(slots[current_head & mask]);
+            head.store(current_head + 1, std::memory_order_release);
+            return true;
+        }
+
+        /// @brief Get the number of elements in the queue. Can be called from any thread, but is only a snapshot
+        /// @return The number of elements currently waiting in the queue
+        size_t Size() const
+        {
+            const size_t current_head = head.load(std::memory_order_acquire);
+            const size_t current_tail = tail.load(std::memory_order_acquire);
+            return current_tail - current_head;
+        }
+
+        /// @brief Check if the queue is empty. Can be called from any thread, but is only a snapshot
+        /// @return True if there is no element in the queue
+        bool Empty() const
+        {
+            return Size() == 0;
+        }
+
+        /// @brief Get the maximum number of elements the queue can hold
+        /// @return The capacity of the queue
+        size_t Capacity() const
+        {
+            return slots.size();
+        }
+
+    private:
+        static constexpr size_t cache_line_size = 64;
+
+        std::vector<T> slots;
+        size_t mask;
+
+        // Consumer side. head and tail are on different cache lines
+        // so both threads don't invalidate each other's cache
+        alignas(cache_line_size) std::atomic<size_t> head{ 0 };
+        size_t cached_tail = 0;
+
+        // Producer side
+        alignas(cache_line_size) std::atomic<size_t> tail{ 0 };
+        size_t cached_head = 0;
+    };
+} // Botcraft::Utilities
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "botcraft/Game/Vector3.hpp"
+#include "botcraft/Game/World/Chunk.hpp"
+
+namespace Botcraft
+{
+    class Blockstate;
+    class World;
+    class WorldView;
+
+    enum class BlockPathfindingState: char
+    {
+        Empty = 0,
+        /// @brief Can walk on, can't go through
+        Solid = 1 << 0,
+        /// @brief Take damage if walk through/on
+        Hazardous = 1 << 1,
+        /// @brief Can climb up/down
+        Climbable = 1 << 2,
+        /// @brief Can climb but can't walk on
+        Fluid = 1 << 3
+    };
+
+    inline BlockPathfindingState operator|(const BlockPathfindingState a, const BlockPathfindingState b)
+    {
+        return static_cast<BlockPathfindingState>(static_cast<char>(a) | static_cast<char>(b));
+    }
+
+    inline bool operator&(const BlockPathfindingState a, const BlockPathfindingState b)
+    {
+        return (static_cast<char>(a) & static_cast<char>(b)) > 0;
+    }
+
+    /// @brief Get the coordinates of the section containing a block
+    /// @param pos Position of the block
+    /// @return Coordinates of the section, in sections
+    inline Position GetSectionCoords(const Position& pos)
+    {
+        // Arithmetic shifts round towards -inf, so negative coordinates end up in the right section
+        return Position(pos.x >> 4, pos.y >> 4, pos.z >> 4);
+    }
+
+    /// @brief Pack section coordinates in 64 bits, x and z on 26 bits, y on 12 bits
+    /// @param section Coordinates of the section
+    /// @return The packed coordinates
+    inline uint64_t PackSectionCoords(const Position& section)
+    {
+        return (static_cast<uint64_t>(section.x & 0x3FFFFFF) << 38) |
+            (static_cast<uint64_t>(section.z & 0x3FFFFFF) << 12) |
+            static_cast<uint64_t>(section.y & 0xFFF);
+    }
+
+    /// @brief Pathfinding state of the blocks of a world, read one section at a time
+    /// the first time a block in it is needed. The world is only locked while a
+    /// section is read, all the other queries are lookups in the local copy.
+    /// Changes in the world made after a section is read are not seen until
+    /// Update is called.
+    class PathfindingGrid
+    {
+    public:
+        /// @param world_ World to read the blocks from, must outlive this object
+        /// @param take_damage_ If true, blocks dealing damage are considered Hazardous
+        PathfindingGrid(const World& world_, const bool take_damage_);
+
+        /// @brief Get the pathfinding state of a block
+        /// @param pos Position of the block
+        /// @return The state of the block, Empty if not loaded
+        BlockPathfindingState GetState(const Position& pos);
+
+        /// @brief Check if a block is solid, regardless of its pathfinding state
+        /// (hazardous blocks can be solid)
+        /// @param pos Position of the block
+        /// @return True if the block is loaded and solid
+        bool IsSolid(const Position& pos);
+
+        /// @brief Check if the player could stand at a position, without checking if it can get there.
+        /// All the positions returned by GetNeighbours are standable
+        /// @param pos Position of the player feet
+        /// @return True if the feet are not in a solid or hazardous block, and are either supported or climbing
+        bool IsStandable(const Position& pos);
+
+        /// @brief Get all the positions the player can move to from a position, with the movement rules of FindPath
+        /// @param pos Position of the player feet
+        /// @param allow_jump If true, allow to jump above 1-wide gaps
+        /// @param neighbours Reachable positions and the cost to go there are appended to this vector
+        void GetNeighbours(const Position& pos, const bool allow_jump, std::vector<std::pair<Position, float>>& neighbours);
+
+        /// @brief Get the number of times the world has been read
+        /// @return The number of sections read
+        size_t GetNumSectionReads() const;
+
+        /// @brief Get the revision of the blocks of a section when it was read, reading it if it's not already
+        /// @param section Section coordinates (block coordinates / 16)
+        /// @return The revision of the section (see Chunk::GetSectionRevision), 0 if not loaded
+        unsigned long long int GetSectionRevision(const Position& section);
+
+        /// @brief Get the current revision of the blocks of a section
+        /// @param view A view of the world
+        /// @param section Section coordinates (block coordinates / 16)
+        /// @return The revision of the section (see Chunk::GetSectionRevision), 0 if not loaded
+        static unsigned long long int ReadSectionRevision(WorldView& view, const Position& section);
+
+        /// @brief Read again all the sections modified in the world since they were read
+        /// @param changed Positions of the blocks whose state changed are appended to this vector
+        void Update(std::vector<Position>& changed);
+
+    private:
+        static constexpr size_t section_size = CHUNK_WIDTH * SECTION_HEIGHT * CHUNK_WIDTH;
+
+        /// @brief Get the cached value of a block, reading its section from the world if needed
+        char GetValue(const Position& pos);
+        /// @brief Get the index of a section in sections, reading it from the world if needed
+        size_t GetSectionIndex(const Position& coords);
+        /// @brief Convert blocks read from the world to their cached values
+        void ConvertBlocks(const std::vector<const Blockstate*>& blocks, std::array<char, section_size>& section) const;
+
+    private:
+        /// @brief Bit added to the pathfinding state of solid blocks
+        static constexpr char solid_flag = 1 << 4;
+
+        const World& world;
+        const bool take_damage;
+        int world_min_y;
+
+        /// @brief State of each block (| solid_flag), (y * CHUNK_WIDTH + z) * CHUNK_WIDTH + x inside a section
+        std::vector<std::array<char, section_size>> sections;
+        /// @brief Revision of each section when it was read
+        std::vector<unsigned long long int> revisions;
+        /// @brief Coordinates of each section
+        std::vector<Position> section_coords;
+        /// @brief Index in sections for each packed section coordinates
+        std::unordered_map<uint64_t, size_t> sections_index;
+
+        /// @brief Last accessed section, consecutive queries are very likely in the same one
+        uint64_t cached_key;
+        const char* cached_section;
+    };
+} // Botcraft
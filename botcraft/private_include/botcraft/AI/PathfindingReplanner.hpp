@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "botcraft/AI/PathfindingGrid.hpp"
+#include "botcraft/AI/Tasks/PathfindingTask.hpp"
+#include "botcraft/Game/Vector3.hpp"
+
+namespace Botcraft
+{
+    class World;
+
+    /// @brief Incremental search of paths to a fixed goal (D* Lite). The search is
+    /// done backward from the goal and kept between calls, so when the start moves
+    /// or blocks change, only the nodes whose distance to the goal is affected are
+    /// explored again instead of restarting from scratch.
+    /// Not thread-safe, but can be used from any thread
+    class PathfindingReplanner
+    {
+    public:
+        /// @param world World to search the path in, must outlive this object
+        /// @param goal_ Goal position
+        /// @param allow_jump_ If true, allow to jump above 1-wide gaps
+        /// @param take_damage If true, avoid walking through or on hazardous blocks
+        PathfindingReplanner(const World& world, const Position& goal_, const bool allow_jump_, const bool take_damage);
+
+        /// @brief Find a path from start to the goal, repairing the previous search with the blocks changed since the last call
+        /// @param start Start position
+        /// @param budget_visit Max number of explored positions during this call before stopping the search
+        /// @param cancelled If not nullptr, the search is stopped as soon as it's set to true
+        /// @return A vector of positions to go through to reach the goal, start excluded.
+        /// Empty if the goal can't be reached, the budget is exceeded or cancelled
+        std::vector<Position> FindPath(const Position& start, const int budget_visit = default_pathfinding_budget_visit, const std::atomic<bool>* cancelled = nullptr);
+
+        /// @brief Get the goal of this search
+        /// @return The goal position
+        const Position& GetGoal() const;
+
+        /// @brief Get the number of nodes reached since the creation of this object
+        /// @return The number of nodes
+        size_t GetNumNodes() const;
+
+        /// @brief Get the number of positions explored during the last call to FindPath
+        /// @return The number of explored positions
+        int GetNumLastVisits() const;
+
+    private:
+        static constexpr uint32_t invalid_index = std::numeric_limits<uint32_t>::max();
+        static constexpr float infinity = std::numeric_limits<float>::infinity();
+
+        struct Key
+        {
+            float primary;
+            float secondary;
+
+            bool operator<(const Key& other) const;
+        };
+
+        struct Node
+        {
+            Position pos;
+            /// @brief Cost of the best known path to the goal
+            float g;
+            /// @brief One step lookahead cost to the goal, based on the successors g
+            float rhs;
+            Key key;
+            /// @brief Position of this node in the open set heap, invalid_index if not in it
+            uint32_t heap_index;
+            /// @brief False if successors have to be computed again
+            bool successors_valid;
+            /// @brief Reachable positions from this one and the cost to go there
+            std::vector<std::pair<Position, float>> successors;
+        };
+
+        uint32_t FindNode(const Position& pos) const;
+        uint32_t AddNode(const Position& pos);
+        float GetG(const Position& pos) const;
+
+        const std::vector<std::pair<Position, float>>& GetSuccessors(const uint32_t index);
+        /// @brief Find all the positions from which pos can be reached in one move
+        /// @param pos Position to search the predecessors of
+        /// @param predecessors Index of all predecessors, added to the nodes if needed
+        void GetPredecessors(const Position& pos, std::vector<uint32_t>& predecessors);
+
+        Key CalculateKey(const Node& node) const;
+        void UpdateVertex(const uint32_t index);
+        /// @brief Expand inconsistent nodes until the start is consistent
+        /// @return False if the budget is exceeded or cancelled
+        bool ComputeShortestPath(const uint32_t start_index, const int budget_visit, const std::atomic<bool>* cancelled);
+        /// @brief Read the blocks changed in the world and update the nodes affected by them
+        void ApplyWorldChanges();
+
+        void HeapInsert(const uint32_t index);
+        void HeapRemove(const uint32_t index);
+        void SiftUp(uint32_t heap_pos);
+        void SiftDown(uint32_t heap_pos);
+
+    private:
+        PathfindingGrid grid;
+        const Position goal;
+        const bool allow_jump;
+        int world_max_y;
+
+        /// @brief Start of the previous search and accumulated heuristic offset, to keep the keys in the open set valid when the start moves
+        Position last_start;
+        float key_modifier;
+        bool first_search;
+
+        std::vector<Node> nodes;
+        std::unordered_map<Position, uint32_t> nodes_index;
+        /// @brief Open set, min heap of node indices ordered by key
+        std::vector<uint32_t> heap;
+
+        int num_last_visits;
+
+        std::vector<Position> changed_blocks;
+        std::vector<std::pair<Position, float>> neighbours;
+    };
+} // Botcraft
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "botcraft/Game/Vector3.hpp"
+#include "botcraft/Utilities/OpenAddressingIndex.hpp"
+
+namespace Botcraft
+{
+    /// @brief Open and closed sets of an A* search over block positions.
+    /// Nodes are stored contiguously and reused between searches, the open set
+    /// is a binary heap of node indices supporting decrease-key, and nodes are
+    /// indexed by an open addressing table keyed on packed coordinates.
+    class PathfindingSearch
+    {
+    public:
+        static constexpr uint32_t invalid_index = std::numeric_limits<uint32_t>::max();
+
+        struct Node
+        {
+            Position pos;
+            /// @brief Cost of the best known path from the start
+            float cost;
+            /// @brief cost + heuristic to the goal, used to order the open set
+            float score;
+            /// @brief Index of the previous node on the best known path, invalid_index for the start
+            uint32_t parent;
+            /// @brief Position of this node in the open set heap, invalid_index if not in it
+            uint32_t heap_index;
+        };
+
+        PathfindingSearch();
+
+        /// @brief Remove all the nodes, keeping the allocated memory for the next search
+        /// unless it's much bigger than what this search needed
+        void Clear();
+
+        /// @brief Add a node to the open set, or update it if the new path to it is better
+        /// @param pos Position of the node
+        /// @param cost Cost of the path to pos
+        /// @param heuristic Estimated remaining cost from pos to the goal
+        /// @param parent Index of the previous node on the path, invalid_index for the start
+        /// @return True if the node was added or updated, false if a path at least as good was already known
+        bool Push(const Position& pos, const float cost, const float heuristic, const uint32_t parent);
+
+        /// @brief Check if there is any node left to explore
+        /// @return True if the open set is empty
+        bool IsOpenEmpty() const;
+
+        /// @brief Remove the node with the lowest score from the open set
+        /// @return Index of the node, must not be called on an empty open set
+        uint32_t PopBest();
+
+        /// @brief Get a node, references are invalidated by Push
+        /// @param index Index of the node
+        /// @return The node at index
+        const Node& GetNode(const uint32_t index) const;
+
+        /// @brief Get the number of nodes reached by the search (open and closed)
+        /// @return Number of nodes, valid indices are [0, GetNumNodes())
+        size_t GetNumNodes() const;
+
+        /// @brief Find a node by position
+        /// @param pos Position of the node
+        /// @return Index of the node, invalid_index if not reached by the search
+        uint32_t FindNode(const Position& pos) const;
+
+        /// @brief Get the path from the start to a node
+        /// @param index Index of the last node of the path
+        /// @return All the positions of the path, start excluded (unless index is the start node)
+        std::vector<Position> GetPath(const uint32_t index) const;
+
+    private:
+        /// @brief Pack a position in 64 bits, x and z on 26 bits, y on 12 bits like the network format
+        static uint64_t PackPosition(const Position& pos);
+
+        /// @brief Find the slot of a position in the table
+        /// @param packed_pos Packed position
+        /// @return Index of the slot, or of the first empty slot found if not present
+        size_t FindSlot(const uint64_t packed_pos) const;
+
+        void SiftUp(uint32_t heap_pos);
+        void SiftDown(uint32_t heap_pos);
+
+    private:
+        static constexpr size_t min_num_slots = 1024;
+
+        std::vector<Node> nodes;
+        /// @brief Packed position of each node, kept apart so probing doesn't load whole nodes
+        std::vector<uint64_t> node_keys;
+        /// @brief Open set, min heap of node indices ordered by score
+        std::vector<uint32_t> heap;
+        /// @brief Index of the nodes by packed position
+        Utilities::OpenAddressingIndex slots;
+    };
+} // Botcraft
@@ -2,19 +2,112 @@
 
 #include <vector>
 
+#include "botcraft/Game/Enums.hpp"
+
 namespace Botcraft
 {
     class Blockstate;
 
-    struct Section
+    /// @brief A 16x16x16 cube of blocks (+ the neighbouring blocks when using GUI).
+    /// Blocks are stored the same way as in the network format: bit-packed indices
+    /// in a palette, widened when a new blockstate doesn't fit anymore.
+    class Section
     {
-        Section(const bool has_sky_light);
+        friend class ChunkCache;
+
+    public:
+        Section();
 
         static size_t CoordsToBlockIndex(const int x, const int y, const int z);
         static size_t CoordsToLightIndex(const int x, const int y, const int z);
 
-        std::vector<unsigned short> data_blocks;
-        std::vector<unsigned char> block_light;
-        std::vector<unsigned char> sky_light;
+        /// @brief Get a blockstate id
+        /// @param index Index of the block, as given by CoordsToBlockIndex
+        /// @return Blockstate id of the block at index
+        unsigned short GetBlock(const size_t index) const
+        {
+            if (bits_per_block == 0)
+            {
+                return palette[0];
+            }
+            const size_t bit_offset = index * bits_per_block;
+            const unsigned short value = static_cast<unsigned short>((data[bit_offset >> 6] >> (bit_offset & 63)) & value_mask);
+            return bits_per_block == max_bits_per_block ? value : palette[value];
+        }
+
+        /// @brief Set a blockstate id, growing the palette if required
+        /// @param index Index of the block, as given by CoordsToBlockIndex
+        /// @param id Blockstate id
+        void SetBlock(const size_t index, const unsigned short id);
+
+        /// @brief Set all the blocks of this section to the same id
+        /// @param id Blockstate id
+        void Fill(const unsigned short id);
+
+        /// @brief Replace all the blocks with paletted data in the network format (1.16+, entries don't span across longs)
+        /// @param bits_per_entry Number of bits of each entry in packed, 0 for a single value section
+        /// @param network_palette Blockstate ids indexed by entries, empty if entries are global ids
+        /// @param packed Bit-packed entries, ordered by y, z then x
+        /// @return False if the data are invalid, the section is not modified in this case
+        bool LoadPackedData(const unsigned char bits_per_entry, const std::vector<int>& network_palette, const std::vector<unsigned long long int>& packed);
+
+        unsigned char GetBlockLight(const int x, const int y, const int z) const;
+        void SetBlockLight(const int x, const int y, const int z, const unsigned char v);
+
+        unsigned char GetSkyLight(const int x, const int y, const int z) const;
+        void SetSkyLight(const int x, const int y, const int z, const unsigned char v);
+
+        /// @brief Replace all the light values of this section
+        /// @param light Light values in the network format (two values per byte, ordered by y, z then x),
+        /// or empty if all values are 0. Must be empty or num_light_bytes long
+        /// @param sky If true, replace sky light, block light otherwise
+        void SetLightData(std::vector<char>&& light, const bool sky);
+
+#if USE_GUI
+        /// @brief Copy the blocks on the facing side of a neighbour section into one border of this section
+        /// @param neighbour Neighbour section, nullptr if it's only air
+        /// @param direction Side of this section the neighbour is on (North, West, East or South)
+        void CopyBorder(const Section* neighbour, const Orientation direction);
+
+        /// @brief Set all the blocks of one border of this section to the same id
+        /// @param direction Side of the border (North, West, East or South)
+        /// @param id Blockstate id
+        void FillBorder(const Orientation direction, const unsigned short id);
+#endif
+
+        /// @brief Get the number of bits currently used to store one block
+        /// @return 0 if all blocks are the same, 1, 2, 4 or 8 for palette indices, 16 for raw ids
+        unsigned char GetBitsPerBlock() const;
+
+        /// @brief Get the memory allocated for this section
+        /// @return Size in bytes, including the section itself
+        size_t GetMemoryUsage() const;
+
+    private:
+        unsigned short GetStoredValue(const size_t index) const;
+        void SetStoredValue(const size_t index, const unsigned short value);
+        /// @brief Check that all stored values can be used as palette indices
+        /// @return False if at least one value is outside the palette
+        bool HasValidPaletteIndices() const;
+        /// @brief Repack the data with more bits per block
+        /// @param new_bits_per_block New size, must be bigger than the current one
+        void Grow(const unsigned char new_bits_per_block);
+
+    private:
+        static constexpr unsigned char max_bits_per_block = 16;
+
+        /// @brief Blockstate ids, indexed by stored values. Unused when storing ids directly
+        std::vector<unsigned short> palette;
+        /// @brief Packed values, entries never span across multiple longs
+        std::vector<unsigned long long int> data;
+        unsigned char bits_per_block;
+        unsigned long long int value_mask;
+        /// @brief Palette index of the last set block, consecutive blocks are often the same
+        unsigned short last_palette_index;
+
+        /// @brief Two light values per byte, same layout as the network data. Empty if all values are 0
+        std::vector<char> block_light;
+        /// @brief Two light values per byte, same layout as the network data. Empty if all values are 0
+        std::vector<char> sky_light;
     };
 } // Botcraft
@@ -48,9 +48,24 @@ namespace Botcraft
             std::vector<unsigned char>& raw_shared_secret, std::vector<unsigned char>& encrypted_shared_secret,
             std::vector<unsigned char>& encrypted_challenge);
 #endif
+
+        /// @brief Initialize the AES contexts from an already known shared secret. Called by Init
+        /// @param shared_secret 16 bytes secret, used as both key and IV
+        void InitContexts(const std::vector<unsigned char>& shared_secret);
+
         std::vector<unsigned char> Encrypt(const std::vector<unsigned char>& in);
         std::vector<unsigned char> Decrypt(const std::vector<unsigned char>& in);
 
+        /// @brief Encrypt data in place. AES-CFB8 output has the same size as its input
+        /// @param data Pointer to the data to encrypt
+        /// @param size Number of bytes to encrypt
+        void Encrypt(unsigned char* data, const size_t size);
+
+        /// @brief Decrypt data in place. AES-CFB8 output has the same size as its input
+        /// @param data Pointer to the data to decrypt
+        /// @param size Number of bytes to decrypt
+        void Decrypt(unsigned char* data, const size_t size);
+
     private:
         EVP_CIPHER_CTX* encryption_context;
         EVP_CIPHER_CTX* decryption_context;
@@ -1,11 +1,54 @@
 #pragma once
 
+#ifdef USE_COMPRESSION
+
+#include <cstddef>
 #include <vector>
 
+typedef struct z_stream_s z_stream;
+
 namespace Botcraft
 {
-#ifdef USE_COMPRESSION
-    std::vector<unsigned char> Compress(const std::vector<unsigned char>& raw);
-    std::vector<unsigned char> Decompress(const std::vector<unsigned char>& compressed, const int start = 0);
-#endif
+    /// @brief Persistent zlib contexts of one connection. Streams are
+    /// reset and reused for each packet instead of being created again.
+    /// Compress and Decompress use different streams, so they can be
+    /// called from different threads, but each one must not be called
+    /// from several threads at the same time.
+    class CompressionContext
+    {
+    public:
+        /// @brief Create the inflate and deflate streams
+        /// @param compression_level zlib compression level used for outgoing packets, from 0 to 9, or -1 for zlib default
+        CompressionContext(const int compression_level = -1);
+        ~CompressionContext();
+
+        CompressionContext(const CompressionContext&) = delete;
+        CompressionContext& operator=(const CompressionContext&) = delete;
+
+        /// @brief Compress data and append the result at the end of a buffer
+        /// @param raw Pointer to the data to compress
+        /// @param raw_size Size of the data to compress
+        /// @param compressed Output buffer, compressed data are appended to its current content
+        void Compress(const unsigned char* raw, const size_t raw_size, std::vector<unsigned char>& compressed);
+
+        /// @brief Decompress zlib data into a pre-sized buffer
+        /// @param compressed Pointer to the compressed data
+        /// @param compressed_size Size of the compressed data
+        /// @param decompressed Output buffer, its size must be the expected decompressed size
+        void Decompress(const unsigned char* compressed, const size_t compressed_size, std::vector<unsigned char>& decompressed);
+
+        /// @brief Change the compression level used for the next Compress calls
+        /// @param compression_level zlib compression level, from 0 to 9, or -1 for zlib default
+        void SetCompressionLevel(const int compression_level);
+
+        /// @brief Get the current compression level
+        /// @return The zlib compression level used by Compress
+        int GetCompressionLevel() const;
+
+    private:
+        z_stream* inflate_stream;
+        z_stream* deflate_stream;
+        int compression_level;
+    };
 } // Botcraft
+#endif
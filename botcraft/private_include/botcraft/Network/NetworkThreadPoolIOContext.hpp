@@ -0,0 +1,20 @@
+#pragma once
+
+#include <asio/io_context.hpp>
+#include <asio/executor_work_guard.hpp>
+
+#include "botcraft/Network/NetworkThreadPool.hpp"
+
+namespace Botcraft
+{
+    struct NetworkThreadPool::IOContext
+    {
+        IOContext() : work_guard(asio::make_work_guard(io_context)), num_connections(0) {}
+
+        asio::io_context io_context;
+        /// @brief Keep io_context.run() alive even when no connection is active
+        asio::executor_work_guard<asio::io_context::executor_type> work_guard;
+        /// @brief Number of TCP_Com currently using this context, protected by NetworkThreadPool::mutex_contexts
+        unsigned int num_connections;
+    };
+} // Botcraft
@@ -1,11 +1,16 @@
 #pragma once
 
+#include <condition_variable>
 #include <deque>
+#include <functional>
+#include <memory>
 #include <thread>
 #include <mutex>
 #include <asio/error_code.hpp>
 #include <asio/ip/tcp.hpp>
-#include <asio/io_service.hpp>
+#include <asio/io_context.hpp>
+
+#include "botcraft/Network/NetworkThreadPool.hpp"
 
 namespace Botcraft
 {
@@ -16,8 +21,13 @@ namespace Botcraft
     class TCP_Com
     {
     public:
+        /// @brief Open a connection to a server
+        /// @param address Address of the server
+        /// @param callback Function called for every complete packet received. Data are only valid during the call
+        /// @param thread_pool If not null, the connection will run on this pool instead of spawning its own thread
         TCP_Com(const std::string& address,
-            std::function<void(const std::vector<unsigned char>&)> callback);
+            std::function<void(const unsigned char*, const size_t)> callback,
+            const std::shared_ptr<NetworkThreadPool>& thread_pool = nullptr);
         ~TCP_Com();
 
         void close();
@@ -34,9 +44,11 @@ namespace Botcraft
 
         void handle_connect(const asio::error_code& error);
 
+        void do_read();
+
         void handle_read(const asio::error_code& error, std::size_t bytes_transferred);
 
-        void do_write(const std::vector<unsigned char>& msg);
+        void do_write(std::vector<unsigned char>&& msg);
 
         void handle_write(const asio::error_code& error);
 
@@ -44,19 +56,40 @@ namespace Botcraft
 
         void SetIPAndPortFromAddress(const std::string& address);
 
+        /// @brief Wrap a completion handler so the number of in-flight
+        /// handlers referencing this object is tracked. Required when
+        /// running on a shared thread pool, as we can't join the thread
+        /// in the destructor to make sure they all completed
+        template<typename Handler>
+        auto TrackHandler(Handler&& handler);
 
     private:
-        // io_service must be declared before socket
-        asio::io_service io_service;
+        std::shared_ptr<NetworkThreadPool> thread_pool;
+        NetworkThreadPool::IOContext* pool_context;
+        // Only used if thread_pool is nullptr
+        std::unique_ptr<asio::io_context> owned_io_context;
+        // io_context must be declared before socket
+        asio::io_context& io_context;
         asio::ip::tcp::socket socket;
 
+        // Only used if thread_pool is nullptr
         std::thread thread_com;
 
-        std::array<unsigned char, 512> read_msg;
-        std::vector<unsigned char> input_msg;
+        int pending_handlers;
+        std::mutex mutex_pending_handlers;
+        std::condition_variable pending_handlers_condition;
+
+        static constexpr size_t input_buffer_default_size = 64 * 1024;
+        /// @brief Receive buffer. Data are read directly at the end and
+        /// complete packets are framed in place
+        std::vector<unsigned char> input_buffer;
+        /// @brief Index of the first byte not consumed yet in input_buffer
+        size_t input_start;
+        /// @brief Index of the end of received data in input_buffer
+        size_t input_end;
         std::deque<std::vector<unsigned char> > output_msg;
 
-        std::function<void(const std::vector<unsigned char>&)> NewPacketCallback;
+        std::function<void(const unsigned char*, const size_t)> NewPacketCallback;
         std::mutex mutex_output;
 
         std::string ip;
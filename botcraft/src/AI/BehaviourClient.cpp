@@ -1,14 +1,67 @@
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
 #include "botcraft/AI/BehaviourClient.hpp"
+#include "botcraft/AI/PathfindingGraph.hpp"
+#include "botcraft/AI/PathfindingService.hpp"
+#include "botcraft/Game/World/World.hpp"
 #if USE_GUI
 #include "botcraft/Renderer/RenderingManager.hpp"
 #endif
 
 namespace Botcraft
 {
+    namespace
+    {
+        std::mutex default_pathfinding_mutex;
+
+        /// @brief Service shared by all the clients without their own, threads are started on the first request
+        std::shared_ptr<PathfindingService> GetDefaultPathfindingService()
+        {
+            static std::weak_ptr<PathfindingService> default_service;
+            std::scoped_lock<std::mutex> lock(default_pathfinding_mutex);
+            std::shared_ptr<PathfindingService> output = default_service.lock();
+            if (output == nullptr)
+            {
+                output = std::make_shared<PathfindingService>(0);
+                default_service = output;
+            }
+            return output;
+        }
+
+        /// @brief Graph shared by all the clients using the same world without their own
+        std::shared_ptr<PathfindingGraph> GetDefaultPathfindingGraph(const std::shared_ptr<World>& world)
+        {
+            static std::unordered_map<const World*, std::pair<std::weak_ptr<World>, std::shared_ptr<PathfindingGraph>>> default_graphs;
+            std::scoped_lock<std::mutex> lock(default_pathfinding_mutex);
+            // Release the graphs of destroyed worlds
+            for (auto it = default_graphs.begin(); it != default_graphs.end(); )
+            {
+                if (it->second.first.expired())
+                {
+                    it = default_graphs.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+            auto& [graph_world, graph] = default_graphs[world.get()];
+            if (graph == nullptr)
+            {
+                graph_world = world;
+                graph = std::make_shared<PathfindingGraph>();
+            }
+            return graph;
+        }
+    }
+
     BehaviourClient::BehaviourClient(const bool use_renderer_) :
         ManagersClient(use_renderer_)
     {
         blackboard.Subscribe(this);
+        pathfinding_service = GetDefaultPathfindingService();
     }
 
     BehaviourClient::~BehaviourClient()
@@ -21,6 +74,26 @@ namespace Botcraft
         return blackboard;
     }
 
+    void BehaviourClient::SetSharedPathfindingGraph(const std::shared_ptr<PathfindingGraph> graph)
+    {
+        pathfinding_graph = graph;
+    }
+
+    std::shared_ptr<PathfindingGraph> BehaviourClient::GetPathfindingGraph() const
+    {
+        return pathfinding_graph != nullptr ? pathfinding_graph : GetDefaultPathfindingGraph(GetWorld());
+    }
+
+    void BehaviourClient::SetSharedPathfindingService(const std::shared_ptr<PathfindingService> service)
+    {
+        pathfinding_service = service;
+    }
+
+    std::shared_ptr<PathfindingService> BehaviourClient::GetPathfindingService() const
+    {
+        return pathfinding_service;
+    }
+
     void BehaviourClient::OnReset()
     {
 #if USE_GUI
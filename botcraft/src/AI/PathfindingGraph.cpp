@@ -0,0 +1,446 @@
+#include <algorithm>
+#include <cstdlib>
+#include <tuple>
+#include <unordered_set>
+
+#include "botcraft/AI/PathfindingGraph.hpp"
+#include "botcraft/AI/PathfindingGrid.hpp"
+#include "botcraft/AI/PathfindingSearch.hpp"
+#include "botcraft/AI/Tasks/PathfindingTask.hpp"
+
+#include "botcraft/Game/World/World.hpp"
+
+namespace Botcraft
+{
+    namespace
+    {
+        /// @brief Max number of positions explored to refine the path between two portals
+        constexpr int refine_budget_visit = 10000;
+
+        int ManhattanDistance(const Position& a, const Position& b)
+        {
+            return std::abs(a.x - b.x) + std::abs(a.y - b.y) + std::abs(a.z - b.z);
+        }
+    }
+
+    struct PathfindingGraph::Cluster
+    {
+        /// @brief Revisions of the 3x3x3 sections around this one when it was computed,
+        /// moves starting in a section read blocks in all its neighbours
+        std::array<unsigned long long int, 27> revisions;
+        /// @brief One move to a neighbour cluster for each contiguous portal
+        std::vector<Transition> exits;
+        /// @brief Reachable exits from each position already used to enter this cluster, guarded by the graph mutex
+        std::unordered_map<Position, std::vector<std::pair<size_t, float>>> entries;
+        /// @brief Value of the graph use counter the last time this cluster was used, guarded by the graph mutex
+        uint64_t last_used;
+    };
+
+    PathfindingGraph::PathfindingGraph(const size_t max_clusters_) : max_clusters(max_clusters_)
+    {
+        use_counter = 0;
+    }
+
+    PathfindingGraph::~PathfindingGraph()
+    {
+
+    }
+
+    std::vector<Position> PathfindingGraph::FindPath(const World& world, const Position& start, const Position& end, const bool allow_jump, const bool take_damage, const int budget_visit, const std::atomic<bool>* cancelled)
+    {
+        const Position end_section = GetSectionCoords(end);
+        if (GetSectionCoords(start) == end_section)
+        {
+            return {};
+        }
+
+        ClusterMap& cluster_map = clusters[(allow_jump ? 1 : 0) + (take_damage ? 2 : 0)];
+        // Clusters used during this search, so they stay the same even if another search updates them
+        std::unordered_map<uint64_t, std::shared_ptr<Cluster>> search_clusters;
+
+        PathfindingGrid grid(world, take_damage);
+        // Search on the portals
+        PathfindingSearch search;
+        // Search inside a cluster
+        PathfindingSearch local_search;
+        // For each node of the search, start of the move used to enter its cluster
+        std::vector<Position> transition_starts = { start };
+
+        search.Push(start, 0.0f, static_cast<float>(ManhattanDistance(start, end)), PathfindingSearch::invalid_index);
+
+        uint32_t best_index = 0;
+        int best_dist = ManhattanDistance(start, end);
+        int count_visit = 0;
+        while (!search.IsOpenEmpty() && count_visit < budget_visit)
+        {
+            if (cancelled != nullptr && cancelled->load(std::memory_order_relaxed))
+            {
+                return {};
+            }
+
+            count_visit++;
+            const uint32_t current_index = search.PopBest();
+            const Position current_pos = search.GetNode(current_index).pos;
+            const float current_cost = search.GetNode(current_index).cost;
+            const Position current_section = GetSectionCoords(current_pos);
+
+            // FindPath takes over once we are in the section of the goal
+            if (current_section == end_section)
+            {
+                best_index = current_index;
+                break;
+            }
+
+            const int dist = ManhattanDistance(current_pos, end);
+            if (dist < best_dist)
+            {
+                best_dist = dist;
+                best_index = current_index;
+            }
+
+            std::shared_ptr<Cluster>& cluster_ptr = search_clusters[PackSectionCoords(current_section)];
+            if (cluster_ptr == nullptr)
+            {
+                cluster_ptr = GetCluster(world, grid, current_section, allow_jump, cluster_map);
+            }
+            Cluster& cluster = *cluster_ptr;
+
+            std::vector<std::pair<size_t, float>> reachable_exits;
+            bool known_entry = false;
+            // Entries are kept for the next searches, but the start position is unlikely to be reused
+            if (current_index != 0)
+            {
+                std::scoped_lock<std::mutex> lock(mutex);
+                const auto it = cluster.entries.find(current_pos);
+                if (it != cluster.entries.end())
+                {
+                    reachable_exits = it->second;
+                    known_entry = true;
+                }
+            }
+            if (!known_entry)
+            {
+                reachable_exits = GetReachableExits(cluster, current_section, grid, local_search, current_pos, allow_jump);
+                if (current_index != 0)
+                {
+                    std::scoped_lock<std::mutex> lock(mutex);
+                    cluster.entries.insert({ current_pos, reachable_exits });
+                }
+            }
+
+            for (const auto& [exit_index, exit_cost] : reachable_exits)
+            {
+                const Transition& transition = cluster.exits[exit_index];
+                if (search.Push(transition.to, current_cost + exit_cost + transition.cost, static_cast<float>(ManhattanDistance(transition.to, end)), current_index))
+                {
+                    const uint32_t node_index = search.FindNode(transition.to);
+                    if (node_index >= transition_starts.size())
+                    {
+                        transition_starts.resize(node_index + 1);
+                    }
+                    transition_starts[node_index] = transition.from;
+                }
+            }
+        }
+
+        if (best_index == 0)
+        {
+            return {};
+        }
+
+        // Refine the path inside each cluster
+        std::vector<Position> output;
+        Position current_pos = start;
+        for (const Position& p : search.GetPath(best_index))
+        {
+            const Position transition_start = transition_starts[search.FindNode(p)];
+            if (current_pos != transition_start)
+            {
+                const std::vector<Position> segment = Botcraft::FindPath(world, current_pos, transition_start, 0, 0, 0, allow_jump, take_damage, refine_budget_visit, cancelled);
+                // Blocks changed since the cluster was computed, stop here
+                if (segment.empty() || segment.back() != transition_start)
+                {
+                    break;
+                }
+                output.insert(output.end(), segment.begin(), segment.end());
+            }
+            output.push_back(p);
+            current_pos = p;
+        }
+
+        if (cancelled != nullptr && cancelled->load(std::memory_order_relaxed))
+        {
+            return {};
+        }
+
+        return output;
+    }
+
+    void PathfindingGraph::Clear()
+    {
+        std::scoped_lock<std::mutex> lock(mutex);
+        for (ClusterMap& cluster_map : clusters)
+        {
+            cluster_map.clear();
+        }
+    }
+
+    size_t PathfindingGraph::GetNumClusters() const
+    {
+        std::scoped_lock<std::mutex> lock(mutex);
+        size_t output = 0;
+        for (const ClusterMap& cluster_map : clusters)
+        {
+            output += cluster_map.size();
+        }
+        return output;
+    }
+
+    std::shared_ptr<PathfindingGraph::Cluster> PathfindingGraph::GetCluster(const World& world, PathfindingGrid& grid, const Position& section, const bool allow_jump, ClusterMap& cluster_map)
+    {
+        std::array<unsigned long long int, 27> current_revisions;
+        {
+            WorldView view = world.GetView();
+            size_t i = 0;
+            for (int y = -1; y < 2; ++y)
+            {
+                for (int z = -1; z < 2; ++z)
+                {
+                    for (int x = -1; x < 2; ++x)
+                    {
+                        current_revisions[i++] = PathfindingGrid::ReadSectionRevision(view, section + Position(x, y, z));
+                    }
+                }
+            }
+        }
+
+        const uint64_t key = PackSectionCoords(section);
+        {
+            std::scoped_lock<std::mutex> lock(mutex);
+            const auto it = cluster_map.find(key);
+            if (it != cluster_map.end() && it->second->revisions == current_revisions)
+            {
+                it->second->last_used = ++use_counter;
+                return it->second;
+            }
+        }
+
+        // Compute the cluster without holding the lock
+        std::shared_ptr<Cluster> cluster = std::make_shared<Cluster>();
+        // Keep the revisions of the blocks used to compute the cluster. If the grid
+        // read them earlier in the search, they may be older than the current ones,
+        // and the cluster will be computed again next time
+        size_t i = 0;
+        for (int y = -1; y < 2; ++y)
+        {
+            for (int z = -1; z < 2; ++z)
+            {
+                for (int x = -1; x < 2; ++x)
+                {
+                    cluster->revisions[i++] = grid.GetSectionRevision(section + Position(x, y, z));
+                }
+            }
+        }
+
+        // Get all the moves leaving the cluster
+        const Position min(section.x * CHUNK_WIDTH, section.y * SECTION_HEIGHT, section.z * CHUNK_WIDTH);
+        std::vector<Transition> all_exits;
+        std::vector<std::pair<Position, float>> neighbours;
+        for (int y = 0; y < SECTION_HEIGHT; ++y)
+        {
+            for (int z = 0; z < CHUNK_WIDTH; ++z)
+            {
+                for (int x = 0; x < CHUNK_WIDTH; ++x)
+                {
+                    const Position pos = min + Position(x, y, z);
+                    if (!grid.IsStandable(pos))
+                    {
+                        continue;
+                    }
+                    neighbours.clear();
+                    grid.GetNeighbours(pos, allow_jump, neighbours);
+                    for (const auto& [next_pos, cost] : neighbours)
+                    {
+                        if (GetSectionCoords(next_pos) != section)
+                        {
+                            all_exits.push_back(Transition{ pos, next_pos, cost });
+                        }
+                    }
+                }
+            }
+        }
+
+        // Group the moves going to the same cluster the same way
+        const auto group_key = [](const Transition& t)
+        {
+            const Position target = GetSectionCoords(t.to);
+            const Position delta = t.to - t.from;
+            return std::make_tuple(target.x, target.y, target.z, delta.x, delta.y, delta.z);
+        };
+        std::sort(all_exits.begin(), all_exits.end(), [&](const Transition& a, const Transition& b)
+            {
+                return std::tuple_cat(group_key(a), std::make_tuple(a.from.y, a.from.z, a.from.x)) <
+                    std::tuple_cat(group_key(b), std::make_tuple(b.from.y, b.from.z, b.from.x));
+            });
+
+        const std::array<Position, 6> adjacent_offsets = {
+            Position(1, 0, 0), Position(-1, 0, 0), Position(0, 1, 0), Position(0, -1, 0), Position(0, 0, 1), Position(0, 0, -1)
+        };
+        size_t group_start = 0;
+        while (group_start < all_exits.size())
+        {
+            size_t group_end = group_start + 1;
+            while (group_end < all_exits.size() && group_key(all_exits[group_end]) == group_key(all_exits[group_start]))
+            {
+                group_end++;
+            }
+
+            // Cheapest move for each start position
+            std::unordered_map<Position, size_t> group_moves;
+            for (size_t j = group_start; j < group_end; ++j)
+            {
+                const auto [it, inserted] = group_moves.insert({ all_exits[j].from, j });
+                if (!inserted && all_exits[j].cost < all_exits[it->second].cost)
+                {
+                    it->second = j;
+                }
+            }
+
+            // Split the group in contiguous portals, and keep only the move in the middle of each
+            std::unordered_set<Position> visited;
+            for (size_t j = group_start; j < group_end; ++j)
+            {
+                if (!visited.insert(all_exits[j].from).second)
+                {
+                    continue;
+                }
+                std::vector<size_t> portal = { group_moves[all_exits[j].from] };
+                Position sum = all_exits[j].from;
+                for (size_t k = 0; k < portal.size(); ++k)
+                {
+                    for (const Position& offset : adjacent_offsets)
+                    {
+                        const auto it = group_moves.find(all_exits[portal[k]].from + offset);
+                        if (it != group_moves.end() && visited.insert(it->first).second)
+                        {
+                            portal.push_back(it->second);
+                            sum += it->first;
+                        }
+                    }
+                }
+
+                size_t middle = portal[0];
+                int middle_dist = std::numeric_limits<int>::max();
+                for (const size_t k : portal)
+                {
+                    const int dist = ManhattanDistance(all_exits[k].from * static_cast<int>(portal.size()), sum);
+                    if (dist < middle_dist)
+                    {
+                        middle_dist = dist;
+                        middle = k;
+                    }
+                }
+                cluster->exits.push_back(all_exits[middle]);
+            }
+
+            group_start = group_end;
+        }
+
+        std::scoped_lock<std::mutex> lock(mutex);
+        // Section not loaded (anymore), don't keep anything about it
+        if (current_revisions[13] == 0)
+        {
+            cluster_map.erase(key);
+            return cluster;
+        }
+        std::shared_ptr<Cluster>& stored = cluster_map[key];
+        // Keep the one computed by another search in the meantime if it's the same, with its entries
+        if (stored == nullptr || stored->revisions != cluster->revisions)
+        {
+            stored = cluster;
+        }
+        stored->last_used = ++use_counter;
+        const std::shared_ptr<Cluster> output = stored;
+        EvictClusters();
+
+        return output;
+    }
+
+    void PathfindingGraph::EvictClusters()
+    {
+        size_t num_clusters = 0;
+        for (const ClusterMap& cluster_map : clusters)
+        {
+            num_clusters += cluster_map.size();
+        }
+        if (max_clusters == 0 || num_clusters <= max_clusters)
+        {
+            return;
+        }
+
+        // Go down to 3/4 of the limit so this doesn't happen again for each new cluster
+        std::vector<uint64_t> last_used;
+        last_used.reserve(num_clusters);
+        for (const ClusterMap& cluster_map : clusters)
+        {
+            for (const auto& [key, cluster] : cluster_map)
+            {
+                last_used.push_back(cluster->last_used);
+            }
+        }
+        const size_t num_removed = num_clusters - max_clusters * 3 / 4;
+        std::nth_element(last_used.begin(), last_used.begin() + (num_removed - 1), last_used.end());
+        const uint64_t threshold = last_used[num_removed - 1];
+
+        for (ClusterMap& cluster_map : clusters)
+        {
+            for (auto it = cluster_map.begin(); it != cluster_map.end(); )
+            {
+                if (it->second->last_used <= threshold)
+                {
+                    it = cluster_map.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+    }
+
+    std::vector<std::pair<size_t, float>> PathfindingGraph::GetReachableExits(const Cluster& cluster, const Position& section,
+        PathfindingGrid& grid, PathfindingSearch& search, const Position& pos, const bool allow_jump) const
+    {
+        // Dijkstra restricted to the cluster
+        search.Clear();
+        search.Push(pos, 0.0f, 0.0f, PathfindingSearch::invalid_index);
+        std::vector<std::pair<Position, float>> neighbours;
+        while (!search.IsOpenEmpty())
+        {
+            const uint32_t current_index = search.PopBest();
+            const Position current_pos = search.GetNode(current_index).pos;
+            const float current_cost = search.GetNode(current_index).cost;
+
+            neighbours.clear();
+            grid.GetNeighbours(current_pos, allow_jump, neighbours);
+            for (const auto& [next_pos, cost] : neighbours)
+            {
+                if (GetSectionCoords(next_pos) == section)
+                {
+                    search.Push(next_pos, current_cost + cost, 0.0f, current_index);
+                }
+            }
+        }
+
+        std::vector<std::pair<size_t, float>> output;
+        for (size_t i = 0; i < cluster.exits.size(); ++i)
+        {
+            const uint32_t index = search.FindNode(cluster.exits[i].from);
+            if (index != PathfindingSearch::invalid_index)
+            {
+                output.push_back({ i, search.GetNode(index).cost });
+            }
+        }
+        return output;
+    }
+} // Botcraft
@@ -0,0 +1,594 @@
+#include <cstdlib>
+
+#include "botcraft/AI/PathfindingGrid.hpp"
+
+#include "botcraft/Game/World/Blockstate.hpp"
+#include "botcraft/Game/World/World.hpp"
+#include "botcraft/Game/World/WorldView.hpp"
+
+namespace Botcraft
+{
+    namespace
+    {
+        BlockPathfindingState GetBlockGoThroughState(const Blockstate* block, const bool take_damage)
+        {
+            if (block == nullptr)
+            {
+                return BlockPathfindingState::Empty;
+            }
+
+            if (take_damage && block->IsHazardous())
+            {
+                return BlockPathfindingState::Hazardous;
+            }
+
+            if (block->IsFluidOrWaterlogged() && !block->IsSolid())
+            {
+                return BlockPathfindingState::Climbable | BlockPathfindingState::Fluid;
+            }
+
+            if (block->IsClimbable())
+            {
+                return BlockPathfindingState::Climbable;
+            }
+
+            return block->IsSolid() ? BlockPathfindingState::Solid : BlockPathfindingState::Empty;
+        }
+    }
+
+    PathfindingGrid::PathfindingGrid(const World& world_, const bool take_damage_) : world(world_), take_damage(take_damage_)
+    {
+        world_min_y = world.GetMinY();
+        cached_key = 0;
+        cached_section = nullptr;
+    }
+
+    BlockPathfindingState PathfindingGrid::GetState(const Position& pos)
+    {
+        return static_cast<BlockPathfindingState>(GetValue(pos) & ~solid_flag);
+    }
+
+    bool PathfindingGrid::IsSolid(const Position& pos)
+    {
+        return GetValue(pos) & solid_flag;
+    }
+
+    bool PathfindingGrid::IsStandable(const Position& pos)
+    {
+        const BlockPathfindingState feet = GetState(pos);
+        if (feet == BlockPathfindingState::Solid || feet == BlockPathfindingState::Hazardous)
+        {
+            return false;
+        }
+        return feet & BlockPathfindingState::Climbable || GetState(pos + Position(0, -1, 0)) != BlockPathfindingState::Empty;
+    }
+
+    void PathfindingGrid::GetNeighbours(const Position& pos, const bool allow_jump, std::vector<std::pair<Position, float>>& neighbours)
+    {
+        const std::array<Position, 4> neighbour_offsets = { Position(1, 0, 0), Position(-1, 0, 0), Position(0, 0, 1), Position(0, 0, -1) };
+
+        // Get the state around the player in the given location
+        std::array<BlockPathfindingState, 6> vertical_surroundings = {
+            BlockPathfindingState::Solid, BlockPathfindingState::Solid, BlockPathfindingState::Solid,
+            BlockPathfindingState::Solid, BlockPathfindingState::Solid, BlockPathfindingState::Solid
+        };
+
+        // Assuming the player is standing on 3 (feeet on 2 and head on 1)
+        // 0
+        // 1
+        // 2
+        // 3
+        // 4
+        // 5
+        vertical_surroundings[0] = GetState(pos + Position(0, 2, 0));
+        vertical_surroundings[1] = GetState(pos + Position(0, 1, 0));
+        // Our feet block (should be climbable or empty)
+        vertical_surroundings[2] = GetState(pos);
+
+        // if 3 is solid or hazardous, no down pathfinding is possible,
+        // so we can skip a few checks
+        vertical_surroundings[3] = GetState(pos + Position(0, -1, 0));
+
+        // If we can move down, we need 4 and 5
+        if (vertical_surroundings[3] != BlockPathfindingState::Solid && vertical_surroundings[3] != BlockPathfindingState::Hazardous)
+        {
+            vertical_surroundings[4] = GetState(pos + Position(0, -2, 0));
+            vertical_surroundings[5] = GetState(pos + Position(0, -3, 0));
+        }
+
+
+        // Check all vertical cases that would allow the bot to pass
+        // -
+        // x
+        // ^
+        // ?
+        // ?
+        // ?
+        if (vertical_surroundings[2] & BlockPathfindingState::Climbable
+            && vertical_surroundings[1] != BlockPathfindingState::Solid
+            && vertical_surroundings[1] != BlockPathfindingState::Hazardous
+            && vertical_surroundings[0] != BlockPathfindingState::Solid
+            && vertical_surroundings[0] != BlockPathfindingState::Hazardous
+            )
+        {
+            neighbours.push_back({ pos + Position(0, 1, 0), 1.0f });
+        }
+
+        // -
+        // ^
+        //  
+        // o
+        // ?
+        // ?
+        if (vertical_surroundings[3] == BlockPathfindingState::Solid
+            && vertical_surroundings[2] == BlockPathfindingState::Empty
+            && vertical_surroundings[1] & BlockPathfindingState::Climbable
+            && vertical_surroundings[0] != BlockPathfindingState::Solid
+            && vertical_surroundings[0] != BlockPathfindingState::Hazardous
+            )
+        {
+            neighbours.push_back({ pos + Position(0, 1, 0), 1.5f });
+        }
+
+        // ?
+        // x
+        // x
+        // -
+        // ?
+        // ?
+        if (vertical_surroundings[3] & BlockPathfindingState::Climbable)
+        {
+            neighbours.push_back({ pos + Position(0, -1, 0), 1.0f });
+        }
+
+        // ?
+        // x
+        // x
+        // -
+        //  
+        // o
+        if (vertical_surroundings[3] & BlockPathfindingState::Climbable
+            && vertical_surroundings[4] == BlockPathfindingState::Empty
+            && vertical_surroundings[5] != BlockPathfindingState::Empty
+            && vertical_surroundings[5] != BlockPathfindingState::Hazardous
+            )
+        {
+            neighbours.push_back({ pos + Position(0, -2, 0), 2.0f });
+        }
+
+
+
+        // ?
+        // x
+        // ^
+        //  
+        //  
+        // o
+        if (vertical_surroundings[2] & BlockPathfindingState::Climbable
+            && vertical_surroundings[3] == BlockPathfindingState::Empty
+            && vertical_surroundings[4] == BlockPathfindingState::Empty
+            && vertical_surroundings[5] != BlockPathfindingState::Empty
+            && vertical_surroundings[5] != BlockPathfindingState::Hazardous
+            )
+        {
+            neighbours.push_back({ pos + Position(0, -2, 0), 2.0f });
+        }
+
+
+        // ?
+        // x
+        // x
+        // -
+        //  
+        //  
+        // Special case here, we can drop down
+        // if there is a climbable at the bottom
+        if (vertical_surroundings[3] & BlockPathfindingState::Climbable
+            && vertical_surroundings[4] == BlockPathfindingState::Empty
+            && vertical_surroundings[5] == BlockPathfindingState::Empty
+            )
+        {
+            for (int y = -4; pos.y + y >= world_min_y; --y)
+            {
+                if (IsSolid(pos + Position(0, y, 0)))
+                {
+                    break;
+                }
+
+                if (GetState(pos + Position(0, y, 0)) & BlockPathfindingState::Climbable)
+                {
+                    neighbours.push_back({ pos + Position(0, y + 1, 0), static_cast<float>(std::abs(y)) });
+
+                    break;
+                }
+            }
+        }
+
+
+        // For each neighbour, check if it's reachable
+        // and add it to the search list if it is
+        for (int i = 0; i < neighbour_offsets.size(); ++i)
+        {
+            const Position next_location = pos + neighbour_offsets[i];
+            const Position next_next_location = next_location + neighbour_offsets[i];
+
+            // Get the state around the player in the given direction
+            std::array<BlockPathfindingState, 12> horizontal_surroundings = {
+                BlockPathfindingState::Solid, BlockPathfindingState::Solid, BlockPathfindingState::Solid,
+                BlockPathfindingState::Solid, BlockPathfindingState::Solid, BlockPathfindingState::Solid,
+                BlockPathfindingState::Solid, BlockPathfindingState::Solid, BlockPathfindingState::Solid,
+                BlockPathfindingState::Solid, BlockPathfindingState::Solid, BlockPathfindingState::Solid
+            };
+
+            // Assuming the player is standing on v3 (feeet on v2 and head on v1)
+            // v0   0   6 --> ?  ?  ?
+            // v1   1   7 --> x  ?  ?
+            // v2   2   8 --> x  ?  ?
+            // v3   3   9 --> ?  ?  ?
+            // v4   4  10 --> ?  ?  ?
+            // v5   5  11 --> ?  ?  ?
+
+            // if 1 is solid, no horizontal pathfinding is possible,
+            // so we can skip a lot of checks
+            horizontal_surroundings[1] = GetState(next_location + Position(0, 1, 0));
+            const bool horizontal_movement = horizontal_surroundings[1] != BlockPathfindingState::Solid && horizontal_surroundings[1] != BlockPathfindingState::Hazardous;
+
+            // If we can move horizontally, we need the full column
+            if (horizontal_movement)
+            {
+                horizontal_surroundings[0] = GetState(next_location + Position(0, 2, 0));
+                horizontal_surroundings[2] = GetState(next_location);
+                horizontal_surroundings[3] = GetState(next_location + Position(0, -1, 0));
+                horizontal_surroundings[4] = GetState(next_location + Position(0, -2, 0));
+                horizontal_surroundings[5] = GetState(next_location + Position(0, -3, 0));
+            }
+
+            // You can't make large jumps if your feet are in a climbable block
+            // If we can jump, then we need the third column
+            if (allow_jump && !(vertical_surroundings[2] & BlockPathfindingState::Climbable))
+            {
+                horizontal_surroundings[6] = GetState(next_next_location + Position(0, 2, 0));
+                horizontal_surroundings[7] = GetState(next_next_location + Position(0, 1, 0));
+                horizontal_surroundings[8] = GetState(next_next_location);
+                horizontal_surroundings[9] = GetState(next_next_location + Position(0, -1, 0));
+                horizontal_surroundings[10] = GetState(next_next_location + Position(0, -2, 0));
+                horizontal_surroundings[11] = GetState(next_next_location + Position(0, -3, 0));
+            }
+
+            // Now that we know the surroundings, we can check all
+            // horizontal cases that would allow the bot to pass
+
+            /************ HORIZONTAL **************/
+
+            // ?  ?  ?
+            // x  -  ?
+            // x  -  ?
+            //--- o  ?
+            //    ?  ?
+            //    ?  ?
+            if (horizontal_surroundings[1] != BlockPathfindingState::Solid
+                && horizontal_surroundings[1] != BlockPathfindingState::Hazardous
+                && horizontal_surroundings[2] != BlockPathfindingState::Solid
+                && horizontal_surroundings[2] != BlockPathfindingState::Hazardous
+                && horizontal_surroundings[3] != BlockPathfindingState::Empty
+                && horizontal_surroundings[3] != BlockPathfindingState::Hazardous
+                && (!(horizontal_surroundings[3] & BlockPathfindingState::Fluid)  // We can't go from above a fluid to above
+                    || !(vertical_surroundings[3] & BlockPathfindingState::Fluid) // another one to avoid "walking on water"
+                    || horizontal_surroundings[2] & BlockPathfindingState::Fluid  // except if one or both "leg level" blocks
+                    || vertical_surroundings[2] & BlockPathfindingState::Fluid)   // are also fluids
+                )
+            {
+                neighbours.push_back({ next_location, 1.0f });
+            }
+
+
+            // -  -  ?
+            // x  ^  ?
+            // x  ?  ?
+            //--- ?  ?
+            //    ?  ?
+            //    ?  ?
+            if (vertical_surroundings[0] != BlockPathfindingState::Solid
+                && vertical_surroundings[0] != BlockPathfindingState::Hazardous
+                && vertical_surroundings[1] == BlockPathfindingState::Empty
+                && vertical_surroundings[2] == BlockPathfindingState::Empty
+                && vertical_surroundings[3] == BlockPathfindingState::Solid
+                && horizontal_surroundings[0] != BlockPathfindingState::Solid
+                && horizontal_surroundings[0] != BlockPathfindingState::Hazardous
+                && horizontal_surroundings[1] & BlockPathfindingState::Climbable
+                )
+            {
+                neighbours.push_back({ next_location + Position(0, 1, 0), 2.5f });
+            }
+
+            // -  -  ?
+            // x  -  ?
+            // x  o  ?
+            //--- ?  ?
+            //    ?  ?
+            //    ?  ?
+            if (vertical_surroundings[0] != BlockPathfindingState::Solid
+                && vertical_surroundings[0] != BlockPathfindingState::Hazardous
+                && vertical_surroundings[1] == BlockPathfindingState::Empty
+                && vertical_surroundings[2] == BlockPathfindingState::Empty
+                && vertical_surroundings[3] == BlockPathfindingState::Solid
+                && horizontal_surroundings[0] != BlockPathfindingState::Solid
+                && horizontal_surroundings[0] != BlockPathfindingState::Hazardous
+                && horizontal_surroundings[1] != BlockPathfindingState::Solid
+                && horizontal_surroundings[1] != BlockPathfindingState::Hazardous
+                && horizontal_surroundings[2] != BlockPathfindingState::Empty
+                && horizontal_surroundings[2] != BlockPathfindingState::Hazardous
+                )
+            {
+                neighbours.push_back({ next_location + Position(0, 1, 0), 2.5f });
+            }
+
+            // ?  ?  ?
+            // x  -  ?
+            // x     ?
+            //---    ?
+            //    o  ?
+            //    ?  ?
+            if (horizontal_surroundings[1] != BlockPathfindingState::Solid
+                && horizontal_surroundings[1] != BlockPathfindingState::Hazardous
+                && horizontal_surroundings[2] == BlockPathfindingState::Empty
+                && horizontal_surroundings[3] == BlockPathfindingState::Empty
+                && horizontal_surroundings[4] != BlockPathfindingState::Empty
+                && horizontal_surroundings[4] != BlockPathfindingState::Hazardous
+                )
+            {
+                neighbours.push_back({ next_location + Position(0, -1, 0), 2.5f });
+            }
+
+            // ?  ?  ?
+            // x  -  ?
+            // x     ?
+            //---    ?
+            //       ?
+            //    o  ?
+            if (horizontal_surroundings[1] != BlockPathfindingState::Solid
+                && horizontal_surroundings[1] != BlockPathfindingState::Hazardous
+                && horizontal_surroundings[2] == BlockPathfindingState::Empty
+                && horizontal_surroundings[3] == BlockPathfindingState::Empty
+                && horizontal_surroundings[4] == BlockPathfindingState::Empty
+                && horizontal_surroundings[5] != BlockPathfindingState::Empty
+                && horizontal_surroundings[5] != BlockPathfindingState::Hazardous
+                )
+            {
+                neighbours.push_back({ next_location + Position(0, -2, 0), 3.5f });
+            }
+
+            // ?  ?  ?
+            // x  -  ?
+            // x     ?
+            //---    ?
+            //       ?
+            //       ?
+            // Special case here, we can drop down
+            // if there is a climbable at the bottom
+            if (horizontal_surroundings[1] != BlockPathfindingState::Solid
+                && horizontal_surroundings[1] != BlockPathfindingState::Hazardous
+                && horizontal_surroundings[2] == BlockPathfindingState::Empty
+                && horizontal_surroundings[3] == BlockPathfindingState::Empty
+                && horizontal_surroundings[4] == BlockPathfindingState::Empty
+                && horizontal_surroundings[5] == BlockPathfindingState::Empty
+                )
+            {
+                for (int y = -4; next_location.y + y >= world_min_y; --y)
+                {
+                    if (IsSolid(next_location + Position(0, y, 0)))
+                    {
+                        break;
+                    }
+
+                    if (GetState(next_location + Position(0, y, 0)) & BlockPathfindingState::Climbable)
+                    {
+                        neighbours.push_back({ next_location + Position(0, y + 1, 0), std::abs(y) + 1.5f });
+
+                        break;
+                    }
+                }
+            }
+
+            // If we can't make jumps, don't bother explore the rest
+            // of the cases
+            if (!allow_jump
+                || vertical_surroundings[0] == BlockPathfindingState::Solid       // Block above
+                || vertical_surroundings[0] == BlockPathfindingState::Hazardous   // Block above
+                || vertical_surroundings[1] != BlockPathfindingState::Empty       // Block above
+                || vertical_surroundings[2] != BlockPathfindingState::Empty       // Feet inside climbable
+                || vertical_surroundings[3] & BlockPathfindingState::Fluid        // "Walking" on fluid
+                || vertical_surroundings[3] == BlockPathfindingState::Empty       // Feet on nothing (inside climbable)
+                || horizontal_surroundings[0] == BlockPathfindingState::Solid     // Block above next column
+                || horizontal_surroundings[0] == BlockPathfindingState::Hazardous // Hazard above next column
+                || horizontal_surroundings[1] != BlockPathfindingState::Empty     // Non empty block in next column, can't jump through it
+                || horizontal_surroundings[2] != BlockPathfindingState::Empty     // Non empty block in next column, can't jump through it
+                || horizontal_surroundings[6] == BlockPathfindingState::Solid     // Block above nextnext column
+                || horizontal_surroundings[6] == BlockPathfindingState::Hazardous // Hazard above nextnext column
+                || horizontal_surroundings[7] != BlockPathfindingState::Empty     // Non empty block in nextnext column, can't jump through it
+                )
+            {
+                continue;
+            }
+
+            /************ BIG JUMP **************/
+            // -  -  -
+            // x      
+            // x     o
+            //--- ?  ?
+            //    ?  ?
+            //    ?  ?
+            if (horizontal_surroundings[8] != BlockPathfindingState::Empty
+                && horizontal_surroundings[8] != BlockPathfindingState::Hazardous
+                )
+            {
+                // 4 > 3.5 as if horizontal_surroundings[3] is solid we prefer to walk then jump instead of big jump
+                // but if horizontal_surroundings[3] is hazardous we can jump over it
+                neighbours.push_back({ next_next_location + Position(0, 1, 0), 4.0f });
+            }
+
+            // -  -  -
+            // x      
+            // x      
+            //--- ?  o
+            //    ?  ?
+            //    ?  ?
+            if (horizontal_surroundings[8] == BlockPathfindingState::Empty
+                && horizontal_surroundings[9] != BlockPathfindingState::Empty
+                && horizontal_surroundings[9] != BlockPathfindingState::Hazardous
+                )
+            {
+                neighbours.push_back({ next_next_location, 2.5f });
+            }
+
+            // -  -  -
+            // x      
+            // x      
+            //--- ?   
+            //    ?  o
+            //    ?  ?
+            if (horizontal_surroundings[8] == BlockPathfindingState::Empty
+                && horizontal_surroundings[9] == BlockPathfindingState::Empty
+                && horizontal_surroundings[10] != BlockPathfindingState::Empty
+                && horizontal_surroundings[10] != BlockPathfindingState::Hazardous
+                )
+            {
+                neighbours.push_back({ next_next_location + Position(0, -1, 0), 4.5f });
+            }
+
+            // -  -  -
+            // x      
+            // x      
+            //--- ?   
+            //    ?   
+            //    ?  o
+            if (horizontal_surroundings[8] == BlockPathfindingState::Empty
+                && horizontal_surroundings[9] == BlockPathfindingState::Empty
+                && horizontal_surroundings[10] == BlockPathfindingState::Empty
+                && horizontal_surroundings[11] != BlockPathfindingState::Empty
+                && horizontal_surroundings[11] != BlockPathfindingState::Hazardous
+                )
+            {
+                neighbours.push_back({ next_next_location + Position(0, -2, 0), 5.5f });
+            }
+        } // neighbour loop
+    }
+
+    size_t PathfindingGrid::GetNumSectionReads() const
+    {
+        return sections.size();
+    }
+
+    unsigned long long int PathfindingGrid::GetSectionRevision(const Position& section)
+    {
+        return revisions[GetSectionIndex(section)];
+    }
+
+    unsigned long long int PathfindingGrid::ReadSectionRevision(WorldView& view, const Position& section)
+    {
+        const Chunk* chunk = view.GetChunk(section.x, section.z);
+        if (chunk == nullptr)
+        {
+            return 0;
+        }
+        const int offset = section.y * SECTION_HEIGHT - chunk->GetMinY();
+        if (offset < 0 || offset >= chunk->GetHeight())
+        {
+            return 0;
+        }
+        return chunk->GetSectionRevision(offset / SECTION_HEIGHT);
+    }
+
+    void PathfindingGrid::Update(std::vector<Position>& changed)
+    {
+        std::vector<size_t> outdated;
+        std::vector<std::vector<const Blockstate*>> outdated_blocks;
+        {
+            WorldView view = world.GetView();
+            for (size_t i = 0; i < sections.size(); ++i)
+            {
+                const unsigned long long int revision = ReadSectionRevision(view, section_coords[i]);
+                if (revision == revisions[i])
+                {
+                    continue;
+                }
+                const Position min(section_coords[i].x * CHUNK_WIDTH, section_coords[i].y * SECTION_HEIGHT, section_coords[i].z * CHUNK_WIDTH);
+                revisions[i] = revision;
+                outdated.push_back(i);
+                outdated_blocks.push_back(view.GetBlocks(min, min + Position(CHUNK_WIDTH - 1, SECTION_HEIGHT - 1, CHUNK_WIDTH - 1)));
+            }
+        }
+
+        std::array<char, section_size> section;
+        for (size_t i = 0; i < outdated.size(); ++i)
+        {
+            ConvertBlocks(outdated_blocks[i], section);
+            std::array<char, section_size>& cached = sections[outdated[i]];
+            const Position min(section_coords[outdated[i]].x * CHUNK_WIDTH, section_coords[outdated[i]].y * SECTION_HEIGHT, section_coords[outdated[i]].z * CHUNK_WIDTH);
+            for (size_t j = 0; j < section_size; ++j)
+            {
+                if (section[j] != cached[j])
+                {
+                    changed.push_back(min + Position(static_cast<int>(j % CHUNK_WIDTH), static_cast<int>(j / (CHUNK_WIDTH * CHUNK_WIDTH)), static_cast<int>((j / CHUNK_WIDTH) % CHUNK_WIDTH)));
+                }
+            }
+            // Updated in place, cached_section stays valid
+            cached = section;
+        }
+    }
+
+    char PathfindingGrid::GetValue(const Position& pos)
+    {
+        const Position coords = GetSectionCoords(pos);
+        const size_t index = (static_cast<size_t>(pos.y & 0xF) * CHUNK_WIDTH + (pos.z & 0xF)) * CHUNK_WIDTH + (pos.x & 0xF);
+
+        const uint64_t key = PackSectionCoords(coords);
+        if (cached_section == nullptr || cached_key != key)
+        {
+            const size_t section_index = GetSectionIndex(coords);
+            cached_section = sections[section_index].data();
+            cached_key = key;
+        }
+        return cached_section[index];
+    }
+
+    size_t PathfindingGrid::GetSectionIndex(const Position& coords)
+    {
+        const uint64_t key = PackSectionCoords(coords);
+        auto it = sections_index.find(key);
+        if (it != sections_index.end())
+        {
+            return it->second;
+        }
+
+        const Position min(coords.x * CHUNK_WIDTH, coords.y * SECTION_HEIGHT, coords.z * CHUNK_WIDTH);
+        std::vector<const Blockstate*> blocks;
+        unsigned long long int revision = 0;
+        {
+            // Blocks and revision are read with the same lock so they always match
+            WorldView view = world.GetView();
+            revision = ReadSectionRevision(view, coords);
+            // Same layout as the section array
+            blocks = view.GetBlocks(min, min + Position(CHUNK_WIDTH - 1, SECTION_HEIGHT - 1, CHUNK_WIDTH - 1));
+        }
+
+        std::array<char, section_size> section;
+        ConvertBlocks(blocks, section);
+        // Pushing a new section may move the others in memory
+        cached_section = nullptr;
+        sections.push_back(section);
+        revisions.push_back(revision);
+        section_coords.push_back(coords);
+        sections_index.insert({ key, sections.size() - 1 });
+        return sections.size() - 1;
+    }
+
+    void PathfindingGrid::ConvertBlocks(const std::vector<const Blockstate*>& blocks, std::array<char, section_size>& section) const
+    {
+        for (size_t i = 0; i < section_size; ++i)
+        {
+            section[i] = static_cast<char>(GetBlockGoThroughState(blocks[i], take_damage)) |
+                (blocks[i] != nullptr && blocks[i]->IsSolid() ? solid_flag : 0);
+        }
+    }
+} // Botcraft
@@ -0,0 +1,428 @@
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+
+#include "botcraft/AI/PathfindingReplanner.hpp"
+
+#include "botcraft/Game/World/World.hpp"
+
+namespace Botcraft
+{
+    namespace
+    {
+        /// @brief Horizontal offsets of the columns a move can reach (or read blocks in)
+        const std::array<Position, 9> move_columns = {
+            Position(0, 0, 0),
+            Position(1, 0, 0), Position(-1, 0, 0), Position(0, 0, 1), Position(0, 0, -1),
+            Position(2, 0, 0), Position(-2, 0, 0), Position(0, 0, 2), Position(0, 0, -2)
+        };
+        /// @brief Horizontal offsets of the columns a long fall can start from, the 5 first move columns
+        constexpr size_t num_fall_columns = 5;
+
+        float Heuristic(const Position& a, const Position& b)
+        {
+            return static_cast<float>(std::abs(a.x - b.x) + std::abs(a.y - b.y) + std::abs(a.z - b.z));
+        }
+    }
+
+    bool PathfindingReplanner::Key::operator<(const Key& other) const
+    {
+        return primary < other.primary || (primary == other.primary && secondary < other.secondary);
+    }
+
+    PathfindingReplanner::PathfindingReplanner(const World& world, const Position& goal_, const bool allow_jump_, const bool take_damage) :
+        grid(world, take_damage), goal(goal_), allow_jump(allow_jump_)
+    {
+        world_max_y = world.GetMinY() + world.GetHeight();
+        key_modifier = 0.0f;
+        first_search = true;
+        num_last_visits = 0;
+
+        const uint32_t goal_index = AddNode(goal);
+        nodes[goal_index].rhs = 0.0f;
+    }
+
+    std::vector<Position> PathfindingReplanner::FindPath(const Position& start, const int budget_visit, const std::atomic<bool>* cancelled)
+    {
+        num_last_visits = 0;
+
+        if (first_search)
+        {
+            last_start = start;
+            first_search = false;
+            const uint32_t goal_index = FindNode(goal);
+            nodes[goal_index].key = CalculateKey(nodes[goal_index]);
+            HeapInsert(goal_index);
+        }
+        else
+        {
+            // Keys already in the open set were computed with the previous start
+            key_modifier += Heuristic(last_start, start);
+            last_start = start;
+            ApplyWorldChanges();
+        }
+
+        uint32_t start_index = FindNode(start);
+        if (start_index == invalid_index)
+        {
+            start_index = AddNode(start);
+            UpdateVertex(start_index);
+        }
+
+        if (!ComputeShortestPath(start_index, budget_visit, cancelled) || nodes[start_index].g == infinity)
+        {
+            return {};
+        }
+
+        // Follow the best successor from the start
+        std::vector<Position> path;
+        Position current = start;
+        while (current != goal)
+        {
+            const std::vector<std::pair<Position, float>>& successors = GetSuccessors(FindNode(current));
+            float best_cost = infinity;
+            Position best_pos;
+            for (const auto& [pos, cost] : successors)
+            {
+                const float c = cost + GetG(pos);
+                if (c < best_cost)
+                {
+                    best_cost = c;
+                    best_pos = pos;
+                }
+            }
+            // Should not happen once the start is consistent, but never loop forever
+            if (best_cost == infinity || path.size() > nodes.size())
+            {
+                return {};
+            }
+            path.push_back(best_pos);
+            current = best_pos;
+        }
+
+        return path;
+    }
+
+    const Position& PathfindingReplanner::GetGoal() const
+    {
+        return goal;
+    }
+
+    size_t PathfindingReplanner::GetNumNodes() const
+    {
+        return nodes.size();
+    }
+
+    int PathfindingReplanner::GetNumLastVisits() const
+    {
+        return num_last_visits;
+    }
+
+    uint32_t PathfindingReplanner::FindNode(const Position& pos) const
+    {
+        auto it = nodes_index.find(pos);
+        return it == nodes_index.end() ? invalid_index : it->second;
+    }
+
+    uint32_t PathfindingReplanner::AddNode(const Position& pos)
+    {
+        const uint32_t index = static_cast<uint32_t>(nodes.size());
+        nodes.push_back(Node{ pos, infinity, infinity, Key{ infinity, infinity }, invalid_index, false, {} });
+        nodes_index.insert({ pos, index });
+        return index;
+    }
+
+    float PathfindingReplanner::GetG(const Position& pos) const
+    {
+        const uint32_t index = FindNode(pos);
+        return index == invalid_index ? infinity : nodes[index].g;
+    }
+
+    const std::vector<std::pair<Position, float>>& PathfindingReplanner::GetSuccessors(const uint32_t index)
+    {
+        Node& node = nodes[index];
+        if (!node.successors_valid)
+        {
+            node.successors.clear();
+            grid.GetNeighbours(node.pos, allow_jump, node.successors);
+            node.successors_valid = true;
+        }
+        return node.successors;
+    }
+
+    void PathfindingReplanner::GetPredecessors(const Position& pos, std::vector<uint32_t>& predecessors)
+    {
+        predecessors.clear();
+
+        const auto is_successor = [&pos](const std::vector<std::pair<Position, float>>& successors) -> bool
+        {
+            return std::any_of(successors.begin(), successors.end(), [&pos](const std::pair<Position, float>& s) { return s.first == pos; });
+        };
+
+        const auto check_candidate = [&](const Position& candidate)
+        {
+            // GetNeighbours doesn't check the start position, avoid adding nodes inside walls
+            if (!grid.IsStandable(candidate))
+            {
+                return;
+            }
+            uint32_t index = FindNode(candidate);
+            if (index != invalid_index)
+            {
+                if (is_successor(GetSuccessors(index)))
+                {
+                    predecessors.push_back(index);
+                }
+                return;
+            }
+            neighbours.clear();
+            grid.GetNeighbours(candidate, allow_jump, neighbours);
+            if (is_successor(neighbours))
+            {
+                index = AddNode(candidate);
+                nodes[index].successors = neighbours;
+                nodes[index].successors_valid = true;
+                predecessors.push_back(index);
+            }
+        };
+
+        // Moves go at most 1 block up and 2 blocks horizontally, and
+        // fall more than 2 blocks only when landing on a climbable block
+        for (const Position& column : move_columns)
+        {
+            for (int y = -1; y < 3; ++y)
+            {
+                check_candidate(pos + column + Position(0, y, 0));
+            }
+        }
+
+        if (!(grid.GetState(pos + Position(0, -1, 0)) & BlockPathfindingState::Climbable))
+        {
+            return;
+        }
+
+        // Falls can't go through solid blocks in the landing column
+        for (int y = pos.y + 1; y < world_max_y && !grid.IsSolid(Position(pos.x, y, pos.z)); ++y)
+        {
+            if (y < pos.y + 3)
+            {
+                continue;
+            }
+            for (size_t i = 0; i < num_fall_columns; ++i)
+            {
+                check_candidate(Position(pos.x, y, pos.z) + move_columns[i]);
+            }
+        }
+    }
+
+    PathfindingReplanner::Key PathfindingReplanner::CalculateKey(const Node& node) const
+    {
+        const float min_g = std::min(node.g, node.rhs);
+        return Key{ min_g + Heuristic(last_start, node.pos) + key_modifier, min_g };
+    }
+
+    void PathfindingReplanner::UpdateVertex(const uint32_t index)
+    {
+        if (nodes[index].pos != goal)
+        {
+            float rhs = infinity;
+            for (const auto& [pos, cost] : GetSuccessors(index))
+            {
+                rhs = std::min(rhs, cost + GetG(pos));
+            }
+            nodes[index].rhs = rhs;
+        }
+
+        if (nodes[index].heap_index != invalid_index)
+        {
+            HeapRemove(index);
+        }
+        if (nodes[index].g != nodes[index].rhs)
+        {
+            nodes[index].key = CalculateKey(nodes[index]);
+            HeapInsert(index);
+        }
+    }
+
+    bool PathfindingReplanner::ComputeShortestPath(const uint32_t start_index, const int budget_visit, const std::atomic<bool>* cancelled)
+    {
+        std::vector<uint32_t> predecessors;
+        while (!heap.empty() &&
+            (nodes[heap[0]].key < CalculateKey(nodes[start_index]) || nodes[start_index].rhs != nodes[start_index].g))
+        {
+            if (num_last_visits >= budget_visit || (cancelled != nullptr && cancelled->load(std::memory_order_relaxed)))
+            {
+                return false;
+            }
+            num_last_visits++;
+
+            const uint32_t index = heap[0];
+            // Copy, adding predecessors may move the nodes in memory
+            const Position pos = nodes[index].pos;
+            const Key old_key = nodes[index].key;
+            const Key new_key = CalculateKey(nodes[index]);
+            if (old_key < new_key)
+            {
+                // Key computed with a previous start, put it back at the right place
+                nodes[index].key = new_key;
+                SiftDown(0);
+            }
+            else if (nodes[index].g > nodes[index].rhs)
+            {
+                // Path to the goal improved
+                nodes[index].g = nodes[index].rhs;
+                HeapRemove(index);
+                GetPredecessors(pos, predecessors);
+                for (const uint32_t p : predecessors)
+                {
+                    UpdateVertex(p);
+                }
+            }
+            else
+            {
+                // Path to the goal got worse, everything depending on it has to be updated
+                nodes[index].g = infinity;
+                GetPredecessors(pos, predecessors);
+                for (const uint32_t p : predecessors)
+                {
+                    UpdateVertex(p);
+                }
+                UpdateVertex(index);
+            }
+        }
+        return true;
+    }
+
+    void PathfindingReplanner::ApplyWorldChanges()
+    {
+        changed_blocks.clear();
+        grid.Update(changed_blocks);
+        if (changed_blocks.empty())
+        {
+            return;
+        }
+
+        // Find all the positions that read a changed block when computing their successors.
+        // Unknown ones are added too, as a changed block can open a move between two
+        // positions the search never reached, or from a new one to an already expanded node
+        std::vector<uint32_t> affected;
+        const auto add_affected = [&](const Position& pos)
+        {
+            uint32_t index = FindNode(pos);
+            if (index == invalid_index)
+            {
+                if (!grid.IsStandable(pos))
+                {
+                    return;
+                }
+                index = AddNode(pos);
+            }
+            affected.push_back(index);
+        };
+        for (const Position& block : changed_blocks)
+        {
+            for (const Position& column : move_columns)
+            {
+                for (int y = -2; y < 4; ++y)
+                {
+                    add_affected(block + column + Position(0, y, 0));
+                }
+            }
+            // Long falls passing through this block
+            for (int y = block.y + 1; y < world_max_y && !grid.IsSolid(Position(block.x, y, block.z)); ++y)
+            {
+                if (y < block.y + 4)
+                {
+                    continue;
+                }
+                for (size_t i = 0; i < num_fall_columns; ++i)
+                {
+                    add_affected(Position(block.x, y, block.z) + move_columns[i]);
+                }
+            }
+        }
+        std::sort(affected.begin(), affected.end());
+        affected.erase(std::unique(affected.begin(), affected.end()), affected.end());
+
+        for (const uint32_t index : affected)
+        {
+            nodes[index].successors_valid = false;
+        }
+        for (const uint32_t index : affected)
+        {
+            UpdateVertex(index);
+        }
+    }
+
+    void PathfindingReplanner::HeapInsert(const uint32_t index)
+    {
+        nodes[index].heap_index = static_cast<uint32_t>(heap.size());
+        heap.push_back(index);
+        SiftUp(nodes[index].heap_index);
+    }
+
+    void PathfindingReplanner::HeapRemove(const uint32_t index)
+    {
+        const uint32_t heap_pos = nodes[index].heap_index;
+        nodes[index].heap_index = invalid_index;
+
+        const uint32_t last = heap.back();
+        heap.pop_back();
+        if (heap_pos < heap.size())
+        {
+            heap[heap_pos] = last;
+            nodes[last].heap_index = heap_pos;
+            SiftUp(heap_pos);
+            SiftDown(nodes[last].heap_index);
+        }
+    }
+
+    void PathfindingReplanner::SiftUp(uint32_t heap_pos)
+    {
+        const uint32_t index = heap[heap_pos];
+        const Key key = nodes[index].key;
+        while (heap_pos > 0)
+        {
+            const uint32_t parent_pos = (heap_pos - 1) / 2;
+            const uint32_t parent_index = heap[parent_pos];
+            if (!(key < nodes[parent_index].key))
+            {
+                break;
+            }
+            heap[heap_pos] = parent_index;
+            nodes[parent_index].heap_index = heap_pos;
+            heap_pos = parent_pos;
+        }
+        heap[heap_pos] = index;
+        nodes[index].heap_index = heap_pos;
+    }
+
+    void PathfindingReplanner::SiftDown(uint32_t heap_pos)
+    {
+        const uint32_t index = heap[heap_pos];
+        const Key key = nodes[index].key;
+        const uint32_t heap_size = static_cast<uint32_t>(heap.size());
+        while (true)
+        {
+            uint32_t child_pos = 2 * heap_pos + 1;
+            if (child_pos >= heap_size)
+            {
+                break;
+            }
+            if (child_pos + 1 < heap_size && nodes[heap[child_pos + 1]].key < nodes[heap[child_pos]].key)
+            {
+                child_pos += 1;
+            }
+            const uint32_t child_index = heap[child_pos];
+            if (!(nodes[child_index].key < key))
+            {
+                break;
+            }
+            heap[heap_pos] = child_index;
+            nodes[child_index].heap_index = heap_pos;
+            heap_pos = child_pos;
+        }
+        heap[heap_pos] = index;
+        nodes[index].heap_index = heap_pos;
+    }
+} // Botcraft
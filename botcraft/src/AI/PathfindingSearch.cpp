@@ -0,0 +1,188 @@
+#include <algorithm>
+
+#include "botcraft/AI/PathfindingSearch.hpp"
+
+namespace Botcraft
+{
+    PathfindingSearch::PathfindingSearch() : slots(min_num_slots)
+    {
+
+    }
+
+    void PathfindingSearch::Clear()
+    {
+        if (slots.GetNumSlots() > min_num_slots && node_keys.size() * 8 < slots.GetNumSlots())
+        {
+            // Table grown by a previous big search, don't keep it for small ones
+            size_t num_slots = min_num_slots;
+            while (num_slots < node_keys.size() * 2)
+            {
+                num_slots *= 2;
+            }
+            slots.Rebuild(num_slots, 0, [this](const size_t i) { return node_keys[i]; });
+        }
+        else
+        {
+            // Only reset the used slots. The probe sequence of a node only goes through
+            // slots of nodes added before it, so removing them in reverse order always finds them
+            for (size_t i = node_keys.size(); i-- > 0; )
+            {
+                slots.ResetSlot(FindSlot(node_keys[i]));
+            }
+        }
+
+        nodes.clear();
+        node_keys.clear();
+        heap.clear();
+    }
+
+    bool PathfindingSearch::Push(const Position& pos, const float cost, const float heuristic, const uint32_t parent)
+    {
+        const uint64_t key = PackPosition(pos);
+        size_t slot = FindSlot(key);
+        if (!slots.IsEmpty(slot))
+        {
+            Node& node = nodes[slots.GetIndex(slot)];
+            if (cost >= node.cost)
+            {
+                return false;
+            }
+            node.cost = cost;
+            node.score = cost + heuristic;
+            node.parent = parent;
+            // Already explored nodes go back in the open set if a better path is found
+            if (node.heap_index == invalid_index)
+            {
+                node.heap_index = static_cast<uint32_t>(heap.size());
+                heap.push_back(slots.GetIndex(slot));
+            }
+            SiftUp(node.heap_index);
+            return true;
+        }
+
+        if (slots.ReserveOneMore(node_keys.size(), [this](const size_t i) { return node_keys[i]; }))
+        {
+            slot = FindSlot(key);
+        }
+
+        const uint32_t node_index = static_cast<uint32_t>(nodes.size());
+        nodes.push_back(Node{ pos, cost, cost + heuristic, parent, static_cast<uint32_t>(heap.size()) });
+        node_keys.push_back(key);
+        slots.SetIndex(slot, node_index);
+        heap.push_back(node_index);
+        SiftUp(nodes[node_index].heap_index);
+        return true;
+    }
+
+    bool PathfindingSearch::IsOpenEmpty() const
+    {
+        return heap.empty();
+    }
+
+    uint32_t PathfindingSearch::PopBest()
+    {
+        const uint32_t best = heap[0];
+        nodes[best].heap_index = invalid_index;
+
+        const uint32_t last = heap.back();
+        heap.pop_back();
+        if (!heap.empty())
+        {
+            heap[0] = last;
+            nodes[last].heap_index = 0;
+            SiftDown(0);
+        }
+        return best;
+    }
+
+    const PathfindingSearch::Node& PathfindingSearch::GetNode(const uint32_t index) const
+    {
+        return nodes[index];
+    }
+
+    size_t PathfindingSearch::GetNumNodes() const
+    {
+        return nodes.size();
+    }
+
+    uint32_t PathfindingSearch::FindNode(const Position& pos) const
+    {
+        const size_t slot = FindSlot(PackPosition(pos));
+        return slots.IsEmpty(slot) ? invalid_index : slots.GetIndex(slot);
+    }
+
+    std::vector<Position> PathfindingSearch::GetPath(const uint32_t index) const
+    {
+        std::vector<Position> path;
+        path.push_back(nodes[index].pos);
+        uint32_t current = index;
+        while (nodes[current].parent != invalid_index && nodes[nodes[current].parent].parent != invalid_index)
+        {
+            current = nodes[current].parent;
+            path.push_back(nodes[current].pos);
+        }
+        std::reverse(path.begin(), path.end());
+        return path;
+    }
+
+    uint64_t PathfindingSearch::PackPosition(const Position& pos)
+    {
+        return (static_cast<uint64_t>(pos.x & 0x3FFFFFF) << 38) |
+            (static_cast<uint64_t>(pos.z & 0x3FFFFFF) << 12) |
+            static_cast<uint64_t>(pos.y & 0xFFF);
+    }
+
+    size_t PathfindingSearch::FindSlot(const uint64_t packed_pos) const
+    {
+        return slots.FindSlot(packed_pos, [this](const size_t i) { return node_keys[i]; });
+    }
+
+    void PathfindingSearch::SiftUp(uint32_t heap_pos)
+    {
+        const uint32_t index = heap[heap_pos];
+        const float score = nodes[index].score;
+        while (heap_pos > 0)
+        {
+            const uint32_t parent_pos = (heap_pos - 1) / 2;
+            const uint32_t parent_index = heap[parent_pos];
+            if (nodes[parent_index].score <= score)
+            {
+                break;
+            }
+            heap[heap_pos] = parent_index;
+            nodes[parent_index].heap_index = heap_pos;
+            heap_pos = parent_pos;
+        }
+        heap[heap_pos] = index;
+        nodes[index].heap_index = heap_pos;
+    }
+
+    void PathfindingSearch::SiftDown(uint32_t heap_pos)
+    {
+        const uint32_t index = heap[heap_pos];
+        const float score = nodes[index].score;
+        const uint32_t heap_size = static_cast<uint32_t>(heap.size());
+        while (true)
+        {
+            uint32_t child_pos = 2 * heap_pos + 1;
+            if (child_pos >= heap_size)
+            {
+                break;
+            }
+            if (child_pos + 1 < heap_size && nodes[heap[child_pos + 1]].score < nodes[heap[child_pos]].score)
+            {
+                child_pos += 1;
+            }
+            const uint32_t child_index = heap[child_pos];
+            if (nodes[child_index].score >= score)
+            {
+                break;
+            }
+            heap[heap_pos] = child_index;
+            nodes[child_index].heap_index = heap_pos;
+            heap_pos = child_pos;
+        }
+        heap[heap_pos] = index;
+        nodes[index].heap_index = heap_pos;
+    }
+} // Botcraft
@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <string>
+
+#include "botcraft/AI/PathfindingService.hpp"
+
+#include "botcraft/Utilities/Logger.hpp"
+
+namespace Botcraft
+{
+    bool PathfindingService::Request::IsDone() const
+    {
+        return done.load(std::memory_order_acquire);
+    }
+
+    void PathfindingService::Request::Cancel()
+    {
+        cancelled.store(true, std::memory_order_relaxed);
+    }
+
+    bool PathfindingService::Request::IsCancelled() const
+    {
+        return cancelled.load(std::memory_order_relaxed);
+    }
+
+    const std::vector<Position>& PathfindingService::Request::GetPath() const
+    {
+        return path;
+    }
+
+
+    PathfindingService::PathfindingService(const unsigned int num_threads_) :
+        num_threads(num_threads_ != 0 ? num_threads_ : std::max(1u, std::thread::hardware_concurrency()))
+    {
+        running = true;
+    }
+
+    PathfindingService::~PathfindingService()
+    {
+        {
+            std::scoped_lock<std::mutex> lock(mutex);
+            running = false;
+            // Release anyone still waiting for a queued request
+            for (const auto& r : requests)
+            {
+                r->Cancel();
+                r->search = nullptr;
+                r->done.store(true, std::memory_order_release);
+            }
+            requests.clear();
+            // Stop the searches in progress
+            for (const auto& [owner, r] : last_requests)
+            {
+                r->Cancel();
+            }
+            last_requests.clear();
+        }
+        condition.notify_all();
+
+        for (auto& t : threads)
+        {
+            if (t.joinable())
+            {
+                t.join();
+            }
+        }
+    }
+
+    std::shared_ptr<PathfindingService::Request> PathfindingService::Submit(const void* owner, const Search& search)
+    {
+        std::shared_ptr<Request> request = std::make_shared<Request>();
+        request->owner = owner;
+        request->search = search;
+
+        {
+            std::scoped_lock<std::mutex> lock(mutex);
+            // The owner is not waiting for the previous result anymore
+            auto it = last_requests.find(owner);
+            if (it != last_requests.end())
+            {
+                it->second->Cancel();
+            }
+            last_requests[owner] = request;
+            requests.push_back(request);
+
+            if (threads.empty())
+            {
+                threads.reserve(num_threads);
+                for (unsigned int i = 0; i < num_threads; ++i)
+                {
+                    threads.emplace_back(&PathfindingService::Run, this, i);
+                }
+                LOG_INFO("Pathfinding service started with " << num_threads << " thread" << (num_threads > 1 ? "s" : ""));
+            }
+        }
+        condition.notify_one();
+
+        return request;
+    }
+
+    unsigned int PathfindingService::GetNumThreads() const
+    {
+        std::scoped_lock<std::mutex> lock(mutex);
+        return static_cast<unsigned int>(threads.size());
+    }
+
+    size_t PathfindingService::GetNumPendingRequests() const
+    {
+        std::scoped_lock<std::mutex> lock(mutex);
+        return requests.size();
+    }
+
+    void PathfindingService::Run(const unsigned int index)
+    {
+        Logger::GetInstance().RegisterThread("Pathfinding - " + std::to_string(index));
+
+        while (true)
+        {
+            std::shared_ptr<Request> request;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [this]() { return !running || !requests.empty(); });
+                if (!running)
+                {
+                    break;
+                }
+                request = requests.front();
+                requests.pop_front();
+            }
+
+            // Cancelled requests still in the queue are skipped
+            if (!request->IsCancelled())
+            {
+                try
+                {
+                    request->path = request->search(request->cancelled);
+                }
+                catch (const std::exception& e)
+                {
+                    LOG_ERROR("Error during path computation: " << e.what());
+                    request->path.clear();
+                }
+                if (request->IsCancelled())
+                {
+                    request->path.clear();
+                }
+            }
+            // Release everything captured by the search (world...) as soon as possible
+            request->search = nullptr;
+
+            {
+                std::scoped_lock<std::mutex> lock(mutex);
+                auto it = last_requests.find(request->owner);
+                if (it != last_requests.end() && it->second == request)
+                {
+                    last_requests.erase(it);
+                }
+            }
+            request->done.store(true, std::memory_order_release);
+        }
+
+        Logger::GetInstance().UnregisterThread(std::this_thread::get_id());
+    }
+} // Botcraft
@@ -1,6 +1,14 @@
+#include <array>
+#include <limits>
+
 #include "botcraft/AI/Tasks/PathfindingTask.hpp"
 #include "botcraft/AI/Blackboard.hpp"
 #include "botcraft/AI/BehaviourClient.hpp"
+#include "botcraft/AI/PathfindingGraph.hpp"
+#include "botcraft/AI/PathfindingGrid.hpp"
+#include "botcraft/AI/PathfindingReplanner.hpp"
+#include "botcraft/AI/PathfindingSearch.hpp"
+#include "botcraft/AI/PathfindingService.hpp"
 
 #include "botcraft/Game/Entities/LocalPlayer.hpp"
 #include "botcraft/Game/Entities/EntityManager.hpp"
@@ -15,87 +23,26 @@
 
 namespace Botcraft
 {
-    enum class BlockPathfindingState: char
-    {
-        Empty = 0,
-        /// @brief Can walk on, can't go through
-        Solid = 1 << 0,
-        /// @brief Take damage if walk through/on
-        Hazardous = 1 << 1,
-        /// @brief Can climb up/down
-        Climbable = 1 << 2,
-        /// @brief Can climb but can't walk on
-        Fluid = 1 << 3
-    };
-
-    BlockPathfindingState operator|(const BlockPathfindingState a, const BlockPathfindingState b)
-    {
-        return static_cast<BlockPathfindingState>(static_cast<char>(a) | static_cast<char>(b));
-    }
-
-    bool operator&(const BlockPathfindingState a, const BlockPathfindingState b)
+    std::vector<Position> FindPath(const BehaviourClient& client, const Position& start, const Position& end, const int dist_tolerance, const int min_end_dist, const int min_end_dist_xz, const bool allow_jump)
     {
-        return (static_cast<char>(a) & static_cast<char>(b)) > 0;
+        return FindPath(*client.GetWorld(), start, end, dist_tolerance, min_end_dist, min_end_dist_xz, allow_jump, !client.GetLocalPlayer()->GetInvulnerable());
     }
 
-    BlockPathfindingState GetBlockGoThroughState(const Blockstate* block, const bool take_damage)
+    std::vector<Position> FindPath(const World& world, const Position& start, const Position& end, const int dist_tolerance, const int min_end_dist, const int min_end_dist_xz, const bool allow_jump, const bool take_damage, const int budget_visit, const std::atomic<bool>* cancelled)
     {
-        if (block == nullptr)
-        {
-            return BlockPathfindingState::Empty;
-        }
-
-        if (take_damage && block->IsHazardous())
+        const auto heuristic = [&end](const Position& pos) -> float
         {
-            return BlockPathfindingState::Hazardous;
-        }
-
-        if (block->IsFluidOrWaterlogged() && !block->IsSolid())
-        {
-            return BlockPathfindingState::Climbable | BlockPathfindingState::Fluid;
-        }
-
-        if (block->IsClimbable())
-        {
-            return BlockPathfindingState::Climbable;
-        }
-
-        return block->IsSolid() ? BlockPathfindingState::Solid : BlockPathfindingState::Empty;
-    }
-
-    std::vector<Position> FindPath(const BehaviourClient& client, const Position& start, const Position& end, const int dist_tolerance, const int min_end_dist, const int min_end_dist_xz, const bool allow_jump)
-    {
-        struct PathNode
-        {
-            Position pos;
-            float score; // distance from start + heuristic to goal
-            PathNode(const Position& p, const float s)
-            {
-                pos = p;
-                score = s;
-            }
-
-            bool operator>(const PathNode& rhs) const
-            {
-                return score > rhs.score;
-            }
-
-            static const float Heuristic(const Position& a, const Position& b)
-            {
-                return static_cast<float>(std::abs(a.x - b.x) + std::abs(a.y - b.y) + std::abs(a.z - b.z));
-            }
+            return static_cast<float>(std::abs(pos.x - end.x) + std::abs(pos.y - end.y) + std::abs(pos.z - end.z));
         };
 
-        constexpr int budget_visit = 15000;
-
-        const std::vector<Position> neighbour_offsets({ Position(1, 0, 0), Position(-1, 0, 0), Position(0, 0, 1), Position(0, 0, -1) });
-        std::priority_queue<PathNode, std::vector<PathNode>, std::greater<PathNode> > nodes_to_explore;
-        std::unordered_map<Position, Position> came_from;
-        std::unordered_map<Position, float> cost;
+        // Nodes memory is kept between two searches in the same thread
+        thread_local PathfindingSearch search;
+        search.Clear();
+        search.Push(start, 0.0f, heuristic(start), PathfindingSearch::invalid_index);
 
-        nodes_to_explore.emplace(PathNode(start, 0.0f));
-        came_from[start] = start;
-        cost[start] = 0.0f;
+        uint32_t current_index = PathfindingSearch::invalid_index;
+        Position current_pos;
+        float current_cost = 0.0f;
 
         int count_visit = 0;
         // We found one location matching all the criterion, but
@@ -104,23 +51,30 @@ namespace Botcraft
         // We found a path to the desired goal
         bool end_reached = false;
 
-        bool end_is_inside_solid = false;
-        std::shared_ptr<World> world = client.GetWorld();
-        const Blockstate* block = world->GetBlock(end);
-        end_is_inside_solid = block != nullptr && block->IsSolid();
-        const bool takes_damage = !client.GetLocalPlayer()->GetInvulnerable();
+        // Blocks are read from the world one section at a time, then looked up locally
+        PathfindingGrid grid(world, take_damage);
 
-        while (!nodes_to_explore.empty())
+        const bool end_is_inside_solid = grid.IsSolid(end);
+        // Reachable positions from the current node, and the cost to go there
+        std::vector<std::pair<Position, float>> neighbours;
+
+        while (!search.IsOpenEmpty())
         {
+            if (cancelled != nullptr && cancelled->load(std::memory_order_relaxed))
+            {
+                return {};
+            }
+
             count_visit++;
-            PathNode current_node = nodes_to_explore.top();
-            nodes_to_explore.pop();
+            current_index = search.PopBest();
+            current_pos = search.GetNode(current_index).pos;
+            current_cost = search.GetNode(current_index).cost;
 
-            end_reached |= current_node.pos == end;
+            end_reached |= current_pos == end;
             suitable_location_found |=
-                std::abs(end.x - current_node.pos.x) + std::abs(end.y - current_node.pos.y) + std::abs(end.z - current_node.pos.z) <= dist_tolerance &&
-                std::abs(end.x - current_node.pos.x) + std::abs(end.y - current_node.pos.y) + std::abs(end.z - current_node.pos.z) >= min_end_dist &&
-                std::abs(end.x - current_node.pos.x) + std::abs(end.z - current_node.pos.z) >= min_end_dist_xz;
+                std::abs(end.x - current_pos.x) + std::abs(end.y - current_pos.y) + std::abs(end.z - current_pos.z) <= dist_tolerance &&
+                std::abs(end.x - current_pos.x) + std::abs(end.y - current_pos.y) + std::abs(end.z - current_pos.z) >= min_end_dist &&
+                std::abs(end.x - current_pos.x) + std::abs(end.z - current_pos.z) >= min_end_dist_xz;
 
             if (// If we exceeded the search budget
                 count_visit > budget_visit ||
@@ -130,594 +84,15 @@ namespace Botcraft
                 break;
             }
 
-            // Get the state around the player in the given location
-            std::array<BlockPathfindingState, 6> vertical_surroundings = {
-                BlockPathfindingState::Solid, BlockPathfindingState::Solid, BlockPathfindingState::Solid,
-                BlockPathfindingState::Solid, BlockPathfindingState::Solid, BlockPathfindingState::Solid
-            };
-
-            // Assuming the player is standing on 3 (feeet on 2 and head on 1)
-            // 0
-            // 1
-            // 2
-            // 3
-            // 4
-            // 5
-            const Blockstate* block = world->GetBlock(current_node.pos + Position(0, 2, 0));
-            vertical_surroundings[0] = GetBlockGoThroughState(block, takes_damage);
-            block = world->GetBlock(current_node.pos + Position(0, 1, 0));
-            vertical_surroundings[1] = GetBlockGoThroughState(block, takes_damage);
-            // Our feet block (should be climbable or empty)
-            block = world->GetBlock(current_node.pos);
-            vertical_surroundings[2] = GetBlockGoThroughState(block, takes_damage);
-
-            // if 3 is solid or hazardous, no down pathfinding is possible,
-            // so we can skip a few checks
-            block = world->GetBlock(current_node.pos + Position(0, -1, 0));
-            vertical_surroundings[3] = GetBlockGoThroughState(block, takes_damage);
-
-            // If we can move down, we need 4 and 5
-            if (vertical_surroundings[3] != BlockPathfindingState::Solid && vertical_surroundings[3] != BlockPathfindingState::Hazardous)
-            {
-                block = world->GetBlock(current_node.pos + Position(0, -2, 0));
-                vertical_surroundings[4] = GetBlockGoThroughState(block, takes_damage);
-                block = world->GetBlock(current_node.pos + Position(0, -3, 0));
-                vertical_surroundings[5] = GetBlockGoThroughState(block, takes_damage);
-            }
-
-
-            // Check all vertical cases that would allow the bot to pass
-            // -
-            // x
-            // ^
-            // ?
-            // ?
-            // ?
-            if (vertical_surroundings[2] & BlockPathfindingState::Climbable
-                && vertical_surroundings[1] != BlockPathfindingState::Solid
-                && vertical_surroundings[1] != BlockPathfindingState::Hazardous
-                && vertical_surroundings[0] != BlockPathfindingState::Solid
-                && vertical_surroundings[0] != BlockPathfindingState::Hazardous
-                )
-            {
-                const float new_cost = cost[current_node.pos] + 1.0f;
-                const Position new_pos = current_node.pos + Position(0, 1, 0);
-                auto it = cost.find(new_pos);
-                // If we don't already know this node with a better path, add it
-                if (it == cost.end() ||
-                    new_cost < it->second)
-                {
-                    cost[new_pos] = new_cost;
-                    nodes_to_explore.emplace(PathNode(new_pos, new_cost + PathNode::Heuristic(new_pos, end)));
-                    came_from[new_pos] = current_node.pos;
-                }
-            }
-
-            // -
-            // ^
-            //  
-            // o
-            // ?
-            // ?
-            if (vertical_surroundings[3] == BlockPathfindingState::Solid
-                && vertical_surroundings[2] == BlockPathfindingState::Empty
-                && vertical_surroundings[1] & BlockPathfindingState::Climbable
-                && vertical_surroundings[0] != BlockPathfindingState::Solid
-                && vertical_surroundings[0] != BlockPathfindingState::Hazardous
-                )
-            {
-                const float new_cost = cost[current_node.pos] + 1.5f;
-                const Position new_pos = current_node.pos + Position(0, 1, 0);
-                auto it = cost.find(new_pos);
-                // If we don't already know this node with a better path, add it
-                if (it == cost.end() ||
-                    new_cost < it->second)
-                {
-                    cost[new_pos] = new_cost;
-                    nodes_to_explore.emplace(PathNode(new_pos, new_cost + PathNode::Heuristic(new_pos, end)));
-                    came_from[new_pos] = current_node.pos;
-                }
-            }
-
-            // ?
-            // x
-            // x
-            // -
-            // ?
-            // ?
-            if (vertical_surroundings[3] & BlockPathfindingState::Climbable)
+            neighbours.clear();
+            grid.GetNeighbours(current_pos, allow_jump, neighbours);
+            for (const auto& [next_pos, move_cost] : neighbours)
             {
-                const float new_cost = cost[current_node.pos] + 1.0f;
-                const Position new_pos = current_node.pos + Position(0, -1, 0);
-                auto it = cost.find(new_pos);
-                // If we don't already know this node with a better path, add it
-                if (it == cost.end() ||
-                    new_cost < it->second)
-                {
-                    cost[new_pos] = new_cost;
-                    nodes_to_explore.emplace(PathNode(new_pos, new_cost + PathNode::Heuristic(new_pos, end)));
-                    came_from[new_pos] = current_node.pos;
-                }
-            }
-
-            // ?
-            // x
-            // x
-            // -
-            //  
-            // o
-            if (vertical_surroundings[3] & BlockPathfindingState::Climbable
-                && vertical_surroundings[4] == BlockPathfindingState::Empty
-                && vertical_surroundings[5] != BlockPathfindingState::Empty
-                && vertical_surroundings[5] != BlockPathfindingState::Hazardous
-                )
-            {
-                const float new_cost = cost[current_node.pos] + 2.0f;
-                const Position new_pos = current_node.pos + Position(0, -2, 0);
-                auto it = cost.find(new_pos);
-                // If we don't already know this node with a better path, add it
-                if (it == cost.end() ||
-                    new_cost < it->second)
-                {
-                    cost[new_pos] = new_cost;
-                    nodes_to_explore.emplace(PathNode(new_pos, new_cost + PathNode::Heuristic(new_pos, end)));
-                    came_from[new_pos] = current_node.pos;
-                }
+                search.Push(next_pos, current_cost + move_cost, heuristic(next_pos), current_index);
             }
-
-
-
-            // ?
-            // x
-            // ^
-            //  
-            //  
-            // o
-            if (vertical_surroundings[2] & BlockPathfindingState::Climbable
-                && vertical_surroundings[3] == BlockPathfindingState::Empty
-                && vertical_surroundings[4] == BlockPathfindingState::Empty
-                && vertical_surroundings[5] != BlockPathfindingState::Empty
-                && vertical_surroundings[5] != BlockPathfindingState::Hazardous
-                )
-            {
-                const float new_cost = cost[current_node.pos] + 2.0f;
-                const Position new_pos = current_node.pos + Position(0, -2, 0);
-                auto it = cost.find(new_pos);
-                // If we don't already know this node with a better path, add it
-                if (it == cost.end() ||
-                    new_cost < it->second)
-                {
-                    cost[new_pos] = new_cost;
-                    nodes_to_explore.emplace(PathNode(new_pos, new_cost + PathNode::Heuristic(new_pos, end)));
-                    came_from[new_pos] = current_node.pos;
-                }
-            }
-
-
-            // ?
-            // x
-            // x
-            // -
-            //  
-            //  
-            // Special case here, we can drop down
-            // if there is a climbable at the bottom
-            if (vertical_surroundings[3] & BlockPathfindingState::Climbable
-                && vertical_surroundings[4] == BlockPathfindingState::Empty
-                && vertical_surroundings[5] == BlockPathfindingState::Empty
-                )
-            {
-                for (int y = -4; current_node.pos.y + y >= world->GetMinY(); --y)
-                {
-                    block = world->GetBlock(current_node.pos + Position(0, y, 0));
-
-                    if (block != nullptr && block->IsSolid())
-                    {
-                        break;
-                    }
-
-                    if (GetBlockGoThroughState(block, takes_damage) & BlockPathfindingState::Climbable)
-                    {
-                        const float new_cost = cost[current_node.pos] + std::abs(y);
-                        const Position new_pos = current_node.pos + Position(0, y + 1, 0);
-                        auto it = cost.find(new_pos);
-                        // If we don't already know this node with a better path, add it
-                        if (it == cost.end() ||
-                            new_cost < it->second)
-                        {
-                            cost[new_pos] = new_cost;
-                            nodes_to_explore.emplace(PathNode(new_pos, new_cost + PathNode::Heuristic(new_pos, end)));
-                            came_from[new_pos] = current_node.pos;
-                        }
-
-                        break;
-                    }
-                }
-            }
-
-
-            // For each neighbour, check if it's reachable
-            // and add it to the search list if it is
-            for (int i = 0; i < neighbour_offsets.size(); ++i)
-            {
-                const Position next_location = current_node.pos + neighbour_offsets[i];
-                const Position next_next_location = next_location + neighbour_offsets[i];
-
-                // Get the state around the player in the given direction
-                std::array<BlockPathfindingState, 12> horizontal_surroundings = {
-                    BlockPathfindingState::Solid, BlockPathfindingState::Solid, BlockPathfindingState::Solid,
-                    BlockPathfindingState::Solid, BlockPathfindingState::Solid, BlockPathfindingState::Solid,
-                    BlockPathfindingState::Solid, BlockPathfindingState::Solid, BlockPathfindingState::Solid,
-                    BlockPathfindingState::Solid, BlockPathfindingState::Solid, BlockPathfindingState::Solid
-                };
-
-                // Assuming the player is standing on v3 (feeet on v2 and head on v1)
-                // v0   0   6 --> ?  ?  ?
-                // v1   1   7 --> x  ?  ?
-                // v2   2   8 --> x  ?  ?
-                // v3   3   9 --> ?  ?  ?
-                // v4   4  10 --> ?  ?  ?
-                // v5   5  11 --> ?  ?  ?
-
-                // if 1 is solid, no horizontal pathfinding is possible,
-                // so we can skip a lot of checks
-                block = world->GetBlock(next_location + Position(0, 1, 0));
-                horizontal_surroundings[1] = GetBlockGoThroughState(block, takes_damage);
-                const bool horizontal_movement = horizontal_surroundings[1] != BlockPathfindingState::Solid && horizontal_surroundings[1] != BlockPathfindingState::Hazardous;
-
-                // If we can move horizontally, we need the full column
-                if (horizontal_movement)
-                {
-                    block = world->GetBlock(next_location + Position(0, 2, 0));
-                    horizontal_surroundings[0] = GetBlockGoThroughState(block, takes_damage);
-                    block = world->GetBlock(next_location);
-                    horizontal_surroundings[2] = GetBlockGoThroughState(block, takes_damage);
-                    block = world->GetBlock(next_location + Position(0, -1, 0));
-                    horizontal_surroundings[3] = GetBlockGoThroughState(block, takes_damage);
-                    block = world->GetBlock(next_location + Position(0, -2, 0));
-                    horizontal_surroundings[4] = GetBlockGoThroughState(block, takes_damage);
-                    block = world->GetBlock(next_location + Position(0, -3, 0));
-                    horizontal_surroundings[5] = GetBlockGoThroughState(block, takes_damage);
-                }
-
-                // You can't make large jumps if your feet are in a climbable block
-                // If we can jump, then we need the third column
-                if (allow_jump && !(vertical_surroundings[2] & BlockPathfindingState::Climbable))
-                {
-                    block = world->GetBlock(next_next_location + Position(0, 2, 0));
-                    horizontal_surroundings[6] = GetBlockGoThroughState(block, takes_damage);
-                    block = world->GetBlock(next_next_location + Position(0, 1, 0));
-                    horizontal_surroundings[7] = GetBlockGoThroughState(block, takes_damage);
-                    block = world->GetBlock(next_next_location);
-                    horizontal_surroundings[8] = GetBlockGoThroughState(block, takes_damage);
-                    block = world->GetBlock(next_next_location + Position(0, -1, 0));
-                    horizontal_surroundings[9] = GetBlockGoThroughState(block, takes_damage);
-                    block = world->GetBlock(next_next_location + Position(0, -2, 0));
-                    horizontal_surroundings[10] = GetBlockGoThroughState(block, takes_damage);
-                    block = world->GetBlock(next_next_location + Position(0, -3, 0));
-                    horizontal_surroundings[11] = GetBlockGoThroughState(block, takes_damage);
-                }
-
-                // Now that we know the surroundings, we can check all
-                // horizontal cases that would allow the bot to pass
-
-                /************ HORIZONTAL **************/
-
-                // ?  ?  ?
-                // x  -  ?
-                // x  -  ?
-                //--- o  ?
-                //    ?  ?
-                //    ?  ?
-                if (horizontal_surroundings[1] != BlockPathfindingState::Solid
-                    && horizontal_surroundings[1] != BlockPathfindingState::Hazardous
-                    && horizontal_surroundings[2] != BlockPathfindingState::Solid
-                    && horizontal_surroundings[2] != BlockPathfindingState::Hazardous
-                    && horizontal_surroundings[3] != BlockPathfindingState::Empty
-                    && horizontal_surroundings[3] != BlockPathfindingState::Hazardous
-                    && (!(horizontal_surroundings[3] & BlockPathfindingState::Fluid)  // We can't go from above a fluid to above
-                        || !(vertical_surroundings[3] & BlockPathfindingState::Fluid) // another one to avoid "walking on water"
-                        || horizontal_surroundings[2] & BlockPathfindingState::Fluid  // except if one or both "leg level" blocks
-                        || vertical_surroundings[2] & BlockPathfindingState::Fluid)   // are also fluids
-                    )
-                {
-                    const float new_cost = cost[current_node.pos] + 1.0f;
-                    auto it = cost.find(next_location);
-                    // If we don't already know this node with a better path, add it
-                    if (it == cost.end() ||
-                        new_cost < it->second)
-                    {
-                        cost[next_location] = new_cost;
-                        nodes_to_explore.emplace(PathNode(next_location, new_cost + PathNode::Heuristic(next_location, end)));
-                        came_from[next_location] = current_node.pos;
-                    }
-                }
-
-
-                // -  -  ?
-                // x  ^  ?
-                // x  ?  ?
-                //--- ?  ?
-                //    ?  ?
-                //    ?  ?
-                if (vertical_surroundings[0] != BlockPathfindingState::Solid
-                    && vertical_surroundings[0] != BlockPathfindingState::Hazardous
-                    && vertical_surroundings[1] == BlockPathfindingState::Empty
-                    && vertical_surroundings[2] == BlockPathfindingState::Empty
-                    && vertical_surroundings[3] == BlockPathfindingState::Solid
-                    && horizontal_surroundings[0] != BlockPathfindingState::Solid
-                    && horizontal_surroundings[0] != BlockPathfindingState::Hazardous
-                    && horizontal_surroundings[1] & BlockPathfindingState::Climbable
-                    )
-                {
-                    const float new_cost = cost[current_node.pos] + 2.5f;
-                    const Position new_pos = next_location + Position(0, 1, 0);
-                    auto it = cost.find(new_pos);
-                    // If we don't already know this node with a better path, add it
-                    if (it == cost.end() ||
-                        new_cost < it->second)
-                    {
-                        cost[new_pos] = new_cost;
-                        nodes_to_explore.emplace(PathNode(new_pos, new_cost + PathNode::Heuristic(new_pos, end)));
-                        came_from[new_pos] = current_node.pos;
-                    }
-                }
-
-                // -  -  ?
-                // x  -  ?
-                // x  o  ?
-                //--- ?  ?
-                //    ?  ?
-                //    ?  ?
-                if (vertical_surroundings[0] != BlockPathfindingState::Solid
-                    && vertical_surroundings[0] != BlockPathfindingState::Hazardous
-                    && vertical_surroundings[1] == BlockPathfindingState::Empty
-                    && vertical_surroundings[2] == BlockPathfindingState::Empty
-                    && vertical_surroundings[3] == BlockPathfindingState::Solid
-                    && horizontal_surroundings[0] != BlockPathfindingState::Solid
-                    && horizontal_surroundings[0] != BlockPathfindingState::Hazardous
-                    && horizontal_surroundings[1] != BlockPathfindingState::Solid
-                    && horizontal_surroundings[1] != BlockPathfindingState::Hazardous
-                    && horizontal_surroundings[2] != BlockPathfindingState::Empty
-                    && horizontal_surroundings[2] != BlockPathfindingState::Hazardous
-                    )
-                {
-                    const float new_cost = cost[current_node.pos] + 2.5f;
-                    const Position new_pos = next_location + Position(0, 1, 0);
-                    auto it = cost.find(new_pos);
-                    // If we don't already know this node with a better path, add it
-                    if (it == cost.end() ||
-                        new_cost < it->second)
-                    {
-                        cost[new_pos] = new_cost;
-                        nodes_to_explore.emplace(PathNode(new_pos, new_cost + PathNode::Heuristic(new_pos, end)));
-                        came_from[new_pos] = current_node.pos;
-                    }
-                }
-
-                // ?  ?  ?
-                // x  -  ?
-                // x     ?
-                //---    ?
-                //    o  ?
-                //    ?  ?
-                if (horizontal_surroundings[1] != BlockPathfindingState::Solid
-                    && horizontal_surroundings[1] != BlockPathfindingState::Hazardous
-                    && horizontal_surroundings[2] == BlockPathfindingState::Empty
-                    && horizontal_surroundings[3] == BlockPathfindingState::Empty
-                    && horizontal_surroundings[4] != BlockPathfindingState::Empty
-                    && horizontal_surroundings[4] != BlockPathfindingState::Hazardous
-                    )
-                {
-                    const float new_cost = cost[current_node.pos] + 2.5f;
-                    const Position new_pos = next_location + Position(0, -1, 0);
-                    auto it = cost.find(new_pos);
-                    // If we don't already know this node with a better path, add it
-                    if (it == cost.end() ||
-                        new_cost < it->second)
-                    {
-                        cost[new_pos] = new_cost;
-                        nodes_to_explore.emplace(PathNode(new_pos, new_cost + PathNode::Heuristic(new_pos, end)));
-                        came_from[new_pos] = current_node.pos;
-                    }
-                }
-
-                // ?  ?  ?
-                // x  -  ?
-                // x     ?
-                //---    ?
-                //       ?
-                //    o  ?
-                if (horizontal_surroundings[1] != BlockPathfindingState::Solid
-                    && horizontal_surroundings[1] != BlockPathfindingState::Hazardous
-                    && horizontal_surroundings[2] == BlockPathfindingState::Empty
-                    && horizontal_surroundings[3] == BlockPathfindingState::Empty
-                    && horizontal_surroundings[4] == BlockPathfindingState::Empty
-                    && horizontal_surroundings[5] != BlockPathfindingState::Empty
-                    && horizontal_surroundings[5] != BlockPathfindingState::Hazardous
-                    )
-                {
-                    const float new_cost = cost[current_node.pos] + 3.5f;
-                    const Position new_pos = next_location + Position(0, -2, 0);
-                    auto it = cost.find(new_pos);
-                    // If we don't already know this node with a better path, add it
-                    if (it == cost.end() ||
-                        new_cost < it->second)
-                    {
-                        cost[new_pos] = new_cost;
-                        nodes_to_explore.emplace(PathNode(new_pos, new_cost + PathNode::Heuristic(new_pos, end)));
-                        came_from[new_pos] = current_node.pos;
-                    }
-                }
-
-                // ?  ?  ?
-                // x  -  ?
-                // x     ?
-                //---    ?
-                //       ?
-                //       ?
-                // Special case here, we can drop down
-                // if there is a climbable at the bottom
-                if (horizontal_surroundings[1] != BlockPathfindingState::Solid
-                    && horizontal_surroundings[1] != BlockPathfindingState::Hazardous
-                    && horizontal_surroundings[2] == BlockPathfindingState::Empty
-                    && horizontal_surroundings[3] == BlockPathfindingState::Empty
-                    && horizontal_surroundings[4] == BlockPathfindingState::Empty
-                    && horizontal_surroundings[5] == BlockPathfindingState::Empty
-                    )
-                {
-                    for (int y = -4; next_location.y + y >= world->GetMinY(); --y)
-                    {
-                        block = world->GetBlock(next_location + Position(0, y, 0));
-
-                        if (block != nullptr && block->IsSolid())
-                        {
-                            break;
-                        }
-
-                        if (GetBlockGoThroughState(block, takes_damage) & BlockPathfindingState::Climbable)
-                        {
-                            const float new_cost = cost[current_node.pos] + std::abs(y) + 1.5f;
-                            const Position new_pos = next_location + Position(0, y + 1, 0);
-                            auto it = cost.find(new_pos);
-                            // If we don't already know this node with a better path, add it
-                            if (it == cost.end() ||
-                                new_cost < it->second)
-                            {
-                                cost[new_pos] = new_cost;
-                                nodes_to_explore.emplace(PathNode(new_pos, new_cost + PathNode::Heuristic(new_pos, end)));
-                                came_from[new_pos] = current_node.pos;
-                            }
-
-                            break;
-                        }
-                    }
-                }
-
-                // If we can't make jumps, don't bother explore the rest
-                // of the cases
-                if (!allow_jump
-                    || vertical_surroundings[0] == BlockPathfindingState::Solid       // Block above
-                    || vertical_surroundings[0] == BlockPathfindingState::Hazardous   // Block above
-                    || vertical_surroundings[1] != BlockPathfindingState::Empty       // Block above
-                    || vertical_surroundings[2] != BlockPathfindingState::Empty       // Feet inside climbable
-                    || vertical_surroundings[3] & BlockPathfindingState::Fluid        // "Walking" on fluid
-                    || vertical_surroundings[3] == BlockPathfindingState::Empty       // Feet on nothing (inside climbable)
-                    || horizontal_surroundings[0] == BlockPathfindingState::Solid     // Block above next column
-                    || horizontal_surroundings[0] == BlockPathfindingState::Hazardous // Hazard above next column
-                    || horizontal_surroundings[1] != BlockPathfindingState::Empty     // Non empty block in next column, can't jump through it
-                    || horizontal_surroundings[2] != BlockPathfindingState::Empty     // Non empty block in next column, can't jump through it
-                    || horizontal_surroundings[6] == BlockPathfindingState::Solid     // Block above nextnext column
-                    || horizontal_surroundings[6] == BlockPathfindingState::Hazardous // Hazard above nextnext column
-                    || horizontal_surroundings[7] != BlockPathfindingState::Empty     // Non empty block in nextnext column, can't jump through it
-                    )
-                {
-                    continue;
-                }
-
-                /************ BIG JUMP **************/
-                // -  -  -
-                // x      
-                // x     o
-                //--- ?  ?
-                //    ?  ?
-                //    ?  ?
-                if (horizontal_surroundings[8] != BlockPathfindingState::Empty
-                    && horizontal_surroundings[8] != BlockPathfindingState::Hazardous
-                    )
-                {
-                    // 4 > 3.5 as if horizontal_surroundings[3] is solid we prefer to walk then jump instead of big jump
-                    // but if horizontal_surroundings[3] is hazardous we can jump over it
-                    const float new_cost = cost[current_node.pos] + 4.0f;
-                    const Position new_pos = next_next_location + Position(0, 1, 0);
-                    auto it = cost.find(new_pos);
-                    // If we don't already know this node with a better path, add it
-                    if (it == cost.end() ||
-                        new_cost < it->second)
-                    {
-                        cost[new_pos] = new_cost;
-                        nodes_to_explore.emplace(PathNode(new_pos, new_cost + PathNode::Heuristic(new_pos, end)));
-                        came_from[new_pos] = current_node.pos;
-                    }
-                }
-
-                // -  -  -
-                // x      
-                // x      
-                //--- ?  o
-                //    ?  ?
-                //    ?  ?
-                if (horizontal_surroundings[8] == BlockPathfindingState::Empty
-                    && horizontal_surroundings[9] != BlockPathfindingState::Empty
-                    && horizontal_surroundings[9] != BlockPathfindingState::Hazardous
-                    )
-                {
-                    const float new_cost = cost[current_node.pos] + 2.5f;
-                    auto it = cost.find(next_next_location);
-                    // If we don't already know this node with a better path, add it
-                    if (it == cost.end() ||
-                        new_cost < it->second)
-                    {
-                        cost[next_next_location] = new_cost;
-                        nodes_to_explore.emplace(PathNode(next_next_location, new_cost + PathNode::Heuristic(next_next_location, end)));
-                        came_from[next_next_location] = current_node.pos;
-                    }
-                }
-
-                // -  -  -
-                // x      
-                // x      
-                //--- ?   
-                //    ?  o
-                //    ?  ?
-                if (horizontal_surroundings[8] == BlockPathfindingState::Empty
-                    && horizontal_surroundings[9] == BlockPathfindingState::Empty
-                    && horizontal_surroundings[10] != BlockPathfindingState::Empty
-                    && horizontal_surroundings[10] != BlockPathfindingState::Hazardous
-                    )
-                {
-                    const float new_cost = cost[current_node.pos] + 4.5f;
-                    const Position new_pos = next_next_location + Position(0, -1, 0);
-                    auto it = cost.find(new_pos);
-                    // If we don't already know this node with a better path, add it
-                    if (it == cost.end() ||
-                        new_cost < it->second)
-                    {
-                        cost[new_pos] = new_cost;
-                        nodes_to_explore.emplace(PathNode(new_pos, new_cost + PathNode::Heuristic(new_pos, end)));
-                        came_from[new_pos] = current_node.pos;
-                    }
-                }
-
-                // -  -  -
-                // x      
-                // x      
-                //--- ?   
-                //    ?   
-                //    ?  o
-                if (horizontal_surroundings[8] == BlockPathfindingState::Empty
-                    && horizontal_surroundings[9] == BlockPathfindingState::Empty
-                    && horizontal_surroundings[10] == BlockPathfindingState::Empty
-                    && horizontal_surroundings[11] != BlockPathfindingState::Empty
-                    && horizontal_surroundings[11] != BlockPathfindingState::Hazardous
-                    )
-                {
-                    const float new_cost = cost[current_node.pos] + 5.5f;
-                    const Position new_pos = next_next_location + Position(0, -2, 0);
-                    auto it = cost.find(new_pos);
-                    // If we don't already know this node with a better path, add it
-                    if (it == cost.end() ||
-                        new_cost < it->second)
-                    {
-                        cost[new_pos] = new_cost;
-                        nodes_to_explore.emplace(PathNode(new_pos, new_cost + PathNode::Heuristic(new_pos, end)));
-                        came_from[new_pos] = current_node.pos;
-                    }
-                }
-            } // neighbour loop
         }
 
-        auto it_end_path = came_from.begin();
+        uint32_t end_path_index = 0;
 
         // We search for the node respecting
         // the criteria AND the closest to
@@ -726,12 +101,12 @@ namespace Botcraft
         // take the one the closest to the end
         int best_dist = std::numeric_limits<int>::max();
         int best_dist_start = std::numeric_limits<int>::max();
-        for (auto it = came_from.begin(); it != came_from.end(); ++it)
+        for (uint32_t i = 0; i < search.GetNumNodes(); ++i)
         {
-            const Position diff = it->first - end;
+            const Position diff = search.GetNode(i).pos - end;
             const int d_xz = std::abs(diff.x) + std::abs(diff.z);
             const int d = d_xz + std::abs(diff.y);
-            const Position diff_start = it->first - start;
+            const Position diff_start = search.GetNode(i).pos - start;
             const int d_start = std::abs(diff_start.x) + std::abs(diff_start.y) + std::abs(diff_start.z);
             if (d <= dist_tolerance && d >= min_end_dist && d_xz >= min_end_dist_xz &&
                 (d_start < best_dist_start || (d_start == best_dist_start && d < best_dist))
@@ -739,7 +114,7 @@ namespace Botcraft
             {
                 best_dist = d;
                 best_dist_start = d_start;
-                it_end_path = it;
+                end_path_index = i;
             }
         }
 
@@ -748,31 +123,52 @@ namespace Botcraft
         // Take closest node to the goal in this case
         if (best_dist == std::numeric_limits<int>::max())
         {
-            for (auto it = came_from.begin(); it != came_from.end(); ++it)
+            for (uint32_t i = 0; i < search.GetNumNodes(); ++i)
             {
-                const Position diff = it->first - end;
+                const Position diff = search.GetNode(i).pos - end;
                 const int d_xz = std::abs(diff.x) + std::abs(diff.z);
                 const int d = d_xz + std::abs(diff.y);
-                const Position diff_start = it->first - start;
+                const Position diff_start = search.GetNode(i).pos - start;
                 const int d_start = std::abs(diff_start.x) + std::abs(diff_start.y) + std::abs(diff_start.z);
                 if (d < best_dist || (d == best_dist && d_start < best_dist_start))
                 {
                     best_dist = d;
                     best_dist_start = d_start;
-                    it_end_path = it;
+                    end_path_index = i;
                 }
             }
         }
 
-        std::deque<Position> output_deque;
-        output_deque.push_front(it_end_path->first);
-        while (it_end_path->second != start)
+        return search.GetPath(end_path_index);
+    }
+
+    /// @brief Min distance to the goal to plan the path on the sections graph first
+    static constexpr int hierarchical_min_dist = 8 * CHUNK_WIDTH;
+
+    /// @brief Run a search on the client pathfinding service, yielding until it's done
+    /// @param client The client waiting for the path
+    /// @param search The search to run
+    /// @return The computed path
+    std::vector<Position> ComputePath(BehaviourClient& client, const PathfindingService::Search& search)
+    {
+        // Keep the service alive even if it's replaced while we are waiting
+        const std::shared_ptr<PathfindingService> service = client.GetPathfindingService();
+        // Any unfinished search from a previous (interrupted) GoTo is replaced by this one
+        const std::shared_ptr<PathfindingService::Request> request = service->Submit(&client, search);
+        try
+        {
+            while (!request->IsDone())
+            {
+                client.Yield();
+            }
+        }
+        catch (...)
         {
-            it_end_path = came_from.find(it_end_path->second);
-            output_deque.push_front(it_end_path->first);
+            // Behaviour interrupted, the result won't be used
+            request->Cancel();
+            throw;
         }
-        
-        return std::vector<Position>(output_deque.begin(), output_deque.end());
+        return request->GetPath();
     }
 
     // a75f87e0-0583-435b-847a-cf0c18ede2d1
@@ -1127,6 +523,9 @@ namespace Botcraft
 
         std::shared_ptr<World> world = client.GetWorld();
         Position current_position;
+        // Search state kept between two failed steps, to repair the path instead of computing it from scratch
+        std::shared_ptr<PathfindingReplanner> replanner;
+        bool step_failed = false;
         do
         {
             // Wait until we are on the ground or climbing
@@ -1148,32 +547,63 @@ namespace Botcraft
                 static_cast<int>(std::floor(local_player->GetPosition().z))
             );
 
-            std::vector<Position> path;
             const bool is_goal_loaded = world->IsLoaded(goal);
 
             const int current_diff_xz = std::abs(goal.x - current_position.x) + std::abs(goal.z - current_position.z);
             const int current_diff = current_diff_xz + std::abs(goal.y - current_position.y);
-            // Path finding step
+            if (is_goal_loaded && dist_tolerance && current_diff <= dist_tolerance && current_diff >= min_end_dist && current_diff_xz >= min_end_dist_xz)
+            {
+                AdjustPosSpeed(client);
+                return Status::Success;
+            }
             if (!is_goal_loaded)
             {
                 LOG_INFO('[' << client.GetNetworkManager()->GetMyName() << "] Current goal position " << goal << " is either air or not loaded, trying to get closer to load the chunk");
-                Vector3<double> goal_direction(goal.x - current_position.x, goal.y - current_position.y, goal.z - current_position.z);
-                goal_direction.Normalize();
-                path = FindPath(client, current_position,
-                    current_position + Position(
-                        static_cast<int>(goal_direction.x * 32.0),
-                        static_cast<int>(goal_direction.y * 32.0),
-                        static_cast<int>(goal_direction.z * 32.0)
-                    ), dist_tolerance, min_end_dist, min_end_dist_xz, allow_jump);
             }
-            else
+
+            // Far goals are first planned on the sections graph, as a flat search would run out of budget before
+            // reaching them. If the goal is not loaded, this gets us as close as possible with the loaded chunks
+            const bool use_graph = current_diff > hierarchical_min_dist && (!dist_tolerance || current_diff > dist_tolerance);
+            const bool take_damage = !local_player->GetInvulnerable();
+            const std::shared_ptr<PathfindingGraph> graph = client.GetPathfindingGraph();
+
+            std::vector<Position> path;
+            // Path finding step, computed on the pathfinding threads so we can keep yielding
+            if (step_failed && replanner != nullptr)
             {
-                if (dist_tolerance && current_diff <= dist_tolerance && current_diff >= min_end_dist && current_diff_xz >= min_end_dist_xz)
-                {
-                    AdjustPosSpeed(client);
-                    return Status::Success;
-                }
-                path = FindPath(client, current_position, goal, dist_tolerance, min_end_dist, min_end_dist_xz, allow_jump);
+                // The replanner reads blocks from world, keep it alive
+                path = ComputePath(client, [replanner, world, current_position](const std::atomic<bool>& cancelled)
+                    {
+                        return replanner->FindPath(current_position, default_pathfinding_budget_visit, &cancelled);
+                    });
+            }
+            step_failed = false;
+            if (path.empty())
+            {
+                path = ComputePath(client, [=](const std::atomic<bool>& cancelled) -> std::vector<Position>
+                    {
+                        if (use_graph)
+                        {
+                            std::vector<Position> output = graph->FindPath(*world, current_position, goal, allow_jump, take_damage, 20000, &cancelled);
+                            // Follow the long path, FindPath takes over once we are in the goal section
+                            if (!output.empty())
+                            {
+                                return output;
+                            }
+                        }
+                        if (!is_goal_loaded)
+                        {
+                            Vector3<double> goal_direction(goal.x - current_position.x, goal.y - current_position.y, goal.z - current_position.z);
+                            goal_direction.Normalize();
+                            return FindPath(*world, current_position,
+                                current_position + Position(
+                                    static_cast<int>(goal_direction.x * 32.0),
+                                    static_cast<int>(goal_direction.y * 32.0),
+                                    static_cast<int>(goal_direction.z * 32.0)
+                                ), dist_tolerance, min_end_dist, min_end_dist_xz, allow_jump, take_damage, default_pathfinding_budget_visit, &cancelled);
+                        }
+                        return FindPath(*world, current_position, goal, dist_tolerance, min_end_dist, min_end_dist_xz, allow_jump, take_damage, default_pathfinding_budget_visit, &cancelled);
+                    });
             }
 
             if (path.size() == 0 || path.back() == current_position)
@@ -1218,13 +648,15 @@ namespace Botcraft
                 if ((next_target == nullptr || (!next_target->IsClimbable() && !next_target->IsFluid())) &&
                     (below == nullptr || below->IsAir()))
                 {
+                    step_failed = true;
                     break;
                 }
 
                 // If something went wrong, break and
-                // replan the whole path to the goal
+                // repair the path to the goal
                 if (!Move(client, local_player, path[i], speed_factor, sprint))
                 {
+                    step_failed = true;
                     break;
                 }
                 // Otherwise just update current position for
@@ -1240,6 +672,20 @@ namespace Botcraft
                     );
                 }
             }
+
+            if (step_failed)
+            {
+                // Long paths are planned on the sections graph again
+                if (std::abs(path.back().x - current_position.x) + std::abs(path.back().y - current_position.y) + std::abs(path.back().z - current_position.z) > hierarchical_min_dist)
+                {
+                    replanner = nullptr;
+                }
+                // Keep the same end position, only the part of the path affected by the changes will be computed again
+                else if (replanner == nullptr || replanner->GetGoal() != path.back())
+                {
+                    replanner = std::make_shared<PathfindingReplanner>(*world, path.back(), allow_jump, !local_player->GetInvulnerable());
+                }
+            }
         } while (current_position != goal);
 
         AdjustPosSpeed(client);
@@ -9,6 +9,7 @@ namespace Botcraft
     ConnectionClient::ConnectionClient()
     {
         network_manager = nullptr;
+        network_thread_pool = nullptr;
         should_be_closed = false;
     }
 
@@ -19,8 +20,8 @@ namespace Botcraft
 
     void ConnectionClient::Connect(const std::string& address, const std::string& login, const bool force_microsoft_account)
     {
-        network_manager = std::make_shared<NetworkManager>(address, login, force_microsoft_account);
-        network_manager->AddHandler(this);
+        network_manager = std::make_shared<NetworkManager>(address, login, force_microsoft_account, network_thread_pool);
+        network_manager->AddHandler(this, GetPacketFilter());
     }
 
     void ConnectionClient::Disconnect()
@@ -33,6 +34,16 @@ namespace Botcraft
         network_manager.reset();
     }
 
+    PacketFilter ConnectionClient::GetPacketFilter() const
+    {
+        return PacketFilter::All();
+    }
+
+    void ConnectionClient::SetSharedNetworkThreadPool(const std::shared_ptr<NetworkThreadPool> pool)
+    {
+        network_thread_pool = pool;
+    }
+
     bool ConnectionClient::GetShouldBeClosed() const
     {
         return should_be_closed;
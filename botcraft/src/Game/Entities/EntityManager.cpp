@@ -12,6 +12,11 @@ namespace Botcraft
         local_player = nullptr;
     }
 
+    PacketFilter EntityManager::GetPacketFilter() const
+    {
+        return HANDLED_PACKETS_FILTER(EntityManager);
+    }
+
     std::shared_ptr<LocalPlayer> EntityManager::GetLocalPlayer()
     {
         return local_player;
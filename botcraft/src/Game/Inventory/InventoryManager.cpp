@@ -15,6 +15,11 @@ namespace Botcraft
         inventories[Window::PLAYER_INVENTORY_INDEX] = std::make_shared<Window>(InventoryType::PlayerInventory);
     }
 
+    PacketFilter InventoryManager::GetPacketFilter() const
+    {
+        return HANDLED_PACKETS_FILTER(InventoryManager);
+    }
+
 
     void InventoryManager::SetSlot(const short window_id, const short index, const Slot& slot)
     {
@@ -495,11 +500,6 @@ namespace Botcraft
     }
 #endif
 
-    void InventoryManager::Handle(Message& msg)
-    {
-
-    }
-
     void InventoryManager::Handle(ClientboundContainerSetSlotPacket& msg)
     {
         if (msg.GetContainerId() == -1 && msg.GetSlot() == -1)
@@ -183,14 +183,14 @@ namespace Botcraft
         inventory_manager = std::make_shared<InventoryManager>();
         entity_manager = std::make_shared<EntityManager>();
         // Subscribe them to the network manager
-        network_manager->AddHandler(world.get());
-        network_manager->AddHandler(inventory_manager.get());
-        network_manager->AddHandler(entity_manager.get());
+        network_manager->AddHandler(world.get(), world->GetPacketFilter());
+        network_manager->AddHandler(inventory_manager.get(), inventory_manager->GetPacketFilter());
+        network_manager->AddHandler(entity_manager.get(), entity_manager->GetPacketFilter());
 #if USE_GUI
         if (use_renderer)
         {
             rendering_manager = std::make_shared<Renderer::RenderingManager>(world, inventory_manager, entity_manager, 800, 600, CHUNK_WIDTH, false);
-            network_manager->AddHandler(rendering_manager.get());
+            network_manager->AddHandler(rendering_manager.get(), rendering_manager->GetPacketFilter());
         }
         physics_manager = std::make_shared<PhysicsManager>(rendering_manager, inventory_manager, entity_manager, network_manager, world);
 #else
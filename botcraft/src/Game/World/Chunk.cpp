@@ -1,3 +1,5 @@
+#include <atomic>
+
 #include "botcraft/Game/AssetsManager.hpp"
 #include "botcraft/Game/World/Chunk.hpp"
 #include "botcraft/Game/World/Section.hpp"
@@ -7,6 +9,12 @@ using namespace ProtocolCraft;
 
 namespace Botcraft
 {
+    namespace
+    {
+        /// @brief Shared by all chunks, so a revision identifies a single version of a single section
+        std::atomic<unsigned long long int> next_section_revision = 1;
+    }
+
     enum class Palette
     {
 #if PROTOCOL_VERSION > 756 /* > 1.17.1 */
@@ -36,6 +44,9 @@ namespace Botcraft
         biomes = std::vector<unsigned char>(64 * height / SECTION_HEIGHT, 0);
 #endif
         sections = std::vector<std::shared_ptr<Section> >(height / SECTION_HEIGHT);
+        // Revisions of a new chunk must not match the ones of a previous chunk at the same position
+        section_revisions = std::vector<unsigned long long int>(height / SECTION_HEIGHT, next_section_revision++);
+        content_hash = 0;
 
 #if USE_GUI
         modified_since_last_rendered = true;
@@ -53,21 +64,26 @@ namespace Botcraft
         min_y = c.min_y;
 #endif
 
-        sections = std::vector<std::shared_ptr<Section> >(height / SECTION_HEIGHT);
-        for (int i = 0; i < c.sections.size(); i++)
-        {
-            if (c.sections[i] == nullptr)
-            {
-                sections[i] = nullptr;
-            }
-            else
-            {
-                sections[i] = std::make_shared<Section>(*c.sections[i]);
-            }
-        }
+        // Sections are shared between copies, and only cloned when modified
+        sections = c.sections;
+        section_revisions = c.section_revisions;
 
         block_entities_data = c.block_entities_data;
         loaded_from = c.loaded_from;
+        content_hash = c.content_hash;
+        content_data = c.content_data;
+#if USE_GUI
+        modified_since_last_rendered = c.modified_since_last_rendered;
+#endif
+    }
+
+    Chunk& Chunk::operator=(const Chunk& c)
+    {
+        if (this != &c)
+        {
+            *this = Chunk(c);
+        }
+        return *this;
     }
 
     Position Chunk::BlockCoordsToChunkCoords(const Position& pos)
@@ -110,6 +126,7 @@ namespace Botcraft
     void Chunk::LoadChunkData(const std::vector<unsigned char>& data, const std::vector<unsigned long long int>& primary_bit_mask)
 #endif
     {
+        content_hash = 0;
         std::vector<unsigned char>::const_iterator iter = data.begin();
         size_t length = data.size();
 
@@ -170,9 +187,6 @@ namespace Botcraft
                 }
             }
 
-            //A mask 0...01..1 with bits_per_block ones
-            unsigned int individual_value_mask = static_cast<unsigned int>((1 << bits_per_block) - 1);
-
             //Data array length
             int data_array_size = ReadData<VarInt>(iter, length);
 
@@ -183,10 +197,24 @@ namespace Botcraft
                 data_array[i] = ReadData<unsigned long long int>(iter, length);
             }
 
-            //Blocks data
 #if PROTOCOL_VERSION > 712 /* > 1.15.2 */
-            int bit_offset = 0;
-#endif
+            // From protocol version 713, the compacted array format has been adjusted so that
+            // individual entries no longer span across multiple longs
+            if (!sections[sectionY])
+            {
+                AddSection(sectionY);
+            }
+            UpdateSectionRevision(sectionY);
+            if (!GetWritableSection(sectionY)->LoadPackedData(bits_per_block, palette, data_array))
+            {
+                LOG_ERROR("Invalid blocks data for section " << sectionY << ". Stop loading current chunk data");
+                return;
+            }
+#else
+            //A mask 0...01..1 with bits_per_block ones
+            unsigned int individual_value_mask = static_cast<unsigned int>((1 << bits_per_block) - 1);
+
+            //Blocks data
             Position pos;
             for (int block_y = 0; block_y < SECTION_HEIGHT; ++block_y)
             {
@@ -197,23 +225,10 @@ namespace Botcraft
                     for (int block_x = 0; block_x < CHUNK_WIDTH; ++block_x)
                     {
                         pos.x = block_x;
-#if PROTOCOL_VERSION > 712 /* > 1.15.2 */
-                        // From protocol version 713, the compacted array format has been adjusted so that
-                        //individual entries no longer span across multiple longs
-                        if (64 - (bit_offset % 64) < bits_per_block)
-                        {
-                            bit_offset += 64 - (bit_offset % 64);
-                        }
-                        int start_long_index = bit_offset / 64;
-                        int end_long_index = start_long_index;
-                        int start_offset = bit_offset % 64;
-                        bit_offset += bits_per_block;
-#else
                         int block_index = (((block_y * SECTION_HEIGHT) + block_z) * CHUNK_WIDTH) + block_x;
                         int start_long_index = (block_index * bits_per_block) / 64;
                         int start_offset = (block_index * bits_per_block) % 64;
                         int end_long_index = ((block_index + 1) * bits_per_block - 1) / 64;
-#endif
                         unsigned int raw_id;
                         if (start_long_index == end_long_index)
                         {
@@ -244,6 +259,7 @@ namespace Botcraft
                     }
                 }
             }
+#endif
 
 #if PROTOCOL_VERSION <= 404 /* <= 1.13.2 */
             //Block light
@@ -313,6 +329,7 @@ namespace Botcraft
 #else
     void Chunk::LoadChunkData(const std::vector<unsigned char>& data)
     {
+        content_hash = 0;
         std::vector<unsigned char>::const_iterator iter = data.begin();
         size_t length = data.size();
 
@@ -359,9 +376,6 @@ namespace Botcraft
                 break;
             }
 
-            //A mask 0...01..1 with bits_per_block ones
-            unsigned int individual_value_mask = static_cast<unsigned int>((1 << bits_per_block) - 1);
-
             //Data array length
             int data_array_size = ReadData<VarInt>(iter, length);
 
@@ -373,60 +387,27 @@ namespace Botcraft
             }
 
             //Blocks data
-            int bit_offset = 0;
-            Position pos;
             if (block_count != 0)
             {
-                for (int block_y = 0; block_y < SECTION_HEIGHT; ++block_y)
+                if (palette_type == Palette::SingleValue)
                 {
-                    pos.y = block_y + sectionY * SECTION_HEIGHT + min_y;
-                    for (int block_z = 0; block_z < CHUNK_WIDTH; ++block_z)
-                    {
-                        pos.z = block_z;
-                        for (int block_x = 0; block_x < CHUNK_WIDTH; ++block_x)
-                        {
-                            pos.x = block_x;
-                            if (palette_type == Palette::SingleValue)
-                            {
-                                SetBlock(pos, palette_value);
-                                continue;
-                            }
-
-                            // Entries don't span across multiple longs
-                            if (64 - (bit_offset % 64) < bits_per_block)
-                            {
-                                bit_offset += 64 - (bit_offset % 64);
-                            }
-                            int start_long_index = bit_offset / 64;
-                            int end_long_index = start_long_index;
-                            int start_offset = bit_offset % 64;
-                            bit_offset += bits_per_block;
-
-                            unsigned int raw_id;
-                            if (start_long_index == end_long_index)
-                            {
-                                raw_id = static_cast<unsigned int>(data_array[start_long_index] >> start_offset);
-                            }
-                            else
-                            {
-                                int end_offset = 64 - start_offset;
-                                raw_id = static_cast<unsigned int>(data_array[start_long_index] >> start_offset | data_array[end_long_index] << end_offset);
-                            }
-                            raw_id &= individual_value_mask;
-
-                            if (palette_type == Palette::SectionPalette)
-                            {
-                                raw_id = palette[raw_id];
-                            }
-
-                            SetBlock(pos, raw_id);
-                        }
-                    }
+                    palette = { palette_value };
+                }
+                if (!sections[sectionY])
+                {
+                    AddSection(sectionY);
+                }
+                UpdateSectionRevision(sectionY);
+                if (!GetWritableSection(sectionY)->LoadPackedData(bits_per_block, palette, data_array))
+                {
+                    LOG_ERROR("Invalid blocks data for section " << sectionY << ". Stop loading current chunk data");
+                    return;
                 }
             }
             else
             {
                 sections[sectionY] = nullptr;
+                UpdateSectionRevision(sectionY);
             }
 
             LoadSectionBiomeData(sectionY, iter, length);
@@ -443,6 +424,7 @@ namespace Botcraft
     void Chunk::LoadChunkBlockEntitiesData(const std::vector<BlockEntityInfo>& block_entities)
 #endif
     {
+        content_hash = 0;
         // Block entities data
         block_entities_data.clear();
 
@@ -482,6 +464,7 @@ namespace Botcraft
         }
 
         block_entities_data[pos] = block_entity;
+        content_hash = 0;
 
 #if USE_GUI
         modified_since_last_rendered = true;
@@ -490,6 +473,7 @@ namespace Botcraft
 
     void Chunk::RemoveBlockEntityData(const Position& pos)
     {
+        content_hash = 0;
         block_entities_data.erase(pos);
     }
 
@@ -519,10 +503,10 @@ namespace Botcraft
 
 #if PROTOCOL_VERSION < 347 /* < 1.13 */
         BlockstateId block_id;
-        const unsigned short stored_id = *(sections[section_y]->data_blocks.data() + Section::CoordsToBlockIndex(pos.x, (pos.y - min_y) % SECTION_HEIGHT, pos.z));
+        const unsigned short stored_id = sections[section_y]->GetBlock(Section::CoordsToBlockIndex(pos.x, (pos.y - min_y) % SECTION_HEIGHT, pos.z));
         Blockstate::IdToIdMetadata(static_cast<unsigned int>(stored_id), block_id.first, block_id.second);
 #else
-        const BlockstateId block_id = static_cast<BlockstateId>(*(sections[section_y]->data_blocks.data() + Section::CoordsToBlockIndex(pos.x, (pos.y - min_y) % SECTION_HEIGHT, pos.z)));
+        const BlockstateId block_id = static_cast<BlockstateId>(sections[section_y]->GetBlock(Section::CoordsToBlockIndex(pos.x, (pos.y - min_y) % SECTION_HEIGHT, pos.z)));
 #endif
         return AssetsManager::getInstance().GetBlockstate(block_id);
     }
@@ -572,7 +556,9 @@ namespace Botcraft
 #else
         const unsigned short block_id = static_cast<unsigned short>(id);
 #endif
-        sections[section_y]->data_blocks[Section::CoordsToBlockIndex(pos.x, (pos.y - min_y) % SECTION_HEIGHT, pos.z)] = block_id;
+        GetWritableSection(section_y)->SetBlock(Section::CoordsToBlockIndex(pos.x, (pos.y - min_y) % SECTION_HEIGHT, pos.z), block_id);
+        UpdateSectionRevision(section_y);
+        content_hash = 0;
 
 #if USE_GUI
         modified_since_last_rendered = true;
@@ -592,7 +578,7 @@ namespace Botcraft
             return 0;
         }
 
-        return (sections[section_y]->block_light[Section::CoordsToLightIndex(pos.x, (pos.y - min_y) % SECTION_HEIGHT, pos.z)] >> (4 * (pos.x % 2))) & 0x0F;
+        return sections[section_y]->GetBlockLight(pos.x, (pos.y - min_y) % SECTION_HEIGHT, pos.z);
     }
 
     void Chunk::SetBlockLight(const Position& pos, const unsigned char v)
@@ -608,17 +594,8 @@ namespace Botcraft
             AddSection(section_y);
         }
 
-        unsigned char* packed_value = sections[section_y]->block_light.data() + Section::CoordsToLightIndex(pos.x, (pos.y - min_y) % SECTION_HEIGHT, pos.z);
-        if (pos.x % 2 == 1)
-        {
-            const unsigned char first_value = *packed_value & 0x0F;
-            *packed_value = first_value | ((v & 0x0F) << 4);
-        }
-        else
-        {
-            const unsigned char second_value = *packed_value & 0xF0;
-            *packed_value = second_value | (v & 0x0F);
-        }
+        GetWritableSection(section_y)->SetBlockLight(pos.x, (pos.y - min_y) % SECTION_HEIGHT, pos.z, v);
+        content_hash = 0;
         // Not necessary as we don't render lights
 //#if USE_GUI
 //        modified_since_last_rendered = true;
@@ -638,7 +615,7 @@ namespace Botcraft
             return 0;
         }
 
-        return (sections[section_y]->sky_light[Section::CoordsToLightIndex(pos.x, (pos.y - min_y) % SECTION_HEIGHT, pos.z)] >> (4 * (pos.x % 2))) & 0x0F;
+        return sections[section_y]->GetSkyLight(pos.x, (pos.y - min_y) % SECTION_HEIGHT, pos.z);
     }
 
     void Chunk::SetSkyLight(const Position& pos, const unsigned char v)
@@ -654,22 +631,35 @@ namespace Botcraft
             AddSection(section_y);
         }
 
-        unsigned char* packed_value = sections[section_y]->sky_light.data() + Section::CoordsToLightIndex(pos.x, (pos.y - min_y) % SECTION_HEIGHT, pos.z);
-        if (pos.x % 2 == 1)
+        GetWritableSection(section_y)->SetSkyLight(pos.x, (pos.y - min_y) % SECTION_HEIGHT, pos.z, v);
+        content_hash = 0;
+        // Not necessary as we don't render lights
+//#if USE_GUI
+//        modified_since_last_rendered = true;
+//#endif
+    }
+
+    bool Chunk::SetSectionLight(const int section_y, std::vector<char>&& light, const bool sky)
+    {
+        if (section_y < 0 || section_y >= sections.size() ||
+            (!light.empty() && light.size() != CHUNK_WIDTH * CHUNK_WIDTH * SECTION_HEIGHT / 2))
         {
-            const unsigned char first_value = *packed_value & 0x0F;
-            *packed_value = first_value | ((v & 0x0F) << 4);
+            return false;
         }
-        else
+
+        if (sky && !has_sky_light)
         {
-            const unsigned char second_value = *packed_value & 0xF0;
-            *packed_value = second_value | (v & 0x0F);
+            return true;
         }
 
-        // Not necessary as we don't render lights
-//#if USE_GUI
-//        modified_since_last_rendered = true;
-//#endif
+        if (!sections[section_y])
+        {
+            AddSection(section_y);
+        }
+
+        GetWritableSection(section_y)->SetLightData(std::move(light), sky);
+        content_hash = 0;
+        return true;
     }
 
     size_t Chunk::GetDimensionIndex() const
@@ -682,6 +672,21 @@ namespace Botcraft
         return has_sky_light;
     }
 
+    size_t Chunk::GetMemoryUsage() const
+    {
+        size_t output = sizeof(Chunk) +
+            sections.capacity() * sizeof(std::shared_ptr<Section>) +
+            biomes.capacity();
+        for (const auto& s : sections)
+        {
+            if (s != nullptr)
+            {
+                output += s->GetMemoryUsage();
+            }
+        }
+        return output;
+    }
+
     bool Chunk::HasSection(const int y) const
     {
         return sections[y] != nullptr;
@@ -689,7 +694,13 @@ namespace Botcraft
 
     void Chunk::AddSection(const int y)
     {
-        sections[y] = std::make_unique<Section>(has_sky_light);
+        sections[y] = std::make_unique<Section>();
+        UpdateSectionRevision(y);
+    }
+
+    unsigned long long int Chunk::GetSectionRevision(const int y) const
+    {
+        return section_revisions[y];
     }
 
 #if PROTOCOL_VERSION < 552 /* < 1.15 */
@@ -711,6 +722,7 @@ namespace Botcraft
         }
 
         biomes[z * CHUNK_WIDTH + x] = static_cast<unsigned char>(b);
+        content_hash = 0;
 
 #if USE_GUI
         modified_since_last_rendered = true;
@@ -735,6 +747,7 @@ namespace Botcraft
 
     void Chunk::SetBiomes(const std::vector<int>& new_biomes)
     {
+        content_hash = 0;
         if (new_biomes.size() != 64 * height / SECTION_HEIGHT)
         {
             LOG_ERROR("Trying to set biomes with a wrong size");
@@ -765,6 +778,7 @@ namespace Botcraft
         }
 
         biomes[i] = static_cast<unsigned char>(new_biome);
+        content_hash = 0;
 
 #if USE_GUI
         modified_since_last_rendered = true;
@@ -775,6 +789,7 @@ namespace Botcraft
 #if PROTOCOL_VERSION > 761 /* > 1.19.3 */
     void Botcraft::Chunk::LoadBiomesData(const std::vector<unsigned char>& data)
     {
+        content_hash = 0;
         if (data.size() == 0)
         {
             LOG_WARNING("Cannot load chunk biomes data without data");
@@ -793,150 +808,72 @@ namespace Botcraft
     void Chunk::UpdateNeighbour(Chunk* const neighbour, const Orientation direction)
     {
 #if USE_GUI
-        Position this_dest_position = Position(0, 0, 0);
-        Position this_src_position = Position(0, 0, 0);
-        Position neighbour_dest_position = Position(0, 0, 0);
-        Position neighbour_src_position = Position(0, 0, 0);
+        Orientation opposite_direction;
         switch (direction)
         {
-            // The neighbour is on "the left" on the x axis
         case Orientation::West:
-            this_dest_position.x = -1;
-            this_src_position.x = 0;
-            neighbour_src_position.x = CHUNK_WIDTH - 1;
-            neighbour_dest_position.x = CHUNK_WIDTH;
-
-            for (int y = min_y; y < height + min_y; ++y)
-            {
-                this_dest_position.y = y;
-                this_src_position.y = y;
-                neighbour_src_position.y = y;
-                neighbour_dest_position.y = y;
-                for (int z = 0; z < CHUNK_WIDTH; ++z)
-                {
-                    this_dest_position.z = z;
-                    this_src_position.z = z;
-                    neighbour_src_position.z = z;
-                    neighbour_dest_position.z = z;
-                    // If the neighbour chunk is not loaded, just add air instead
-                    if (neighbour == nullptr)
-                    {
-                        SetBlock(this_dest_position, nullptr);
-                    }
-                    // Otherwise, get the blocks and set this chunk's blocks
-                    // on the neighbour
-                    else
-                    {
-                        SetBlock(this_dest_position, neighbour->GetBlock(neighbour_src_position));
-                        neighbour->SetBlock(neighbour_dest_position, GetBlock(this_src_position));
-                    }
-                }
-            }
+            opposite_direction = Orientation::East;
             break;
-            // The neighbour is on "the right" on the x axis
         case Orientation::East:
-            this_dest_position.x = CHUNK_WIDTH;
-            this_src_position.x = CHUNK_WIDTH - 1;
-            neighbour_src_position.x = 0;
-            neighbour_dest_position.x = -1;
+            opposite_direction = Orientation::West;
+            break;
+        case Orientation::North:
+            opposite_direction = Orientation::South;
+            break;
+        case Orientation::South:
+            opposite_direction = Orientation::North;
+            break;
+        default:
+            return;
+        }
 
-            for (int y = min_y; y < height + min_y; ++y)
+        // Borders are copied section by section, sections that don't
+        // exist on both sides are only air and can be skipped
+        for (int section_y = 0; section_y < sections.size(); ++section_y)
+        {
+            // If the neighbour chunk is not loaded, fill the border with the default
+            // block, so no face is added on the side of unloaded chunks
+            if (neighbour == nullptr)
             {
-                this_dest_position.y = y;
-                this_src_position.y = y;
-                neighbour_src_position.y = y;
-                neighbour_dest_position.y = y;
-                for (int z = 0; z < CHUNK_WIDTH; ++z)
+                if (sections[section_y])
                 {
-                    this_dest_position.z = z;
-                    this_src_position.z = z;
-                    neighbour_src_position.z = z;
-                    neighbour_dest_position.z = z;
-                    // If the neighbour chunk is not loaded, just add air instead
-                    if (neighbour == nullptr)
-                    {
-                        SetBlock(this_dest_position, nullptr);
-                    }
-                    // Otherwise, get the blocks and set this chunk's blocks
-                    // on the neighbour
-                    else
-                    {
-                        SetBlock(this_dest_position, neighbour->GetBlock(neighbour_src_position));
-                        neighbour->SetBlock(neighbour_dest_position, GetBlock(this_src_position));
-                    }
+#if PROTOCOL_VERSION < 347 /* < 1.13 */
+                    GetWritableSection(section_y)->FillBorder(direction, static_cast<unsigned short>(Blockstate::IdMetadataToId(-1, 0)));
+#else
+                    GetWritableSection(section_y)->FillBorder(direction, static_cast<unsigned short>(-1));
+#endif
+                    content_hash = 0;
+                    modified_since_last_rendered = true;
                 }
+                continue;
             }
-            break;
-            // The neighbour is on "the left" on the z axis
-        case Orientation::North:
-            this_dest_position.z = -1;
-            this_src_position.z = 0;
-            neighbour_src_position.z = CHUNK_WIDTH - 1;
-            neighbour_dest_position.z = CHUNK_WIDTH;
 
-            for (int y = min_y; y < height + min_y; ++y)
+            if (section_y >= neighbour->sections.size() ||
+                (!sections[section_y] && !neighbour->sections[section_y]))
             {
-                this_dest_position.y = y;
-                this_src_position.y = y;
-                neighbour_src_position.y = y;
-                neighbour_dest_position.y = y;
-                for (int x = 0; x < CHUNK_WIDTH; ++x)
-                {
-                    this_dest_position.x = x;
-                    this_src_position.x = x;
-                    neighbour_src_position.x = x;
-                    neighbour_dest_position.x = x;
-                    // If the neighbour chunk is not loaded, just add air instead
-                    if (neighbour == nullptr)
-                    {
-                        SetBlock(this_dest_position, nullptr);
-                    }
-                    // Otherwise, get the blocks and set this chunk's blocks
-                    // on the neighbour
-                    else
-                    {
-                        SetBlock(this_dest_position, neighbour->GetBlock(neighbour_src_position));
-                        neighbour->SetBlock(neighbour_dest_position, GetBlock(this_src_position));
-                    }
-                }
+                continue;
             }
-            break;
-            // The neighbour is on "the right" on the z axis
-        case Orientation::South:
-            this_dest_position.z = CHUNK_WIDTH;
-            this_src_position.z = CHUNK_WIDTH - 1;
-            neighbour_src_position.z = 0;
-            neighbour_dest_position.z = -1;
 
-            for (int y = min_y; y < height + min_y; ++y)
+            if (!sections[section_y])
             {
-                this_dest_position.y = y;
-                this_src_position.y = y;
-                neighbour_src_position.y = y;
-                neighbour_dest_position.y = y;
-                for (int x = 0; x < CHUNK_WIDTH; ++x)
-                {
-                    this_dest_position.x = x;
-                    this_src_position.x = x;
-                    neighbour_src_position.x = x;
-                    neighbour_dest_position.x = x;
-                    // If the neighbour chunk is not loaded, just add air instead
-                    if (neighbour == nullptr)
-                    {
-                        SetBlock(this_dest_position, nullptr);
-                    }
-                    // Otherwise, get the blocks and set this chunk's blocks
-                    // on the neighbour
-                    else
-                    {
-                        SetBlock(this_dest_position, neighbour->GetBlock(neighbour_src_position));
-                        neighbour->SetBlock(neighbour_dest_position, GetBlock(this_src_position));
-                    }
-                }
+                AddSection(section_y);
             }
-            break;
-        default:
-            break;
+            if (!neighbour->sections[section_y])
+            {
+                neighbour->AddSection(section_y);
+            }
+
+            // Get this chunk's blocks from the neighbour and set the neighbour's blocks from this chunk
+            GetWritableSection(section_y)->CopyBorder(neighbour->sections[section_y].get(), direction);
+            neighbour->GetWritableSection(section_y)->CopyBorder(sections[section_y].get(), opposite_direction);
+        }
+
+        if (neighbour != nullptr)
+        {
+            content_hash = 0;
+            modified_since_last_rendered = true;
+            neighbour->content_hash = 0;
+            neighbour->modified_since_last_rendered = true;
         }
 #endif
     }
@@ -952,6 +889,50 @@ namespace Botcraft
         return loaded_from.size();
     }
 
+    const std::unordered_set<std::thread::id>& Chunk::GetLoaders() const
+    {
+        return loaded_from;
+    }
+
+    size_t Chunk::GetContentHash() const
+    {
+        return content_hash;
+    }
+
+    void Chunk::SetContentHash(const size_t hash, const std::shared_ptr<const std::vector<unsigned char>>& content)
+    {
+        content_hash = hash;
+        content_data = content;
+    }
+
+    bool Chunk::IsLoadedFrom(const size_t hash, const std::vector<unsigned char>& content) const
+    {
+        // Hash is reset to 0 on modification, the data are compared in case of collision
+        return content_hash != 0 && content_hash == hash &&
+            content_data != nullptr && *content_data == content;
+    }
+
+    void Chunk::UpdateSectionRevision(const int section_y)
+    {
+        section_revisions[section_y] = next_section_revision++;
+    }
+
+    Section* Chunk::GetWritableSection(const int section_y)
+    {
+        std::shared_ptr<Section>& section = sections[section_y];
+        if (section.use_count() > 1)
+        {
+            // Shared with a copy of this chunk, clone it so the copy is not modified
+            section = std::make_shared<Section>(*section);
+        }
+        else
+        {
+            // Make sure all reads from a copy that just released this section are done before we write in it
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return section.get();
+    }
+
     bool Chunk::IsInsideChunk(const Position& pos, const bool ignore_gui_borders) const
     {
         if (ignore_gui_borders)
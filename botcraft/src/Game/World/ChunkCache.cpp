@@ -0,0 +1,591 @@
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "botcraft/Game/World/ChunkCache.hpp"
+#include "botcraft/Game/World/Section.hpp"
+#include "botcraft/Utilities/Logger.hpp"
+#include "botcraft/Utilities/MiscUtilities.hpp"
+
+namespace Botcraft
+{
+    namespace
+    {
+        /// @brief Number of chunks on each side of a region
+        constexpr int region_width = 32;
+        /// @brief Max number of region files opened at the same time
+        constexpr size_t max_open_regions = 32;
+
+        constexpr uint32_t region_magic = 0x42434331; // BCC1, also detects files with a different byte order
+        constexpr uint32_t region_format_version = 1;
+#if USE_GUI
+        constexpr uint32_t region_flags = 1;
+#else
+        constexpr uint32_t region_flags = 0;
+#endif
+
+        struct RegionHeader
+        {
+            uint32_t magic;
+            uint32_t format_version;
+            uint32_t protocol_version;
+            uint32_t flags;
+        };
+
+        struct RegionEntry
+        {
+            /// @brief Position of the chunk in the file, 0 if not stored
+            uint64_t offset;
+            /// @brief Hash of the network data the chunk was loaded from, 0 if unknown
+            uint64_t content_hash;
+            /// @brief Size of the chunk data
+            uint32_t size;
+            /// @brief Space available at offset, can be bigger than size when the chunk has been rewritten
+            uint32_t capacity;
+        };
+
+        constexpr size_t region_entries_offset = sizeof(RegionHeader);
+        constexpr size_t region_header_size = sizeof(RegionHeader) + region_width * region_width * sizeof(RegionEntry);
+
+        /// @brief Index of a chunk in its region
+        size_t GetEntryIndex(const int x, const int z)
+        {
+            return static_cast<size_t>((z - Utilities::FloorDiv(z, region_width) * region_width) * region_width + (x - Utilities::FloorDiv(x, region_width) * region_width));
+        }
+
+        /// @brief Make a dimension name usable as a folder name
+        std::string GetDimensionFolder(const std::string& dimension)
+        {
+            std::string output = dimension;
+            for (char& c : output)
+            {
+                if (c == ':' || c == '/' || c == '\\')
+                {
+                    c = '_';
+                }
+            }
+            return output;
+        }
+
+        template<typename T>
+        void WriteRaw(const T& value, std::vector<unsigned char>& output)
+        {
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+            output.insert(output.end(), bytes, bytes + sizeof(T));
+        }
+
+        template<typename T>
+        void WriteRawArray(const std::vector<T>& values, std::vector<unsigned char>& output)
+        {
+            WriteRaw(static_cast<uint32_t>(values.size()), output);
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(values.data());
+            output.insert(output.end(), bytes, bytes + values.size() * sizeof(T));
+        }
+
+        template<typename T>
+        bool ReadRaw(const unsigned char*& data, size_t& length, T& value)
+        {
+            if (length < sizeof(T))
+            {
+                return false;
+            }
+            std::memcpy(&value, data, sizeof(T));
+            data += sizeof(T);
+            length -= sizeof(T);
+            return true;
+        }
+
+        template<typename T>
+        bool ReadRawArray(const unsigned char*& data, size_t& length, std::vector<T>& values)
+        {
+            uint32_t size = 0;
+            if (!ReadRaw(data, length, size) || length / sizeof(T) < size)
+            {
+                return false;
+            }
+            values.resize(size);
+            std::memcpy(values.data(), data, size * sizeof(T));
+            data += size * sizeof(T);
+            length -= size * sizeof(T);
+            return true;
+        }
+    }
+
+    /// @brief A region file, with its chunks table and a read-only mapping of its content
+    class ChunkCache::Region
+    {
+    public:
+        Region(const std::filesystem::path& path_) : path(path_)
+        {
+            mapped_data = nullptr;
+            mapped_size = 0;
+            file_size = 0;
+            entries = std::vector<RegionEntry>(region_width * region_width, RegionEntry{ 0, 0, 0, 0 });
+
+            if (std::filesystem::exists(path))
+            {
+                file.open(path, std::ios::in | std::ios::out | std::ios::binary);
+                RegionHeader header{ 0, 0, 0, 0 };
+                file.read(reinterpret_cast<char*>(&header), sizeof(RegionHeader));
+                file.read(reinterpret_cast<char*>(entries.data()), entries.size() * sizeof(RegionEntry));
+                if (file && header.magic == region_magic && header.format_version == region_format_version &&
+                    header.protocol_version == PROTOCOL_VERSION && header.flags == region_flags)
+                {
+                    file_size = std::filesystem::file_size(path);
+                    return;
+                }
+                LOG_WARNING("Chunk cache region file " << path.string() << " is invalid or from another botcraft build, it will be overwritten");
+                file.close();
+                entries = std::vector<RegionEntry>(region_width * region_width, RegionEntry{ 0, 0, 0, 0 });
+            }
+
+            std::error_code ec;
+            std::filesystem::create_directories(path.parent_path(), ec);
+            file.open(path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+            const RegionHeader header{ region_magic, region_format_version, PROTOCOL_VERSION, region_flags };
+            file.write(reinterpret_cast<const char*>(&header), sizeof(RegionHeader));
+            file.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(RegionEntry));
+            file.flush();
+            if (!file)
+            {
+                LOG_ERROR("Error creating chunk cache region file " << path.string());
+                return;
+            }
+            file_size = region_header_size;
+        }
+
+        ~Region()
+        {
+            Unmap();
+        }
+
+        bool IsValid() const
+        {
+            return file_size >= region_header_size;
+        }
+
+        const RegionEntry& GetEntry(const size_t index) const
+        {
+            return entries[index];
+        }
+
+        /// @brief Get the data of a chunk, mapping the file if required
+        /// @param index Index of the chunk in the region
+        /// @return A pointer to the chunk data, valid until the next write. nullptr if the chunk is not stored
+        const unsigned char* GetData(const size_t index)
+        {
+            const RegionEntry& entry = entries[index];
+            if (entry.offset == 0)
+            {
+                return nullptr;
+            }
+            if (entry.offset + entry.size > mapped_size && (!Map() || entry.offset + entry.size > mapped_size))
+            {
+                return nullptr;
+            }
+            return mapped_data + entry.offset;
+        }
+
+        /// @brief Write the data of a chunk, reusing its previous place if big enough
+        /// @param index Index of the chunk in the region
+        /// @param data Chunk data
+        /// @param content_hash Hash of the network data of the chunk
+        void Write(const size_t index, const std::vector<unsigned char>& data, const uint64_t content_hash)
+        {
+            if (!IsValid())
+            {
+                return;
+            }
+
+            RegionEntry& entry = entries[index];
+            if (entry.offset == 0 || entry.capacity < data.size())
+            {
+                entry.offset = file_size;
+                entry.capacity = static_cast<uint32_t>(data.size());
+                file_size += data.size();
+                // The mapping doesn't cover the new end of the file, and extending a mapped file is not portable
+                Unmap();
+            }
+            entry.size = static_cast<uint32_t>(data.size());
+            entry.content_hash = content_hash;
+
+            file.seekp(entry.offset);
+            file.write(reinterpret_cast<const char*>(data.data()), data.size());
+            file.seekp(region_entries_offset + index * sizeof(RegionEntry));
+            file.write(reinterpret_cast<const char*>(&entry), sizeof(RegionEntry));
+            // Make the data visible to the mapping
+            file.flush();
+            if (!file)
+            {
+                LOG_ERROR("Error writing in chunk cache region file " << path.string());
+                file.clear();
+                entry = RegionEntry{ 0, 0, 0, 0 };
+            }
+        }
+
+    private:
+        bool Map()
+        {
+            Unmap();
+            if (file_size == 0)
+            {
+                return false;
+            }
+#ifdef _WIN32
+            HANDLE file_handle = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+            if (file_handle == INVALID_HANDLE_VALUE)
+            {
+                LOG_ERROR("Error opening chunk cache region file " << path.string());
+                return false;
+            }
+            HANDLE mapping_handle = CreateFileMappingW(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+            // The view keeps a reference to the mapping and the file, handles are not needed anymore
+            CloseHandle(file_handle);
+            if (mapping_handle == NULL)
+            {
+                LOG_ERROR("Error mapping chunk cache region file " << path.string());
+                return false;
+            }
+            void* view = MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping_handle);
+            if (view == NULL)
+            {
+                LOG_ERROR("Error mapping chunk cache region file " << path.string());
+                return false;
+            }
+#else
+            const int fd = open(path.c_str(), O_RDONLY);
+            if (fd == -1)
+            {
+                LOG_ERROR("Error opening chunk cache region file " << path.string());
+                return false;
+            }
+            void* view = mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0);
+            // The mapping keeps a reference to the file, the descriptor is not needed anymore
+            close(fd);
+            if (view == MAP_FAILED)
+            {
+                LOG_ERROR("Error mapping chunk cache region file " << path.string());
+                return false;
+            }
+#endif
+            mapped_data = static_cast<const unsigned char*>(view);
+            mapped_size = file_size;
+            return true;
+        }
+
+        void Unmap()
+        {
+            if (mapped_data == nullptr)
+            {
+                return;
+            }
+#ifdef _WIN32
+            UnmapViewOfFile(mapped_data);
+#else
+            munmap(const_cast<unsigned char*>(mapped_data), mapped_size);
+#endif
+            mapped_data = nullptr;
+            mapped_size = 0;
+        }
+
+    private:
+        const std::filesystem::path path;
+        std::fstream file;
+        uint64_t file_size;
+        std::vector<RegionEntry> entries;
+
+        const unsigned char* mapped_data;
+        uint64_t mapped_size;
+    };
+
+    ChunkCache::ChunkCache(const std::string& folder_, const size_t max_decoded_chunks_) :
+        folder(folder_), max_decoded_chunks(max_decoded_chunks_)
+    {
+        decoded_chunks_counter = 0;
+        regions_counter = 0;
+    }
+
+    ChunkCache::~ChunkCache()
+    {
+
+    }
+
+    void ChunkCache::Save(const std::string& dimension, const int x, const int z, const Chunk& chunk)
+    {
+        // Serialize before locking, so only the file write is done with the lock
+        std::vector<unsigned char> data;
+        WriteChunk(chunk, data);
+
+        std::scoped_lock<std::mutex> lock(cache_mutex);
+        Region* region = GetRegion(dimension, Utilities::FloorDiv(x, region_width), Utilities::FloorDiv(z, region_width), true);
+        if (region == nullptr)
+        {
+            return;
+        }
+
+        const size_t index = GetEntryIndex(x, z);
+        const RegionEntry& entry = region->GetEntry(index);
+        // Same network data as the stored version, nothing to write
+        if (chunk.GetContentHash() == 0 || entry.offset == 0 || entry.content_hash != chunk.GetContentHash())
+        {
+            region->Write(index, data, chunk.GetContentHash());
+        }
+
+        const auto it = decoded_chunks.find({ dimension, x, z });
+        if (it != decoded_chunks.end())
+        {
+            it->second.chunk = chunk;
+        }
+    }
+
+    bool ChunkCache::Contains(const std::string& dimension, const int x, const int z)
+    {
+        std::scoped_lock<std::mutex> lock(cache_mutex);
+        Region* region = GetRegion(dimension, Utilities::FloorDiv(x, region_width), Utilities::FloorDiv(z, region_width), false);
+        return region != nullptr && region->GetEntry(GetEntryIndex(x, z)).offset != 0;
+    }
+
+    std::optional<Chunk> ChunkCache::Load(const std::string& dimension, const int x, const int z, const size_t dim_index)
+    {
+        std::scoped_lock<std::mutex> lock(cache_mutex);
+        const Chunk* chunk = GetDecodedChunk(dimension, x, z);
+        if (chunk == nullptr)
+        {
+            return std::optional<Chunk>();
+        }
+        // Sections are shared with the decoded chunk, so this is cheap
+        std::optional<Chunk> output(*chunk);
+        output->dimension_index = dim_index;
+        return output;
+    }
+
+    const Blockstate* ChunkCache::GetBlock(const std::string& dimension, const Position& pos)
+    {
+        const int chunk_x = Utilities::FloorDiv(pos.x, CHUNK_WIDTH);
+        const int chunk_z = Utilities::FloorDiv(pos.z, CHUNK_WIDTH);
+
+        std::scoped_lock<std::mutex> lock(cache_mutex);
+        const Chunk* chunk = GetDecodedChunk(dimension, chunk_x, chunk_z);
+        if (chunk == nullptr)
+        {
+            return nullptr;
+        }
+        return chunk->GetBlock(Position(pos.x - chunk_x * CHUNK_WIDTH, pos.y, pos.z - chunk_z * CHUNK_WIDTH));
+    }
+
+    void ChunkCache::Flush()
+    {
+        std::scoped_lock<std::mutex> lock(cache_mutex);
+        regions.clear();
+    }
+
+    ChunkCache::Region* ChunkCache::GetRegion(const std::string& dimension, const int region_x, const int region_z, const bool create)
+    {
+        regions_counter += 1;
+
+        const RegionKey key{ dimension, region_x, region_z };
+        auto it = regions.find(key);
+        if (it != regions.end() && (it->second.region != nullptr || !create))
+        {
+            it->second.last_used = regions_counter;
+            return it->second.region.get();
+        }
+
+        const std::filesystem::path path = std::filesystem::path(folder) / GetDimensionFolder(dimension) /
+            ("r." + std::to_string(region_x) + "." + std::to_string(region_z) + ".bcr");
+
+        std::unique_ptr<Region> region;
+        if (create || std::filesystem::exists(path))
+        {
+            region = std::make_unique<Region>(path);
+            if (!region->IsValid())
+            {
+                region.reset();
+            }
+        }
+
+        if (it == regions.end())
+        {
+            // Close the least recently used region
+            if (regions.size() >= max_open_regions)
+            {
+                auto oldest = regions.begin();
+                for (auto it2 = regions.begin(); it2 != regions.end(); ++it2)
+                {
+                    if (it2->second.last_used < oldest->second.last_used)
+                    {
+                        oldest = it2;
+                    }
+                }
+                regions.erase(oldest);
+            }
+            it = regions.insert({ key, OpenedRegion{ nullptr, 0 } }).first;
+        }
+        it->second.region = std::move(region);
+        it->second.last_used = regions_counter;
+        return it->second.region.get();
+    }
+
+    const Chunk* ChunkCache::GetDecodedChunk(const std::string& dimension, const int x, const int z)
+    {
+        decoded_chunks_counter += 1;
+
+        const ChunkKey key{ dimension, x, z };
+        auto it = decoded_chunks.find(key);
+        if (it == decoded_chunks.end())
+        {
+            std::optional<Chunk> chunk;
+            Region* region = GetRegion(dimension, Utilities::FloorDiv(x, region_width), Utilities::FloorDiv(z, region_width), false);
+            if (region != nullptr)
+            {
+                const size_t index = GetEntryIndex(x, z);
+                const unsigned char* data = region->GetData(index);
+                if (data != nullptr)
+                {
+                    chunk = ReadChunk(data, region->GetEntry(index).size, 0);
+                    if (!chunk.has_value())
+                    {
+                        LOG_WARNING("Invalid data in chunk cache for chunk (" << x << ", " << z << ") in " << dimension);
+                    }
+                }
+            }
+
+            // Remove the least recently used chunk
+            if (!decoded_chunks.empty() && decoded_chunks.size() >= max_decoded_chunks)
+            {
+                auto oldest = decoded_chunks.begin();
+                for (auto it2 = decoded_chunks.begin(); it2 != decoded_chunks.end(); ++it2)
+                {
+                    if (it2->second.last_used < oldest->second.last_used)
+                    {
+                        oldest = it2;
+                    }
+                }
+                decoded_chunks.erase(oldest);
+            }
+            it = decoded_chunks.insert({ key, DecodedChunk{ std::move(chunk), 0 } }).first;
+        }
+
+        it->second.last_used = decoded_chunks_counter;
+        return it->second.chunk.has_value() ? &it->second.chunk.value() : nullptr;
+    }
+
+    void ChunkCache::WriteChunk(const Chunk& chunk, std::vector<unsigned char>& output)
+    {
+        WriteRaw(static_cast<int32_t>(chunk.GetMinY()), output);
+        WriteRaw(static_cast<int32_t>(chunk.GetHeight()), output);
+        WriteRaw(static_cast<uint8_t>(chunk.has_sky_light), output);
+        WriteRawArray(chunk.biomes, output);
+
+        WriteRaw(static_cast<uint32_t>(chunk.sections.size()), output);
+        for (const std::shared_ptr<Section>& section : chunk.sections)
+        {
+            WriteRaw(static_cast<uint8_t>(section != nullptr), output);
+            if (section == nullptr)
+            {
+                continue;
+            }
+            WriteRaw(section->bits_per_block, output);
+            WriteRawArray(section->palette, output);
+            WriteRawArray(section->data, output);
+            WriteRawArray(section->block_light, output);
+            WriteRawArray(section->sky_light, output);
+        }
+    }
+
+    std::optional<Chunk> ChunkCache::ReadChunk(const unsigned char* data, const size_t length, const size_t dim_index)
+    {
+        size_t remaining = length;
+        int32_t min_y = 0;
+        int32_t height = 0;
+        uint8_t has_sky_light = 0;
+        if (!ReadRaw(data, remaining, min_y) || !ReadRaw(data, remaining, height) || !ReadRaw(data, remaining, has_sky_light))
+        {
+            return std::optional<Chunk>();
+        }
+
+#if PROTOCOL_VERSION < 757 /* < 1.18 */
+        if (min_y != 0 || height != 256)
+        {
+            return std::optional<Chunk>();
+        }
+        std::optional<Chunk> chunk(std::in_place, dim_index, has_sky_light != 0);
+#else
+        if (height <= 0 || height % SECTION_HEIGHT != 0)
+        {
+            return std::optional<Chunk>();
+        }
+        std::optional<Chunk> chunk(std::in_place, min_y, static_cast<unsigned int>(height), dim_index, has_sky_light != 0);
+#endif
+
+        const size_t expected_biomes_size = chunk->biomes.size();
+        uint32_t num_sections = 0;
+        if (!ReadRawArray(data, remaining, chunk->biomes) || chunk->biomes.size() != expected_biomes_size ||
+            !ReadRaw(data, remaining, num_sections) || num_sections != chunk->sections.size())
+        {
+            return std::optional<Chunk>();
+        }
+
+        constexpr size_t num_light_bytes = CHUNK_WIDTH * CHUNK_WIDTH * SECTION_HEIGHT / 2;
+#if USE_GUI
+        constexpr size_t num_blocks = (CHUNK_WIDTH + 2) * (CHUNK_WIDTH + 2) * SECTION_HEIGHT;
+#else
+        constexpr size_t num_blocks = CHUNK_WIDTH * CHUNK_WIDTH * SECTION_HEIGHT;
+#endif
+        for (uint32_t i = 0; i < num_sections; ++i)
+        {
+            uint8_t has_section = 0;
+            if (!ReadRaw(data, remaining, has_section))
+            {
+                return std::optional<Chunk>();
+            }
+            if (has_section == 0)
+            {
+                continue;
+            }
+
+            std::shared_ptr<Section> section = std::make_shared<Section>();
+            if (!ReadRaw(data, remaining, section->bits_per_block) ||
+                !ReadRawArray(data, remaining, section->palette) ||
+                !ReadRawArray(data, remaining, section->data) ||
+                !ReadRawArray(data, remaining, section->block_light) ||
+                !ReadRawArray(data, remaining, section->sky_light))
+            {
+                return std::optional<Chunk>();
+            }
+
+            const unsigned char bits = section->bits_per_block;
+            if ((bits != 0 && bits != 1 && bits != 2 && bits != 4 && bits != 8 && bits != Section::max_bits_per_block) ||
+                (bits == 0 && section->palette.size() != 1) ||
+                (bits == Section::max_bits_per_block && !section->palette.empty()) ||
+                (bits != 0 && bits != Section::max_bits_per_block && (section->palette.empty() || section->palette.size() > (size_t{ 1 } << bits))) ||
+                section->data.size() < (num_blocks * bits + 63) / 64 ||
+                (!section->block_light.empty() && section->block_light.size() != num_light_bytes) ||
+                (!section->sky_light.empty() && section->sky_light.size() != num_light_bytes))
+            {
+                return std::optional<Chunk>();
+            }
+            section->value_mask = bits == 0 ? 0 : (1ULL << bits) - 1;
+            section->last_palette_index = 0;
+            // Corrupted values must not read outside the palette
+            if (!section->HasValidPaletteIndices())
+            {
+                return std::optional<Chunk>();
+            }
+            chunk->sections[i] = std::move(section);
+        }
+
+        return chunk;
+    }
+} // Botcraft
@@ -0,0 +1,202 @@
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "botcraft/Game/World/ChunkMap.hpp"
+
+namespace Botcraft
+{
+    ChunkMap::ChunkMap() : slots(initial_num_slots)
+    {
+        last_found = 0;
+    }
+
+    ChunkMap::ChunkMap(const ChunkMap& other) : entries(other.entries), slots(other.slots)
+    {
+        last_found = 0;
+    }
+
+    ChunkMap::ChunkMap(ChunkMap&& other) : entries(std::move(other.entries)), slots(std::move(other.slots))
+    {
+        last_found = 0;
+        // Leave other empty but still usable
+        other.entries.clear();
+        other.slots = Utilities::OpenAddressingIndex(initial_num_slots);
+        other.last_found = 0;
+    }
+
+    ChunkMap& ChunkMap::operator=(const ChunkMap& other)
+    {
+        entries = other.entries;
+        slots = other.slots;
+        last_found = 0;
+        return *this;
+    }
+
+    ChunkMap& ChunkMap::operator=(ChunkMap&& other)
+    {
+        if (this == &other)
+        {
+            return *this;
+        }
+        entries = std::move(other.entries);
+        slots = std::move(other.slots);
+        last_found = 0;
+        // Leave other empty but still usable
+        other.entries.clear();
+        other.slots = Utilities::OpenAddressingIndex(initial_num_slots);
+        other.last_found = 0;
+        return *this;
+    }
+
+    ChunkMap::iterator ChunkMap::begin()
+    {
+        return entries.begin();
+    }
+
+    ChunkMap::iterator ChunkMap::end()
+    {
+        return entries.end();
+    }
+
+    ChunkMap::const_iterator ChunkMap::begin() const
+    {
+        return entries.begin();
+    }
+
+    ChunkMap::const_iterator ChunkMap::end() const
+    {
+        return entries.end();
+    }
+
+    size_t ChunkMap::size() const
+    {
+        return entries.size();
+    }
+
+    bool ChunkMap::empty() const
+    {
+        return entries.empty();
+    }
+
+    void ChunkMap::clear()
+    {
+        entries.clear();
+        slots.Clear();
+        last_found = 0;
+    }
+
+    ChunkMap::iterator ChunkMap::find(const key_type& key)
+    {
+        return entries.begin() + FindIndex(key);
+    }
+
+    ChunkMap::const_iterator ChunkMap::find(const key_type& key) const
+    {
+        return entries.begin() + FindIndex(key);
+    }
+
+    Chunk& ChunkMap::at(const key_type& key)
+    {
+        const size_t index = FindIndex(key);
+        if (index == entries.size())
+        {
+            throw std::out_of_range("Chunk (" + std::to_string(key.first) + ", " + std::to_string(key.second) + ") is not loaded");
+        }
+        return entries[index].second;
+    }
+
+    const Chunk& ChunkMap::at(const key_type& key) const
+    {
+        const size_t index = FindIndex(key);
+        if (index == entries.size())
+        {
+            throw std::out_of_range("Chunk (" + std::to_string(key.first) + ", " + std::to_string(key.second) + ") is not loaded");
+        }
+        return entries[index].second;
+    }
+
+    std::pair<ChunkMap::iterator, bool> ChunkMap::insert(value_type&& value)
+    {
+        const size_t index = FindIndex(value.first);
+        if (index != entries.size())
+        {
+            return { entries.begin() + index, false };
+        }
+
+        slots.ReserveOneMore(entries.size(), [this](const size_t i) { return GetEntryKey(i); });
+
+        const size_t slot = FindSlot(value.first);
+        entries.push_back(std::move(value));
+        slots.SetIndex(slot, static_cast<uint32_t>(entries.size() - 1));
+        return { entries.end() - 1, true };
+    }
+
+    ChunkMap::iterator ChunkMap::erase(const_iterator it)
+    {
+        const size_t index = it - entries.cbegin();
+
+        slots.Erase(FindSlot(it->first), [this](const size_t i) { return GetEntryKey(i); });
+
+        // Move the last entry in the freed place to keep entries contiguous
+        const size_t last = entries.size() - 1;
+        if (index != last)
+        {
+            slots.SetIndex(FindSlot(entries[last].first), static_cast<uint32_t>(index));
+            entries[index] = std::move(entries[last]);
+        }
+        entries.pop_back();
+
+        return entries.begin() + index;
+    }
+
+    size_t ChunkMap::erase(const key_type& key)
+    {
+        const size_t index = FindIndex(key);
+        if (index == entries.size())
+        {
+            return 0;
+        }
+        erase(entries.cbegin() + index);
+        return 1;
+    }
+
+    uint64_t ChunkMap::PackKey(const key_type& key)
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(key.first)) << 32) | static_cast<uint32_t>(key.second);
+    }
+
+    uint64_t ChunkMap::GetEntryKey(const size_t index) const
+    {
+        return PackKey(entries[index].first);
+    }
+
+    size_t ChunkMap::FindIndex(const key_type& key) const
+    {
+        // Most queries in a row are in the same chunk
+        const size_t cached = last_found.load(std::memory_order_relaxed);
+        if (cached < entries.size() && entries[cached].first == key)
+        {
+            return cached;
+        }
+
+        const size_t slot = FindSlot(key);
+        if (slots.IsEmpty(slot))
+        {
+            return entries.size();
+        }
+
+        const size_t index = slots.GetIndex(slot);
+        // Only write when changed, to avoid invalidating the cache line of other readers
+        if (index != cached)
+        {
+            last_found.store(index, std::memory_order_relaxed);
+        }
+        return index;
+    }
+
+    size_t ChunkMap::FindSlot(const key_type& key) const
+    {
+        return slots.FindSlot(PackKey(key), [this](const size_t i) { return GetEntryKey(i); });
+    }
+} // Botcraft
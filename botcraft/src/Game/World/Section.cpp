@@ -1,25 +1,86 @@
+#include <array>
+#include <utility>
+
 #include "botcraft/Game/World/Blockstate.hpp"
 #include "botcraft/Game/World/Chunk.hpp"
 #include "botcraft/Game/World/Section.hpp"
 
 namespace Botcraft
 {
-    Section::Section(const bool has_sky_light)
-    {
 #if USE_GUI
-        // +2 because we also store the neighbour section blocks
-        data_blocks = std::vector<unsigned short>((CHUNK_WIDTH + 2) * (CHUNK_WIDTH + 2) * SECTION_HEIGHT);
+    // +2 because we also store the neighbour section blocks
+    static constexpr size_t num_blocks = (CHUNK_WIDTH + 2) * (CHUNK_WIDTH + 2) * SECTION_HEIGHT;
 #else
-        data_blocks = std::vector<unsigned short>(CHUNK_WIDTH * CHUNK_WIDTH * SECTION_HEIGHT);
+    static constexpr size_t num_blocks = CHUNK_WIDTH * CHUNK_WIDTH * SECTION_HEIGHT;
 #endif
+    static constexpr size_t num_light_bytes = CHUNK_WIDTH * CHUNK_WIDTH * SECTION_HEIGHT / 2;
+    /// @brief Number of entries in a network section, never includes the GUI borders
+    static constexpr size_t num_network_entries = CHUNK_WIDTH * CHUNK_WIDTH * SECTION_HEIGHT;
+
+    static constexpr size_t NumPackedLongs(const size_t bits)
+    {
+        return (num_network_entries + 64 / bits - 1) / (64 / bits);
+    }
+
+    // Unpack/pack kernels, specialized for each number of bits so all
+    // shifts and masks are constants and the inner loops can be unrolled
+    // and vectorized by the compiler
+
+    template<size_t bits>
+    static void UnpackEntries(const unsigned long long int* packed, unsigned short* output)
+    {
+        constexpr size_t entries_per_long = 64 / bits;
+        constexpr unsigned long long int mask = (1ULL << bits) - 1;
+        constexpr size_t num_full_longs = num_network_entries / entries_per_long;
+        for (size_t i = 0; i < num_full_longs; ++i)
+        {
+            const unsigned long long int value = packed[i];
+            unsigned short* out = output + i * entries_per_long;
+            for (size_t j = 0; j < entries_per_long; ++j)
+            {
+                out[j] = static_cast<unsigned short>((value >> (j * bits)) & mask);
+            }
+        }
+        constexpr size_t remaining = num_network_entries % entries_per_long;
+        for (size_t j = 0; j < remaining; ++j)
+        {
+            output[num_full_longs * entries_per_long + j] = static_cast<unsigned short>((packed[num_full_longs] >> (j * bits)) & mask);
+        }
+    }
 
-        block_light = std::vector<unsigned char>(CHUNK_WIDTH * CHUNK_WIDTH * SECTION_HEIGHT / 2);
-        if (has_sky_light)
+    template<size_t bits>
+    static void PackEntries(const unsigned short* input, unsigned long long int* packed)
+    {
+        static_assert(64 % bits == 0, "Packed entries must not span across multiple longs");
+        constexpr size_t entries_per_long = 64 / bits;
+        for (size_t i = 0; i < num_network_entries / entries_per_long; ++i)
         {
-            sky_light = std::vector<unsigned char>(CHUNK_WIDTH * CHUNK_WIDTH * SECTION_HEIGHT / 2);
+            const unsigned short* in = input + i * entries_per_long;
+            unsigned long long int value = 0;
+            for (size_t j = 0; j < entries_per_long; ++j)
+            {
+                value |= static_cast<unsigned long long int>(in[j]) << (j * bits);
+            }
+            packed[i] = value;
         }
     }
 
+    using UnpackFunction = void (*)(const unsigned long long int*, unsigned short*);
+
+    template<size_t... bits>
+    static constexpr std::array<UnpackFunction, sizeof...(bits) + 1> MakeUnpackTable(std::index_sequence<bits...>)
+    {
+        return { nullptr, &UnpackEntries<bits + 1>... };
+    }
+
+    /// @brief Unpack functions, indexed by number of bits per entry
+    static constexpr std::array<UnpackFunction, 17> unpack_table = MakeUnpackTable(std::make_index_sequence<16>());
+
+    Section::Section()
+    {
+        Fill(0);
+    }
+
     size_t Section::CoordsToBlockIndex(const int x, const int y, const int z)
     {
 #if USE_GUI
@@ -33,4 +94,453 @@ namespace Botcraft
     {
         return ((y * CHUNK_WIDTH + z) * CHUNK_WIDTH + x) / 2;
     }
+
+    void Section::SetBlock(const size_t index, const unsigned short id)
+    {
+        if (bits_per_block == max_bits_per_block)
+        {
+            SetStoredValue(index, id);
+            return;
+        }
+
+        if (last_palette_index >= palette.size() || palette[last_palette_index] != id)
+        {
+            size_t palette_index = 0;
+            while (palette_index < palette.size() && palette[palette_index] != id)
+            {
+                palette_index += 1;
+            }
+
+            if (palette_index == palette.size())
+            {
+                // Palette is full, widen the stored values
+                if (bits_per_block == 0)
+                {
+                    Grow(1);
+                }
+                else if (palette.size() == (size_t{ 1 } << bits_per_block))
+                {
+                    Grow(bits_per_block * 2);
+                    if (bits_per_block == max_bits_per_block)
+                    {
+                        SetStoredValue(index, id);
+                        return;
+                    }
+                }
+                palette.push_back(id);
+            }
+            last_palette_index = static_cast<unsigned short>(palette_index);
+        }
+
+        if (bits_per_block != 0)
+        {
+            SetStoredValue(index, last_palette_index);
+        }
+    }
+
+    void Section::Fill(const unsigned short id)
+    {
+        palette = { id };
+        data.clear();
+        data.shrink_to_fit();
+        bits_per_block = 0;
+        value_mask = 0;
+        last_palette_index = 0;
+    }
+
+    bool Section::LoadPackedData(const unsigned char bits_per_entry, const std::vector<int>& network_palette, const std::vector<unsigned long long int>& packed)
+    {
+        if (bits_per_entry == 0)
+        {
+            if (network_palette.size() != 1)
+            {
+                return false;
+            }
+#if USE_GUI
+            // Keep the neighbour blocks stored on the borders
+            for (int y = 0; y < SECTION_HEIGHT; ++y)
+            {
+                for (int z = 0; z < CHUNK_WIDTH; ++z)
+                {
+                    for (int x = 0; x < CHUNK_WIDTH; ++x)
+                    {
+                        SetBlock(CoordsToBlockIndex(x, y, z), static_cast<unsigned short>(network_palette[0]));
+                    }
+                }
+            }
+#else
+            Fill(static_cast<unsigned short>(network_palette[0]));
+#endif
+            return true;
+        }
+
+        if (bits_per_entry >= unpack_table.size() ||
+            packed.size() < NumPackedLongs(bits_per_entry) ||
+            network_palette.size() > (size_t{ 1 } << bits_per_entry))
+        {
+            return false;
+        }
+
+        const bool direct_ids = network_palette.empty();
+        unsigned char target_bits = max_bits_per_block;
+        if (!direct_ids)
+        {
+            target_bits = 1;
+            while (target_bits < bits_per_entry)
+            {
+                target_bits *= 2;
+            }
+        }
+
+#if !USE_GUI
+        // Same layout as the network, the packed data can be used as is
+        if (!direct_ids && target_bits == bits_per_entry && target_bits < max_bits_per_block)
+        {
+            palette.resize(network_palette.size());
+            for (size_t i = 0; i < network_palette.size(); ++i)
+            {
+                palette[i] = static_cast<unsigned short>(network_palette[i]);
+            }
+            data.assign(packed.begin(), packed.begin() + NumPackedLongs(bits_per_entry));
+            bits_per_block = target_bits;
+            value_mask = (1ULL << bits_per_block) - 1;
+            last_palette_index = 0;
+            // Invalid entries must not read outside the palette, let the generic path replace them with air
+            if (HasValidPaletteIndices())
+            {
+                return true;
+            }
+        }
+#endif
+
+        std::array<unsigned short, num_network_entries> entries;
+        unpack_table[bits_per_entry](packed.data(), entries.data());
+
+        std::vector<unsigned short> ids_palette(network_palette.size());
+        for (size_t i = 0; i < network_palette.size(); ++i)
+        {
+            ids_palette[i] = static_cast<unsigned short>(network_palette[i]);
+        }
+        if (!direct_ids)
+        {
+            // Invalid entries are replaced by air
+            const unsigned short invalid_index = static_cast<unsigned short>(network_palette.size());
+            bool has_invalid_entries = false;
+            for (size_t i = 0; i < num_network_entries; ++i)
+            {
+                if (entries[i] >= invalid_index)
+                {
+                    entries[i] = invalid_index;
+                    has_invalid_entries = true;
+                }
+            }
+            if (has_invalid_entries)
+            {
+                ids_palette.push_back(0);
+            }
+        }
+
+        // Values stored with max_bits_per_block are ids, not palette indices
+        const bool store_ids = direct_ids || target_bits == max_bits_per_block;
+        if (!direct_ids && store_ids)
+        {
+            for (size_t i = 0; i < num_network_entries; ++i)
+            {
+                entries[i] = ids_palette[entries[i]];
+            }
+            ids_palette.clear();
+        }
+
+#if USE_GUI
+        // Keep the neighbour blocks stored on the borders
+        size_t i = 0;
+        for (int y = 0; y < SECTION_HEIGHT; ++y)
+        {
+            for (int z = 0; z < CHUNK_WIDTH; ++z)
+            {
+                for (int x = 0; x < CHUNK_WIDTH; ++x)
+                {
+                    SetBlock(CoordsToBlockIndex(x, y, z), store_ids ? entries[i] : ids_palette[entries[i]]);
+                    ++i;
+                }
+            }
+        }
+#else
+        palette = std::move(ids_palette);
+        palette.shrink_to_fit();
+        bits_per_block = target_bits;
+        value_mask = (1ULL << bits_per_block) - 1;
+        last_palette_index = 0;
+        data.resize(NumPackedLongs(bits_per_block));
+        switch (bits_per_block)
+        {
+        case 1:
+            PackEntries<1>(entries.data(), data.data());
+            break;
+        case 2:
+            PackEntries<2>(entries.data(), data.data());
+            break;
+        case 4:
+            PackEntries<4>(entries.data(), data.data());
+            break;
+        case 8:
+            PackEntries<8>(entries.data(), data.data());
+            break;
+        case 16:
+            PackEntries<16>(entries.data(), data.data());
+            break;
+        default:
+            break;
+        }
+#endif
+        return true;
+    }
+
+    unsigned char Section::GetBlockLight(const int x, const int y, const int z) const
+    {
+        if (block_light.empty())
+        {
+            return 0;
+        }
+        return (static_cast<unsigned char>(block_light[CoordsToLightIndex(x, y, z)]) >> (4 * (x % 2))) & 0x0F;
+    }
+
+    void Section::SetBlockLight(const int x, const int y, const int z, const unsigned char v)
+    {
+        if (block_light.empty())
+        {
+            if ((v & 0x0F) == 0)
+            {
+                return;
+            }
+            block_light = std::vector<char>(num_light_bytes, 0);
+        }
+
+        unsigned char* packed_value = reinterpret_cast<unsigned char*>(block_light.data()) + CoordsToLightIndex(x, y, z);
+        if (x % 2 == 1)
+        {
+            *packed_value = (*packed_value & 0x0F) | ((v & 0x0F) << 4);
+        }
+        else
+        {
+            *packed_value = (*packed_value & 0xF0) | (v & 0x0F);
+        }
+    }
+
+    unsigned char Section::GetSkyLight(const int x, const int y, const int z) const
+    {
+        if (sky_light.empty())
+        {
+            return 0;
+        }
+        return (static_cast<unsigned char>(sky_light[CoordsToLightIndex(x, y, z)]) >> (4 * (x % 2))) & 0x0F;
+    }
+
+    void Section::SetSkyLight(const int x, const int y, const int z, const unsigned char v)
+    {
+        if (sky_light.empty())
+        {
+            if ((v & 0x0F) == 0)
+            {
+                return;
+            }
+            sky_light = std::vector<char>(num_light_bytes, 0);
+        }
+
+        unsigned char* packed_value = reinterpret_cast<unsigned char*>(sky_light.data()) + CoordsToLightIndex(x, y, z);
+        if (x % 2 == 1)
+        {
+            *packed_value = (*packed_value & 0x0F) | ((v & 0x0F) << 4);
+        }
+        else
+        {
+            *packed_value = (*packed_value & 0xF0) | (v & 0x0F);
+        }
+    }
+
+    void Section::SetLightData(std::vector<char>&& light, const bool sky)
+    {
+        if (sky)
+        {
+            sky_light = std::move(light);
+        }
+        else
+        {
+            block_light = std::move(light);
+        }
+    }
+
+#if USE_GUI
+    /// @brief Get the layout of a border of a section
+    /// @param direction Side of the border
+    /// @param border Coordinate of the border blocks along the fixed axis
+    /// @param source Coordinate of the matching blocks in the neighbour section along the fixed axis
+    /// @param fixed_x True if the border is along the z axis (x is fixed), false if it's along the x axis
+    /// @return False if direction is not a horizontal side
+    static bool GetBorderLayout(const Orientation direction, int& border, int& source, bool& fixed_x)
+    {
+        switch (direction)
+        {
+        case Orientation::North:
+            border = -1;
+            source = CHUNK_WIDTH - 1;
+            fixed_x = false;
+            return true;
+        case Orientation::South:
+            border = CHUNK_WIDTH;
+            source = 0;
+            fixed_x = false;
+            return true;
+        case Orientation::West:
+            border = -1;
+            source = CHUNK_WIDTH - 1;
+            fixed_x = true;
+            return true;
+        case Orientation::East:
+            border = CHUNK_WIDTH;
+            source = 0;
+            fixed_x = true;
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    void Section::CopyBorder(const Section* neighbour, const Orientation direction)
+    {
+        if (neighbour == nullptr)
+        {
+            FillBorder(direction, 0);
+            return;
+        }
+        if (neighbour->bits_per_block == 0)
+        {
+            FillBorder(direction, neighbour->palette[0]);
+            return;
+        }
+
+        int border, source;
+        bool fixed_x;
+        if (!GetBorderLayout(direction, border, source, fixed_x))
+        {
+            return;
+        }
+
+        for (int y = 0; y < SECTION_HEIGHT; ++y)
+        {
+            for (int i = 0; i < CHUNK_WIDTH; ++i)
+            {
+                if (fixed_x)
+                {
+                    SetBlock(CoordsToBlockIndex(border, y, i), neighbour->GetBlock(CoordsToBlockIndex(source, y, i)));
+                }
+                else
+                {
+                    SetBlock(CoordsToBlockIndex(i, y, border), neighbour->GetBlock(CoordsToBlockIndex(i, y, source)));
+                }
+            }
+        }
+    }
+
+    void Section::FillBorder(const Orientation direction, const unsigned short id)
+    {
+        // Nothing to change if the whole section already has this value
+        if (bits_per_block == 0 && palette[0] == id)
+        {
+            return;
+        }
+
+        int border, source;
+        bool fixed_x;
+        if (!GetBorderLayout(direction, border, source, fixed_x))
+        {
+            return;
+        }
+
+        for (int y = 0; y < SECTION_HEIGHT; ++y)
+        {
+            for (int i = 0; i < CHUNK_WIDTH; ++i)
+            {
+                SetBlock(fixed_x ? CoordsToBlockIndex(border, y, i) : CoordsToBlockIndex(i, y, border), id);
+            }
+        }
+    }
+#endif
+
+    unsigned char Section::GetBitsPerBlock() const
+    {
+        return bits_per_block;
+    }
+
+    size_t Section::GetMemoryUsage() const
+    {
+        return sizeof(Section) +
+            palette.capacity() * sizeof(unsigned short) +
+            data.capacity() * sizeof(unsigned long long int) +
+            block_light.capacity() +
+            sky_light.capacity();
+    }
+
+    unsigned short Section::GetStoredValue(const size_t index) const
+    {
+        if (bits_per_block == 0)
+        {
+            return 0;
+        }
+        const size_t bit_offset = index * bits_per_block;
+        return static_cast<unsigned short>((data[bit_offset >> 6] >> (bit_offset & 63)) & value_mask);
+    }
+
+    void Section::SetStoredValue(const size_t index, const unsigned short value)
+    {
+        // bits_per_block is a power of two, so entries never span across two longs
+        const size_t bit_offset = index * bits_per_block;
+        unsigned long long int& packed = data[bit_offset >> 6];
+        const size_t shift = bit_offset & 63;
+        packed = (packed & ~(value_mask << shift)) | (static_cast<unsigned long long int>(value) << shift);
+    }
+
+    bool Section::HasValidPaletteIndices() const
+    {
+        if (bits_per_block == 0 || bits_per_block == max_bits_per_block || palette.size() == (size_t{ 1 } << bits_per_block))
+        {
+            return true;
+        }
+        for (size_t i = 0; i < num_blocks; ++i)
+        {
+            if (GetStoredValue(i) >= palette.size())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void Section::Grow(const unsigned char new_bits_per_block)
+    {
+        std::vector<unsigned short> values(num_blocks);
+        for (size_t i = 0; i < num_blocks; ++i)
+        {
+            values[i] = GetStoredValue(i);
+        }
+
+        const bool direct_ids = new_bits_per_block >= max_bits_per_block;
+        if (direct_ids)
+        {
+            for (size_t i = 0; i < num_blocks; ++i)
+            {
+                values[i] = palette[values[i]];
+            }
+            palette.clear();
+            palette.shrink_to_fit();
+        }
+
+        bits_per_block = direct_ids ? max_bits_per_block : new_bits_per_block;
+        value_mask = (1ULL << bits_per_block) - 1;
+        data = std::vector<unsigned long long int>((num_blocks * bits_per_block + 63) / 64, 0);
+        for (size_t i = 0; i < num_blocks; ++i)
+        {
+            SetStoredValue(i, values[i]);
+        }
+    }
 } // Botcraft
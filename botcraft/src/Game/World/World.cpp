@@ -1,11 +1,16 @@
+#include <algorithm>
+#include <string_view>
+#include <tuple>
+
 #include "botcraft/Game/World/Chunk.hpp"
+#include "botcraft/Game/World/ChunkCache.hpp"
 #include "botcraft/Game/World/World.hpp"
 
 #include "botcraft/Utilities/Logger.hpp"
 
 namespace Botcraft
 {
-    World::World(const bool is_shared_) : is_shared(is_shared_)
+    World::World(const bool is_shared_, const LightPolicy light_policy_) : is_shared(is_shared_), light_policy(light_policy_)
     {
 #if PROTOCOL_VERSION < 719 /* < 1.16 */
         current_dimension = Dimension::None;
@@ -23,6 +28,19 @@ namespace Botcraft
 
     }
 
+    PacketFilter World::GetPacketFilter() const
+    {
+        PacketFilter filter = HANDLED_PACKETS_FILTER(World);
+        if (light_policy == LightPolicy::Ignore)
+        {
+#if PROTOCOL_VERSION > 404 /* > 1.13.2 */
+            filter.Remove(ProtocolCraft::ConnectionState::Play, ProtocolCraft::ClientboundLightUpdatePacket::packet_id);
+#endif
+            filter.SetSkipLightData(true);
+        }
+        return filter;
+    }
+
     bool World::IsLoaded(const Position& pos) const
     {
         std::shared_lock<std::shared_mutex> lock(world_mutex);
@@ -38,6 +56,11 @@ namespace Botcraft
         return is_shared;
     }
 
+    LightPolicy World::GetLightPolicy() const
+    {
+        return light_policy;
+    }
+
     int World::GetHeight() const
     {
 #if PROTOCOL_VERSION < 757 /* < 1.18 */
@@ -111,25 +134,58 @@ namespace Botcraft
 
     void World::UnloadChunk(const int x, const int z, const std::thread::id& loader_id)
     {
-        std::scoped_lock<std::shared_mutex> lock(world_mutex);
-        UnloadChunkImpl(x, z, loader_id);
+        std::optional<Chunk> unloaded;
+        std::shared_ptr<ChunkCache> cache;
+        std::string dimension;
+        {
+            std::scoped_lock<std::shared_mutex> lock(world_mutex);
+            unloaded = UnloadChunkImpl(x, z, loader_id);
+            if (unloaded.has_value())
+            {
+                cache = chunk_cache;
+                dimension = GetCacheDimensionName(index_dimension_map.at(unloaded->GetDimensionIndex()));
+            }
+        }
+
+        // Written after releasing the world lock so other threads can still use the world,
+        // but the write itself is done on this thread
+        if (unloaded.has_value())
+        {
+            cache->Save(dimension, x, z, unloaded.value());
+        }
     }
 
     void World::UnloadAllChunks(const std::thread::id& loader_id)
     {
-        std::scoped_lock<std::shared_mutex> lock(world_mutex);
-        for (auto it = terrain.begin(); it != terrain.end();)
+        std::vector<std::tuple<int, int, std::string, Chunk> > unloaded;
+        std::shared_ptr<ChunkCache> cache;
         {
-            const int load_count = it->second.RemoveLoader(loader_id);
-            if (load_count == 0)
-            {
-                terrain.erase(it++);
-            }
-            else
+            std::scoped_lock<std::shared_mutex> lock(world_mutex);
+            cache = chunk_cache;
+            for (auto it = terrain.begin(); it != terrain.end();)
             {
-                ++it;
+                const int load_count = it->second.RemoveLoader(loader_id);
+                if (load_count == 0)
+                {
+                    if (cache != nullptr)
+                    {
+                        unloaded.emplace_back(it->first.first, it->first.second,
+                            GetCacheDimensionName(index_dimension_map.at(it->second.GetDimensionIndex())), std::move(it->second));
+                    }
+                    it = terrain.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
             }
         }
+
+        // Same as UnloadChunk, written on this thread without holding the world lock
+        for (const auto& [x, z, dimension, chunk] : unloaded)
+        {
+            cache->Save(dimension, x, z, chunk);
+        }
     }
 
     void World::SetBlock(const Position& pos, const BlockstateId id)
@@ -141,18 +197,132 @@ namespace Botcraft
     const Blockstate* World::GetBlock(const Position& pos) const
     {
         std::shared_lock<std::shared_mutex> lock(world_mutex);
-        return GetBlockImpl(pos);
+        return WorldView(terrain).GetBlock(pos);
     }
 
     std::vector<const Blockstate*> World::GetBlocks(const std::vector<Position>& pos) const
     {
         std::shared_lock<std::shared_mutex> lock(world_mutex);
-        std::vector<const Blockstate*> output(pos.size());
-        for (size_t i = 0; i < pos.size(); ++i)
+        return WorldView(terrain).GetBlocks(pos);
+    }
+
+    std::vector<const Blockstate*> World::GetBlocks(const Position& min, const Position& max) const
+    {
+        std::shared_lock<std::shared_mutex> lock(world_mutex);
+        return WorldView(terrain).GetBlocks(min, max);
+    }
+
+    WorldView World::GetView() const
+    {
+        return WorldView(terrain, world_mutex);
+    }
+
+    ChunkMap World::GetChunksSnapshot(const Position& min, const Position& max) const
+    {
+        const int min_chunk_x = static_cast<int>(std::floor(min.x / static_cast<double>(CHUNK_WIDTH)));
+        const int min_chunk_z = static_cast<int>(std::floor(min.z / static_cast<double>(CHUNK_WIDTH)));
+        const int max_chunk_x = static_cast<int>(std::floor(max.x / static_cast<double>(CHUNK_WIDTH)));
+        const int max_chunk_z = static_cast<int>(std::floor(max.z / static_cast<double>(CHUNK_WIDTH)));
+
+        ChunkMap output;
+        std::shared_lock<std::shared_mutex> lock(world_mutex);
+        for (int x = min_chunk_x; x <= max_chunk_x; ++x)
+        {
+            for (int z = min_chunk_z; z <= max_chunk_z; ++z)
+            {
+                auto it = terrain.find({ x, z });
+                if (it != terrain.end())
+                {
+                    output.insert({ it->first, it->second });
+                }
+            }
+        }
+        return output;
+    }
+
+    void World::SetChunkCache(const std::shared_ptr<ChunkCache>& cache)
+    {
+        std::scoped_lock<std::shared_mutex> lock(world_mutex);
+        chunk_cache = cache;
+    }
+
+    std::shared_ptr<ChunkCache> World::GetChunkCache() const
+    {
+        std::shared_lock<std::shared_mutex> lock(world_mutex);
+        return chunk_cache;
+    }
+
+    const Blockstate* World::GetLastKnownBlock(const Position& pos) const
+    {
+        const int chunk_x = static_cast<int>(std::floor(pos.x / static_cast<double>(CHUNK_WIDTH)));
+        const int chunk_z = static_cast<int>(std::floor(pos.z / static_cast<double>(CHUNK_WIDTH)));
+
+        std::shared_ptr<ChunkCache> cache;
+        std::string dimension;
+        {
+            std::shared_lock<std::shared_mutex> lock(world_mutex);
+            WorldView view(terrain);
+            if (view.GetChunk(chunk_x, chunk_z) != nullptr)
+            {
+                return view.GetBlock(pos);
+            }
+            if (chunk_cache == nullptr)
+            {
+                return nullptr;
+            }
+            cache = chunk_cache;
+            dimension = GetCacheDimensionName(current_dimension);
+        }
+        return cache->GetBlock(dimension, pos);
+    }
+
+    ChunkMap World::GetLastKnownChunks(const Position& min, const Position& max) const
+    {
+        const int min_chunk_x = static_cast<int>(std::floor(min.x / static_cast<double>(CHUNK_WIDTH)));
+        const int min_chunk_z = static_cast<int>(std::floor(min.z / static_cast<double>(CHUNK_WIDTH)));
+        const int max_chunk_x = static_cast<int>(std::floor(max.x / static_cast<double>(CHUNK_WIDTH)));
+        const int max_chunk_z = static_cast<int>(std::floor(max.z / static_cast<double>(CHUNK_WIDTH)));
+
+        ChunkMap output;
+        std::vector<std::pair<int, int> > missing_chunks;
+        std::shared_ptr<ChunkCache> cache;
+        std::string dimension;
+        size_t dim_index = 0;
         {
-            output[i] = GetBlockImpl(pos[i]);
+            std::shared_lock<std::shared_mutex> lock(world_mutex);
+            for (int x = min_chunk_x; x <= max_chunk_x; ++x)
+            {
+                for (int z = min_chunk_z; z <= max_chunk_z; ++z)
+                {
+                    auto it = terrain.find({ x, z });
+                    if (it != terrain.end())
+                    {
+                        output.insert({ it->first, it->second });
+                    }
+                    else
+                    {
+                        missing_chunks.push_back({ x, z });
+                    }
+                }
+            }
+            cache = chunk_cache;
+            dimension = GetCacheDimensionName(current_dimension);
+            const auto dim_it = dimension_index_map.find(current_dimension);
+            // If no chunk has been loaded in this dimension yet, use the index it will get
+            dim_index = dim_it == dimension_index_map.end() ? dimension_index_map.size() : dim_it->second;
         }
 
+        if (cache != nullptr)
+        {
+            for (const auto& [x, z] : missing_chunks)
+            {
+                std::optional<Chunk> chunk = cache->Load(dimension, x, z, dim_index);
+                if (chunk.has_value())
+                {
+                    output.insert({ { x, z }, std::move(chunk.value()) });
+                }
+            }
+        }
         return output;
     }
 
@@ -165,6 +335,7 @@ namespace Botcraft
         output.reserve(32);
         Position current_pos;
         std::shared_lock<std::shared_mutex> lock(world_mutex);
+        WorldView view(terrain);
         for (int y = static_cast<int>(std::floor(min_aabb.y)) - 1; y <= static_cast<int>(std::floor(max_aabb.y)); ++y)
         {
             current_pos.y = y;
@@ -174,7 +345,7 @@ namespace Botcraft
                 for (int x = static_cast<int>(std::floor(min_aabb.x)); x <= static_cast<int>(std::floor(max_aabb.x)); ++x)
                 {
                     current_pos.x = x;
-                    const Blockstate* block = GetBlockImpl(current_pos);
+                    const Blockstate* block = view.GetBlock(current_pos);
                     if (block == nullptr || !block->IsSolid())
                     {
                         continue;
@@ -193,12 +364,13 @@ namespace Botcraft
     Vector3<double> World::GetFlow(const Position& pos)
     {
         std::shared_lock<std::shared_mutex> lock(world_mutex);
+        WorldView view(terrain);
         Vector3<double> flow(0.0);
         std::vector<Position> horizontal_neighbours = {
             Position(0, 0, -1), Position(1, 0, 0),
             Position(0, 0, 1), Position(-1, 0, 0)
         };
-        const Blockstate* block = GetBlockImpl(pos);
+        const Blockstate* block = view.GetBlock(pos);
         if (block == nullptr || !block->IsFluidOrWaterlogged())
         {
             return flow;
@@ -207,7 +379,7 @@ namespace Botcraft
         const float current_fluid_height = block->GetFluidHeight();
         for (const Position& neighbour_pos : horizontal_neighbours)
         {
-            const Blockstate* neighbour = GetBlockImpl(pos + neighbour_pos);
+            const Blockstate* neighbour = view.GetBlock(pos + neighbour_pos);
             if (neighbour == nullptr || (neighbour->IsFluidOrWaterlogged() && neighbour->IsWaterOrWaterlogged() != block->IsWaterOrWaterlogged()))
             {
                 continue;
@@ -217,7 +389,7 @@ namespace Botcraft
             {
                 if (!neighbour->IsSolid())
                 {
-                    const Blockstate* block_below_neighbour = GetBlockImpl(pos + neighbour_pos + Position(0, -1, 0));
+                    const Blockstate* block_below_neighbour = view.GetBlock(pos + neighbour_pos + Position(0, -1, 0));
                     if (block_below_neighbour != nullptr &&
                         (!block_below_neighbour->IsFluidOrWaterlogged() || block_below_neighbour->IsWaterOrWaterlogged() == block->IsWaterOrWaterlogged()))
                     {
@@ -241,12 +413,12 @@ namespace Botcraft
         {
             for (const Position& neighbour_pos : horizontal_neighbours)
             {
-                const Blockstate* neighbour = GetBlockImpl(pos + neighbour_pos);
+                const Blockstate* neighbour = view.GetBlock(pos + neighbour_pos);
                 if (neighbour == nullptr)
                 {
                     continue;
                 }
-                const Blockstate* above_neighbour = GetBlockImpl(pos + neighbour_pos + Position(0, 1, 0));
+                const Blockstate* above_neighbour = view.GetBlock(pos + neighbour_pos + Position(0, 1, 0));
                 if (above_neighbour == nullptr)
                 {
                     continue;
@@ -264,9 +436,9 @@ namespace Botcraft
         return flow;
     }
 
-    Utilities::ScopeLockedWrapper<const std::unordered_map<std::pair<int, int>, Chunk>, std::shared_mutex, std::shared_lock> World::GetChunks() const
+    Utilities::ScopeLockedWrapper<const ChunkMap, std::shared_mutex, std::shared_lock> World::GetChunks() const
     {
-        return Utilities::ScopeLockedWrapper<const std::unordered_map<std::pair<int, int>, Chunk>, std::shared_mutex, std::shared_lock>(terrain, world_mutex);
+        return Utilities::ScopeLockedWrapper<const ChunkMap, std::shared_mutex, std::shared_lock>(terrain, world_mutex);
     }
 
 #if PROTOCOL_VERSION < 358 /* < 1.13 */
@@ -606,6 +778,7 @@ namespace Botcraft
     bool World::IsFree(const AABB& aabb, const bool fluid_collide) const
     {
         std::shared_lock<std::shared_mutex> lock(world_mutex);
+        WorldView view(terrain);
 
         const Vector3<double> min_aabb = aabb.GetMin();
         const Vector3<double> max_aabb = aabb.GetMax();
@@ -620,7 +793,7 @@ namespace Botcraft
                 for (int x = static_cast<int>(std::floor(min_aabb.x)); x <= static_cast<int>(std::floor(max_aabb.x)); ++x)
                 {
                     cube_pos.x = x;
-                    const Blockstate* block = GetBlockImpl(cube_pos);
+                    const Blockstate* block = view.GetBlock(cube_pos);
 
                     if (block == nullptr)
                     {
@@ -817,25 +990,78 @@ namespace Botcraft
 #else
     void World::Handle(ProtocolCraft::ClientboundLevelChunkWithLightPacket& msg)
     {
+        // In a shared world, all the bots in the same area receive the same chunks.
+        // Hashing is much cheaper than decoding, so only the first one is decoded
+        std::shared_ptr<std::vector<unsigned char>> content;
+        size_t content_hash = 0;
+        if (is_shared)
+        {
+            content = std::make_shared<std::vector<unsigned char>>();
+            content_hash = ComputeChunkContentHash(msg, *content);
+        }
+
+        std::string dim;
+        std::optional<Chunk> decoded;
+        { // lock scope
             std::scoped_lock<std::shared_mutex> lock(world_mutex);
-            LoadChunkImpl(msg.GetX(), msg.GetZ(), current_dimension, std::this_thread::get_id());
-            LoadDataInChunk(msg.GetX(), msg.GetZ(), msg.GetChunkData().GetBuffer());
-            LoadBlockEntityDataInChunk(msg.GetX(), msg.GetZ(), msg.GetChunkData().GetBlockEntitiesData());
-            UpdateChunkLight(msg.GetX(), msg.GetZ(), current_dimension,
-                msg.GetLightData().GetSkyYMask(), msg.GetLightData().GetEmptySkyYMask(), msg.GetLightData().GetSkyUpdates(), true);
-            UpdateChunkLight(msg.GetX(), msg.GetZ(), current_dimension,
-                msg.GetLightData().GetBlockYMask(), msg.GetLightData().GetEmptyBlockYMask(), msg.GetLightData().GetBlockUpdates(), false);
+            const Chunk* chunk = GetChunk(msg.GetX(), msg.GetZ());
+            if (content_hash != 0 && chunk != nullptr && chunk->IsLoadedFrom(content_hash, *content) &&
+                chunk->GetDimensionIndex() == GetDimIndex(current_dimension))
+            {
+                // Already loaded with the same data and not modified since, registering the loader is enough
+                LoadChunkImpl(msg.GetX(), msg.GetZ(), current_dimension, std::this_thread::get_id());
+                return;
+            }
+            dim = current_dimension;
+            decoded.emplace(dimension_min_y.at(dim), dimension_height.at(dim), GetDimIndex(dim), dim == "minecraft:overworld");
+        }
+
+        // Decode the chunk without holding the lock, so other threads can still read the world in the meantime
+        decoded->LoadChunkData(msg.GetChunkData().GetBuffer());
+        decoded->LoadChunkBlockEntitiesData(msg.GetChunkData().GetBlockEntitiesData());
+        if (light_policy != LightPolicy::Ignore)
+        {
+            ProtocolCraft::ClientboundLightUpdatePacketData& light_data = msg.GetLightData();
+            LoadLightInChunk(*decoded, light_data.GetSkyYMask(), light_data.GetEmptySkyYMask(), light_data.GetSkyUpdates(), true);
+            LoadLightInChunk(*decoded, light_data.GetBlockYMask(), light_data.GetEmptyBlockYMask(), light_data.GetBlockUpdates(), false);
+        }
+        decoded->SetContentHash(content_hash, content);
+
+        std::scoped_lock<std::shared_mutex> lock(world_mutex);
+        LoadChunkImpl(msg.GetX(), msg.GetZ(), dim, std::this_thread::get_id());
+        Chunk* chunk = GetChunk(msg.GetX(), msg.GetZ());
+        // Keep the loaders of the chunk we are replacing
+        for (const std::thread::id& loader : chunk->GetLoaders())
+        {
+            decoded->AddLoader(loader);
+        }
+        *chunk = std::move(*decoded);
+#if USE_GUI
+        UpdateChunk(msg.GetX(), msg.GetZ());
+#endif
     }
 #endif
 
 #if PROTOCOL_VERSION > 404 /* > 1.13.2 */
     void World::Handle(ProtocolCraft::ClientboundLightUpdatePacket& msg)
     {
+        if (light_policy == LightPolicy::Ignore)
+        {
+            return;
+        }
+
         std::scoped_lock<std::shared_mutex> lock(world_mutex);
 #if PROTOCOL_VERSION < 757 /* < 1.18 */
         if (terrain.find({ msg.GetX(), msg.GetZ() }) == terrain.end())
         {
-            delayed_light_updates[{msg.GetX(), msg.GetZ()}] = msg;
+            if (light_policy == LightPolicy::Raw)
+            {
+                delayed_light_updates[{msg.GetX(), msg.GetZ()}] = std::move(msg);
+            }
+            else
+            {
+                delayed_light_updates[{msg.GetX(), msg.GetZ()}] = msg;
+            }
             return;
         }
         UpdateChunkLight(msg.GetX(), msg.GetZ(), current_dimension,
@@ -918,7 +1144,7 @@ namespace Botcraft
             {
                 LOG_WARNING("Changing dimension with a shared world is not supported and can lead to wrong world data");
             }
-            UnloadChunkImpl(x, z, loader_id);
+            // Replace the chunk in place, unloading it first could remove it and invalidate it
 #if PROTOCOL_VERSION < 757 /* < 1.18 */
             it->second = Chunk(dim_index, has_sky_light);
 #else
@@ -935,20 +1161,26 @@ namespace Botcraft
         //UpdateChunk(x, z);
     }
 
-    void World::UnloadChunkImpl(const int x, const int z, const std::thread::id& loader_id)
+    std::optional<Chunk> World::UnloadChunkImpl(const int x, const int z, const std::thread::id& loader_id)
     {
+        std::optional<Chunk> unloaded;
         auto it = terrain.find({ x, z });
         if (it != terrain.end())
         {
             const size_t load_counter = it->second.RemoveLoader(loader_id);
             if (load_counter == 0)
             {
+                if (chunk_cache != nullptr)
+                {
+                    unloaded = std::move(it->second);
+                }
                 terrain.erase(it);
 #if USE_GUI
                 UpdateChunk(x, z);
 #endif
             }
         }
+        return unloaded;
     }
 
     void World::SetBlockImpl(const Position& pos, const BlockstateId id)
@@ -978,28 +1210,6 @@ namespace Botcraft
 #endif
     }
 
-    const Blockstate* World::GetBlockImpl(const Position& pos) const
-    {
-        const int chunk_x = static_cast<int>(std::floor(pos.x / static_cast<double>(CHUNK_WIDTH)));
-        const int chunk_z = static_cast<int>(std::floor(pos.z / static_cast<double>(CHUNK_WIDTH)));
-
-        auto it = terrain.find({ chunk_x, chunk_z });
-
-        // Can't get block in unloaded chunk
-        if (it == terrain.end())
-        {
-            return nullptr;
-        }
-
-        const Position chunk_pos(
-            (pos.x % CHUNK_WIDTH + CHUNK_WIDTH) % CHUNK_WIDTH,
-            pos.y,
-            (pos.z % CHUNK_WIDTH + CHUNK_WIDTH) % CHUNK_WIDTH
-        );
-
-        return it->second.GetBlock(chunk_pos);
-    }
-
 #if PROTOCOL_VERSION < 719 /* < 1.16 */
     void World::SetCurrentDimensionImpl(const Dimension dimension)
 #else
@@ -1225,14 +1435,14 @@ namespace Botcraft
 #if PROTOCOL_VERSION > 404 /* > 1.13.2 */
 #if PROTOCOL_VERSION < 719 /* < 1.16 */
     void World::UpdateChunkLight(const int x, const int z, const Dimension dim, const int light_mask, const int empty_light_mask,
-        const std::vector<std::vector<char>>& data, const bool sky)
+        std::vector<std::vector<char>>& data, const bool sky)
 #elif PROTOCOL_VERSION < 755 /* < 1.17 */
     void World::UpdateChunkLight(const int x, const int z, const std::string& dim, const int light_mask, const int empty_light_mask,
-        const std::vector<std::vector<char>>& data, const bool sky)
+        std::vector<std::vector<char>>& data, const bool sky)
 #else
     void World::UpdateChunkLight(const int x, const int z, const std::string& dim,
         const std::vector<unsigned long long int>& light_mask, const std::vector<unsigned long long int>& empty_light_mask,
-        const std::vector<std::vector<char>>& data, const bool sky)
+        std::vector<std::vector<char>>& data, const bool sky)
 #endif
     {
         auto it = terrain.find({ x, z });
@@ -1243,50 +1453,64 @@ namespace Botcraft
             return;
         }
 
-        int counter_arrays = 0;
-        Position pos1, pos2;
+        LoadLightInChunk(it->second, light_mask, empty_light_mask, data, sky);
+    }
 
-        const int num_sections = GetHeightImpl() / 16 + 2;
+#if PROTOCOL_VERSION < 755 /* < 1.17 */
+    void World::LoadLightInChunk(Chunk& chunk, const int light_mask, const int empty_light_mask,
+        std::vector<std::vector<char>>& data, const bool sky) const
+#else
+    void World::LoadLightInChunk(Chunk& chunk,
+        const std::vector<unsigned long long int>& light_mask, const std::vector<unsigned long long int>& empty_light_mask,
+        std::vector<std::vector<char>>& data, const bool sky) const
+#endif
+    {
+        if (light_policy == LightPolicy::Ignore)
+        {
+            return;
+        }
+
+        size_t counter_arrays = 0;
+
+        // One more section below and above the chunk in light data
+        const int num_sections = chunk.GetHeight() / SECTION_HEIGHT + 2;
 
         for (int i = 0; i < num_sections; ++i)
         {
-            const int section_Y = i - 1;
+            const int section_y = i - 1;
+            const bool inside_chunk = i > 0 && i < num_sections - 1;
 
-            // Sky light
 #if PROTOCOL_VERSION < 755 /* < 1.17 */
             if ((light_mask >> i) & 1)
 #else
             if ((light_mask.size() > i / 64) && (light_mask[i / 64] >> (i % 64)) & 1)
 #endif
             {
-                if (i > 0 && i < num_sections - 1)
+                if (counter_arrays >= data.size())
+                {
+                    LOG_WARNING("Missing light data for section " << section_y);
+                    return;
+                }
+                if (inside_chunk)
                 {
-                    for (int block_y = 0; block_y < SECTION_HEIGHT; ++block_y)
+                    std::vector<char>& section_data = data[counter_arrays];
+                    bool valid = true;
+                    if (light_policy == LightPolicy::Raw)
                     {
-                        pos1.y = block_y + section_Y * SECTION_HEIGHT + GetMinYImpl();
-                        pos2.y = pos1.y;
-                        for (int block_z = 0; block_z < CHUNK_WIDTH; ++block_z)
-                        {
-                            pos1.z = block_z;
-                            pos2.z = block_z;
-                            for (int block_x = 0; block_x < CHUNK_WIDTH; block_x += 2)
-                            {
-                                pos1.x = block_x;
-                                pos2.x = block_x + 1;
-                                const char two_light_values = data[counter_arrays][(block_y * CHUNK_WIDTH * CHUNK_WIDTH + block_z * CHUNK_WIDTH + block_x) / 2];
-
-                                if (sky)
-                                {
-                                    it->second.SetSkyLight(pos1, two_light_values & 0x0F);
-                                    it->second.SetSkyLight(pos2, (two_light_values >> 4) & 0x0F);
-                                }
-                                else
-                                {
-                                    it->second.SetBlockLight(pos1, two_light_values & 0x0F);
-                                    it->second.SetBlockLight(pos2, (two_light_values >> 4) & 0x0F);
-                                }
-                            }
-                        }
+                        valid = chunk.SetSectionLight(section_y, std::move(section_data), sky);
+                    }
+                    // Same layout as the network data, copy it as is unless all values are 0
+                    else if (std::any_of(section_data.begin(), section_data.end(), [](const char c) { return c != 0; }))
+                    {
+                        valid = chunk.SetSectionLight(section_y, std::vector<char>(section_data), sky);
+                    }
+                    else
+                    {
+                        valid = chunk.SetSectionLight(section_y, std::vector<char>(), sky);
+                    }
+                    if (!valid)
+                    {
+                        LOG_WARNING("Invalid light data for section " << section_y << " (size: " << data[counter_arrays].size() << ")");
                     }
                 }
                 counter_arrays++;
@@ -1297,39 +1521,60 @@ namespace Botcraft
             else if ((empty_light_mask.size() > i / 64) && (empty_light_mask[i / 64] >> (i % 64)) & 1)
 #endif
             {
-                if (i > 0 && i < num_sections - 1)
+                if (inside_chunk)
                 {
-                    for (int block_y = 0; block_y < SECTION_HEIGHT; ++block_y)
-                    {
-                        pos1.y = block_y + section_Y * SECTION_HEIGHT + GetMinYImpl();
-                        pos2.y = pos1.y;
-                        for (int block_z = 0; block_z < CHUNK_WIDTH; ++block_z)
-                        {
-                            pos1.z = block_z;
-                            pos2.z = block_z;
-                            for (int block_x = 0; block_x < CHUNK_WIDTH; block_x += 2)
-                            {
-                                pos1.x = block_x;
-                                pos2.x = block_x + 1;
-                                if (sky)
-                                {
-                                    it->second.SetSkyLight(pos1, 0);
-                                    it->second.SetSkyLight(pos2, 0);
-                                }
-                                else
-                                {
-                                    it->second.SetBlockLight(pos1, 0);
-                                    it->second.SetBlockLight(pos2, 0);
-                                }
-                            }
-                        }
-                    }
+                    chunk.SetSectionLight(section_y, std::vector<char>(), sky);
                 }
             }
         }
     }
 #endif
 
+#if PROTOCOL_VERSION > 756 /* > 1.17.1 */
+    size_t World::ComputeChunkContentHash(const ProtocolCraft::ClientboundLevelChunkWithLightPacket& msg, std::vector<unsigned char>& content)
+    {
+        const std::hash<std::string_view> bytes_hasher;
+        const std::hash<unsigned long long int> mask_hasher;
+        size_t value = 0;
+        const auto combine = [&value](const size_t h)
+        {
+            value ^= h + 0x9e3779b9 + (value << 6) + (value >> 2);
+        };
+
+        // Sections and all block entities (position, type and NBT) serialized back to back
+        const std::vector<unsigned char>& buffer = msg.GetChunkData().GetBuffer();
+        content.clear();
+        ProtocolCraft::WriteData<ProtocolCraft::VarInt>(static_cast<int>(buffer.size()), content);
+        content.insert(content.end(), buffer.begin(), buffer.end());
+        for (const ProtocolCraft::BlockEntityInfo& block_entity : msg.GetChunkData().GetBlockEntitiesData())
+        {
+            block_entity.Write(content);
+        }
+        combine(bytes_hasher(std::string_view(reinterpret_cast<const char*>(content.data()), content.size())));
+
+        const ProtocolCraft::ClientboundLightUpdatePacketData& light_data = msg.GetLightData();
+        for (const auto* masks : { &light_data.GetSkyYMask(), &light_data.GetEmptySkyYMask(), &light_data.GetBlockYMask(), &light_data.GetEmptyBlockYMask() })
+        {
+            combine(masks->size());
+            for (const unsigned long long int m : *masks)
+            {
+                combine(mask_hasher(m));
+            }
+        }
+        for (const auto* updates : { &light_data.GetSkyUpdates(), &light_data.GetBlockUpdates() })
+        {
+            combine(updates->size());
+            for (const std::vector<char>& u : *updates)
+            {
+                combine(bytes_hasher(std::string_view(u.data(), u.size())));
+            }
+        }
+
+        // 0 is used for unknown content
+        return value == 0 ? 1 : value;
+    }
+#endif
+
 #if PROTOCOL_VERSION < 719 /* < 1.16 */
     size_t World::GetDimIndex(const Dimension dim)
 #else
@@ -1345,4 +1590,25 @@ namespace Botcraft
         }
         return it->second;
     }
+#if PROTOCOL_VERSION < 719 /* < 1.16 */
+    std::string World::GetCacheDimensionName(const Dimension dim)
+    {
+        switch (dim)
+        {
+        case Dimension::Nether:
+            return "minecraft:the_nether";
+        case Dimension::Overworld:
+            return "minecraft:overworld";
+        case Dimension::End:
+            return "minecraft:the_end";
+        default:
+            return "none";
+        }
+    }
+#else
+    std::string World::GetCacheDimensionName(const std::string& dim)
+    {
+        return dim;
+    }
+#endif
 } // Botcraft
@@ -0,0 +1,111 @@
+#include <algorithm>
+
+#include "botcraft/Game/World/Chunk.hpp"
+#include "botcraft/Game/World/ChunkMap.hpp"
+#include "botcraft/Game/World/WorldView.hpp"
+#include "botcraft/Utilities/MiscUtilities.hpp"
+
+namespace Botcraft
+{
+    WorldView::WorldView(const ChunkMap& terrain_, std::shared_mutex& mutex) : lock(mutex), terrain(terrain_)
+    {
+        cached_chunk_x = 0;
+        cached_chunk_z = 0;
+        cached_chunk = nullptr;
+        has_cached_chunk = false;
+    }
+
+    WorldView::WorldView(const ChunkMap& terrain_) : terrain(terrain_)
+    {
+        cached_chunk_x = 0;
+        cached_chunk_z = 0;
+        cached_chunk = nullptr;
+        has_cached_chunk = false;
+    }
+
+    const Blockstate* WorldView::GetBlock(const Position& pos)
+    {
+        const int chunk_x = Utilities::FloorDiv(pos.x, CHUNK_WIDTH);
+        const int chunk_z = Utilities::FloorDiv(pos.z, CHUNK_WIDTH);
+
+        const Chunk* chunk = GetChunk(chunk_x, chunk_z);
+        if (chunk == nullptr)
+        {
+            return nullptr;
+        }
+
+        return chunk->GetBlock(Position(pos.x - chunk_x * CHUNK_WIDTH, pos.y, pos.z - chunk_z * CHUNK_WIDTH));
+    }
+
+    std::vector<const Blockstate*> WorldView::GetBlocks(const std::vector<Position>& pos)
+    {
+        std::vector<const Blockstate*> output(pos.size());
+        for (size_t i = 0; i < pos.size(); ++i)
+        {
+            output[i] = GetBlock(pos[i]);
+        }
+        return output;
+    }
+
+    std::vector<const Blockstate*> WorldView::GetBlocks(const Position& min, const Position& max)
+    {
+        if (max.x < min.x || max.y < min.y || max.z < min.z)
+        {
+            return {};
+        }
+
+        const Position size = max - min + Position(1, 1, 1);
+        std::vector<const Blockstate*> output(static_cast<size_t>(size.x) * size.y * size.z, nullptr);
+
+        // Process the box one chunk column at a time, so each chunk is searched only once
+        for (int chunk_z = Utilities::FloorDiv(min.z, CHUNK_WIDTH); chunk_z <= Utilities::FloorDiv(max.z, CHUNK_WIDTH); ++chunk_z)
+        {
+            for (int chunk_x = Utilities::FloorDiv(min.x, CHUNK_WIDTH); chunk_x <= Utilities::FloorDiv(max.x, CHUNK_WIDTH); ++chunk_x)
+            {
+                const Chunk* chunk = GetChunk(chunk_x, chunk_z);
+                if (chunk == nullptr)
+                {
+                    continue;
+                }
+
+                const int start_x = std::max(min.x, chunk_x * CHUNK_WIDTH);
+                const int end_x = std::min(max.x, chunk_x * CHUNK_WIDTH + CHUNK_WIDTH - 1);
+                const int start_z = std::max(min.z, chunk_z * CHUNK_WIDTH);
+                const int end_z = std::min(max.z, chunk_z * CHUNK_WIDTH + CHUNK_WIDTH - 1);
+                const int start_y = std::max(min.y, chunk->GetMinY());
+                const int end_y = std::min(max.y, chunk->GetMinY() + chunk->GetHeight() - 1);
+
+                Position chunk_pos;
+                for (int y = start_y; y <= end_y; ++y)
+                {
+                    chunk_pos.y = y;
+                    for (int z = start_z; z <= end_z; ++z)
+                    {
+                        chunk_pos.z = z - chunk_z * CHUNK_WIDTH;
+                        size_t index = (static_cast<size_t>(y - min.y) * size.z + (z - min.z)) * size.x + (start_x - min.x);
+                        for (int x = start_x; x <= end_x; ++x)
+                        {
+                            chunk_pos.x = x - chunk_x * CHUNK_WIDTH;
+                            output[index++] = chunk->GetBlock(chunk_pos);
+                        }
+                    }
+                }
+            }
+        }
+
+        return output;
+    }
+
+    const Chunk* WorldView::GetChunk(const int x, const int z)
+    {
+        if (!has_cached_chunk || cached_chunk_x != x || cached_chunk_z != z)
+        {
+            const auto it = terrain.find({ x, z });
+            cached_chunk = it == terrain.end() ? nullptr : &it->second;
+            cached_chunk_x = x;
+            cached_chunk_z = z;
+            has_cached_chunk = true;
+        }
+        return cached_chunk;
+    }
+} // Botcraft
@@ -8,6 +8,7 @@
 
 #include <random>
 #include <chrono>
+#include <stdexcept>
 
 #if PROTOCOL_VERSION > 758 /* > 1.18.2 */
 #include <openssl/pem.h>
@@ -113,49 +114,70 @@ namespace Botcraft
 #endif
         RSA_free(rsa);
 
+        InitContexts(raw_shared_secret);
+    }
+
+    void AESEncrypter::InitContexts(const std::vector<unsigned char>& shared_secret)
+    {
+        if (shared_secret.size() != AES_BLOCK_SIZE)
+        {
+            throw std::runtime_error("Invalid AES shared secret size");
+        }
+
+        if (encryption_context != nullptr)
+        {
+            EVP_CIPHER_CTX_free(encryption_context);
+        }
         encryption_context = EVP_CIPHER_CTX_new();
-        EVP_EncryptInit_ex(encryption_context, EVP_aes_128_cfb8(), nullptr, raw_shared_secret.data(), raw_shared_secret.data());
+        EVP_EncryptInit_ex(encryption_context, EVP_aes_128_cfb8(), nullptr, shared_secret.data(), shared_secret.data());
 
+        if (decryption_context != nullptr)
+        {
+            EVP_CIPHER_CTX_free(decryption_context);
+        }
         decryption_context = EVP_CIPHER_CTX_new();
-        EVP_DecryptInit_ex(decryption_context, EVP_aes_128_cfb8(), nullptr, raw_shared_secret.data(), raw_shared_secret.data());
+        EVP_DecryptInit_ex(decryption_context, EVP_aes_128_cfb8(), nullptr, shared_secret.data(), shared_secret.data());
 
         blocksize = EVP_CIPHER_block_size(EVP_aes_128_cfb8());
     }
 
     std::vector<unsigned char> AESEncrypter::Encrypt(const std::vector<unsigned char>& in)
+    {
+        std::vector<unsigned char> output = in;
+        Encrypt(output.data(), output.size());
+        return output;
+    }
+
+    std::vector<unsigned char> AESEncrypter::Decrypt(const std::vector<unsigned char>& in)
+    {
+        std::vector<unsigned char> output = in;
+        Decrypt(output.data(), output.size());
+        return output;
+    }
+
+    void AESEncrypter::Encrypt(unsigned char* data, const size_t size)
     {
         if (encryption_context == nullptr)
         {
             LOG_WARNING("Warning, trying to encrypt packet while encryption is not initialized yet");
-            return in;
+            return;
         }
 
-        std::vector<unsigned char> output;
-        int size = 0;
-
-        output.resize(in.size() + blocksize);
-        EVP_EncryptUpdate(encryption_context, output.data(), &size, in.data(), static_cast<int>(in.size()));
-        output.resize(size);
-
-        return output;
+        // CFB8 is a stream mode, output has the same size as input, so it can be done in place
+        int output_size = 0;
+        EVP_EncryptUpdate(encryption_context, data, &output_size, data, static_cast<int>(size));
     }
 
-    std::vector<unsigned char> AESEncrypter::Decrypt(const std::vector<unsigned char>& in)
+    void AESEncrypter::Decrypt(unsigned char* data, const size_t size)
     {
         if (decryption_context == nullptr)
         {
             LOG_WARNING("Warning, trying to decrypt packet while decryption is not initialized yet");
-            return in;
+            return;
         }
 
-        std::vector<unsigned char> output;
-        int size = 0;
-
-        output.resize(in.size() + blocksize);
-        EVP_DecryptUpdate(decryption_context, output.data(), &size, in.data(), static_cast<int>(in.size()));
-        output.resize(size);
-
-        return output;
+        int output_size = 0;
+        EVP_DecryptUpdate(decryption_context, data, &output_size, data, static_cast<int>(size));
     }
 }
 #endif // USE_ENCRYPTION
@@ -3,83 +3,118 @@
 #ifdef USE_COMPRESSION
 #include <zlib.h>
 #include <string>
-#include <cstring>
 #include <stdexcept>
 
 namespace Botcraft
 {
     const unsigned long MAX_COMPRESSED_PACKET_LEN = 200 * 1024;
 
-    std::vector<unsigned char> Compress(const std::vector<unsigned char>& raw)
+    CompressionContext::CompressionContext(const int compression_level_) : compression_level(compression_level_)
     {
-        unsigned long size_to_compress = static_cast<unsigned long>(raw.size());
-        unsigned long compressed_size = compressBound(size_to_compress);
+        if (compression_level < Z_DEFAULT_COMPRESSION || compression_level > Z_BEST_COMPRESSION)
+        {
+            throw std::runtime_error("Invalid compression level: " + std::to_string(compression_level));
+        }
+
+        inflate_stream = new z_stream{};
+        if (inflateInit(inflate_stream) != Z_OK)
+        {
+            const std::string msg = inflate_stream->msg != nullptr ? inflate_stream->msg : "";
+            delete inflate_stream;
+            throw std::runtime_error("inflateInit failed: " + msg);
+        }
+
+        deflate_stream = new z_stream{};
+        if (deflateInit(deflate_stream, compression_level) != Z_OK)
+        {
+            const std::string msg = deflate_stream->msg != nullptr ? deflate_stream->msg : "";
+            inflateEnd(inflate_stream);
+            delete inflate_stream;
+            delete deflate_stream;
+            throw std::runtime_error("deflateInit failed: " + msg);
+        }
+    }
+
+    CompressionContext::~CompressionContext()
+    {
+        inflateEnd(inflate_stream);
+        delete inflate_stream;
+        deflateEnd(deflate_stream);
+        delete deflate_stream;
+    }
+
+    void CompressionContext::Compress(const unsigned char* raw, const size_t raw_size, std::vector<unsigned char>& compressed)
+    {
+        const unsigned long compressed_bound = deflateBound(deflate_stream, static_cast<unsigned long>(raw_size));
 
-        if (compressed_size > MAX_COMPRESSED_PACKET_LEN)
+        if (compressed_bound > MAX_COMPRESSED_PACKET_LEN)
         {
             throw std::runtime_error("Incoming packet is too big");
         }
 
-        std::vector<unsigned char> compressed_data(compressed_size);
-        int status = compress2(compressed_data.data(), &compressed_size, raw.data(), size_to_compress, Z_DEFAULT_COMPRESSION);
+        const size_t start = compressed.size();
+        compressed.resize(start + compressed_bound);
 
-        if (status != Z_OK)
+        deflateReset(deflate_stream);
+        deflate_stream->next_in = const_cast<unsigned char*>(raw);
+        deflate_stream->avail_in = static_cast<unsigned int>(raw_size);
+        deflate_stream->next_out = compressed.data() + start;
+        deflate_stream->avail_out = static_cast<unsigned int>(compressed_bound);
+
+        // Output buffer is big enough for everything, so one call is enough
+        if (deflate(deflate_stream, Z_FINISH) != Z_STREAM_END)
         {
+            compressed.resize(start);
             throw std::runtime_error("Error compressing packet");
         }
 
-        compressed_data.resize(compressed_size);
-        return compressed_data;
+        compressed.resize(start + deflate_stream->total_out);
     }
 
-    std::vector<unsigned char> Decompress(const std::vector<unsigned char>& compressed, const int start)
+    void CompressionContext::Decompress(const unsigned char* compressed, const size_t compressed_size, std::vector<unsigned char>& decompressed)
     {
-        unsigned long size_to_decompress = static_cast<unsigned long>(compressed.size() - start);
-
-        std::vector<unsigned char> decompressed_data;
-        decompressed_data.reserve(size_to_decompress);
+        inflateReset(inflate_stream);
+        inflate_stream->next_in = const_cast<unsigned char*>(compressed);
+        inflate_stream->avail_in = static_cast<unsigned int>(compressed_size);
+        inflate_stream->next_out = decompressed.data();
+        inflate_stream->avail_out = static_cast<unsigned int>(decompressed.size());
 
-        std::vector<unsigned char> buffer(64 * 1024);
+        // Output size is known, so everything can be inflated in one call
+        const int res = inflate(inflate_stream, Z_FINISH);
 
-        z_stream strm;
-        memset(&strm, 0, sizeof(strm));
-        strm.next_in = const_cast<unsigned char*>(compressed.data() + start);
-        strm.avail_in = size_to_decompress;
-        strm.next_out = buffer.data();
-        strm.avail_out = static_cast<unsigned int>(buffer.size());
+        if (res != Z_STREAM_END)
+        {
+            throw std::runtime_error("Inflate decompression failed: " + std::string(inflate_stream->msg != nullptr ? inflate_stream->msg : "output size mismatch"));
+        }
+        if (inflate_stream->avail_out != 0)
+        {
+            throw std::runtime_error("Inflate decompression failed: decompressed data is smaller than expected");
+        }
+    }
 
-        int res = inflateInit(&strm);
-        if (res != Z_OK)
+    void CompressionContext::SetCompressionLevel(const int compression_level_)
+    {
+        if (compression_level_ < Z_DEFAULT_COMPRESSION || compression_level_ > Z_BEST_COMPRESSION)
+        {
+            throw std::runtime_error("Invalid compression level: " + std::to_string(compression_level_));
+        }
+        if (compression_level_ == compression_level)
         {
-            throw std::runtime_error("inflateInit failed: " + std::string(strm.msg));
+            return;
         }
 
-        for (;;)
+        // Stream is always reset before use, so it's safe to change params here
+        deflateReset(deflate_stream);
+        if (deflateParams(deflate_stream, compression_level_, Z_DEFAULT_STRATEGY) != Z_OK)
         {
-            res = inflate(&strm, Z_NO_FLUSH);
-            switch (res)
-            {
-            case Z_OK:
-                decompressed_data.insert(decompressed_data.end(), buffer.begin(), buffer.end() - strm.avail_out);
-                strm.next_out = buffer.data();
-                strm.avail_out = static_cast<unsigned int>(buffer.size());
-                if (strm.avail_in == 0)
-                {
-                    inflateEnd(&strm);
-                    return decompressed_data;
-                }
-                break;
-            case Z_STREAM_END:
-                decompressed_data.insert(decompressed_data.end(), buffer.begin(), buffer.end() - strm.avail_out);
-                inflateEnd(&strm);
-                return decompressed_data;
-                break;
-            default:
-                inflateEnd(&strm);
-                throw std::runtime_error("Inflate decompression failed: " + std::string(strm.msg));
-                break;
-            }
+            throw std::runtime_error("Error setting compression level to " + std::to_string(compression_level_));
         }
+        compression_level = compression_level_;
+    }
+
+    int CompressionContext::GetCompressionLevel() const
+    {
+        return compression_level;
     }
 } //Botcraft
 #endif
@@ -21,7 +21,10 @@ using namespace ProtocolCraft;
 
 namespace Botcraft
 {
-    NetworkManager::NetworkManager(const std::string& address, const std::string& login, const bool force_microsoft_auth)
+    /// @brief Max uncompressed size of a packet, bigger ones are rejected by vanilla too
+    static constexpr int max_uncompressed_length = 1 << 23;
+
+    NetworkManager::NetworkManager(const std::string& address, const std::string& login, const bool force_microsoft_auth, const std::shared_ptr<NetworkThreadPool>& network_thread_pool)
     {
         com = nullptr;
 
@@ -43,14 +46,14 @@ namespace Botcraft
         }
 
         compression = -1;
-        AddHandler(this);
+        AddHandler(this, HANDLED_PACKETS_FILTER(NetworkManager));
 
         state = ConnectionState::Handshake;
 
         //Start the thread to process the incoming packets
         m_thread_process = std::thread(&NetworkManager::WaitForNewPackets, this);
 
-        com = std::make_shared<TCP_Com>(address, std::bind(&NetworkManager::OnNewRawData, this, std::placeholders::_1));
+        com = std::make_shared<TCP_Com>(address, std::bind(&NetworkManager::OnNewRawData, this, std::placeholders::_1, std::placeholders::_2), network_thread_pool);
 
         //Let some time to initialize the communication before actually send data
         // TODO: make this in a cleaner way?
@@ -110,20 +113,37 @@ namespace Botcraft
             com->close();
         }
 
+        {
+            // Make sure the state change can't be missed by a thread about to wait
+            std::lock_guard<std::mutex> lck(mutex_process);
+        }
         process_condition.notify_all();
+        queue_space_condition.notify_all();
 
         if (m_thread_process.joinable())
         {
             m_thread_process.join();
         }
-        compression = -1;
+        {
+            std::lock_guard<std::mutex> lock(mutex_send);
+            compression = -1;
+            compression_context.reset();
+        }
 
         com.reset();
     }
 
     void NetworkManager::AddHandler(Handler* h)
     {
-        subscribed.push_back(h);
+        AddHandler(h, PacketFilter::All());
+    }
+
+    void NetworkManager::AddHandler(Handler* h, const PacketFilter& filter)
+    {
+        std::scoped_lock<std::mutex> lock(mutex_handlers);
+        subscribed.push_back({ h, filter });
+        // Subscribers will be computed again on next packets
+        interested_handlers.clear();
     }
 
     void NetworkManager::Send(const std::shared_ptr<Message> msg)
@@ -149,8 +169,7 @@ namespace Botcraft
                 {
                     std::vector<unsigned char> compressed_msg;
                     WriteData<VarInt>(static_cast<int>(msg_data.size()), compressed_msg);
-                    std::vector<unsigned char> compressed_data = Compress(msg_data);
-                    compressed_msg.insert(compressed_msg.end(), compressed_data.begin(), compressed_data.end());
+                    compression_context->Compress(msg_data.data(), msg_data.size(), compressed_msg);
                     com->SendPacket(compressed_msg);
                 }
 #else
@@ -275,6 +294,27 @@ namespace Botcraft
         return m_thread_process.get_id();
     }
 
+    void NetworkManager::SetCompressionLevel(const int level)
+    {
+        if (level < -1 || level > 9)
+        {
+            throw std::runtime_error("Invalid compression level: " + std::to_string(level));
+        }
+        std::lock_guard<std::mutex> lock(mutex_send);
+        compression_level = level;
+#ifdef USE_COMPRESSION
+        if (compression_context)
+        {
+            compression_context->SetCompressionLevel(level);
+        }
+#endif
+    }
+
+    const PacketBufferPool& NetworkManager::GetPacketBufferPool() const
+    {
+        return packet_buffer_pool;
+    }
+
     void NetworkManager::WaitForNewPackets()
     {
         Logger::GetInstance().RegisterThread("NetworkPacketProcessing - " + name);
@@ -282,55 +322,59 @@ namespace Botcraft
         {
             while (state != ConnectionState::None)
             {
+                std::vector<unsigned char> packet;
+                if (!PopPacket(packet))
                 {
                     std::unique_lock<std::mutex> lck(mutex_process);
-                    process_condition.wait(lck);
+                    processing_thread_waiting = true;
+                    // Pairs with the fence in OnNewRawData, either the network
+                    // thread sees the flag, or we see the pushed packet
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    process_condition.wait(lck, [this]() { return !packets_to_process.Empty() || overflow_size > 0 || state == ConnectionState::None; });
+                    processing_thread_waiting = false;
+                    continue;
                 }
-                while (!packets_to_process.empty())
+                if (packet.size() > 0)
                 {
-                    std::vector<unsigned char> packet;
-                    { // process_guard scope
-                        std::lock_guard<std::mutex> process_guard(mutex_process);
-                        if (!packets_to_process.empty())
-                        {
-                            packet = packets_to_process.front();
-                            packets_to_process.pop();
-                        }
+                    if (compression == -1)
+                    {
+                        ProcessPacket(packet.begin(), packet.size());
                     }
-                    if (packet.size() > 0)
+                    else
                     {
-                        if (compression == -1)
+#ifdef USE_COMPRESSION
+                        size_t length = packet.size();
+                        ReadIterator iter = packet.begin();
+                        const int data_length = ReadData<VarInt>(iter, length);
+
+                        //Packet not compressed
+                        if (data_length == 0)
+                        {
+                            ProcessPacket(iter, length);
+                        }
+                        //Packet compressed
+                        else if (data_length > max_uncompressed_length)
+                        {
+                            throw std::runtime_error("Uncompressed packet length is above " + std::to_string(max_uncompressed_length));
+                        }
+                        else if (data_length > 0)
                         {
-                            ProcessPacket(packet);
+                            std::vector<unsigned char> uncompressed_msg = packet_buffer_pool.Acquire(data_length);
+                            uncompressed_msg.resize(data_length);
+                            compression_context->Decompress(&*iter, length, uncompressed_msg);
+                            ProcessPacket(uncompressed_msg.begin(), uncompressed_msg.size());
+                            packet_buffer_pool.Release(std::move(uncompressed_msg));
                         }
                         else
                         {
-#ifdef USE_COMPRESSION
-                            size_t length = packet.size();
-                            ReadIterator iter = packet.begin();
-                            int data_length = ReadData<VarInt>(iter, length);
-
-                            //Packet not compressed
-                            if (data_length == 0)
-                            {
-                                //Erase the first 0
-                                packet.erase(packet.begin());
-                                ProcessPacket(packet);
-                            }
-                            //Packet compressed
-                            else
-                            {
-                                const int size_varint = static_cast<int>(packet.size() - length);
-
-                                std::vector<unsigned char> uncompressed_msg = Decompress(packet, size_varint);
-                                ProcessPacket(uncompressed_msg);
-                            }
+                            throw std::runtime_error("Invalid negative uncompressed packet length");
+                        }
 #else
-                            throw std::runtime_error("Program compiled without USE_COMPRESSION. Cannot read compressed message");
+                        throw std::runtime_error("Program compiled without USE_COMPRESSION. Cannot read compressed message");
 #endif
-                        }
                     }
                 }
+                packet_buffer_pool.Release(std::move(packet));
             }
         }
         catch (const std::exception& e)
@@ -345,46 +389,228 @@ namespace Botcraft
         }
     }
 
-    void NetworkManager::ProcessPacket(const std::vector<unsigned char>& packet)
+    void NetworkManager::ProcessPacket(ReadIterator packet_iterator, size_t length)
     {
-        if (packet.empty())
+        if (length == 0)
         {
             return;
         }
 
-        std::vector<unsigned char>::const_iterator packet_iterator = packet.begin();
-        size_t length = packet.size();
-
         const int packet_id = ReadData<VarInt>(packet_iterator, length);
 
-        std::shared_ptr<Message> msg = CreateClientboundMessage(state, packet_id);
+        bool light_data = true;
+        {
+            // Copy the handlers so the lock is not held during dispatch,
+            // as handlers can register new handlers
+            std::scoped_lock<std::mutex> lock(mutex_handlers);
+            const InterestedHandlers& interested = GetInterestedHandlers(state, packet_id);
+            dispatch_handlers.assign(interested.handlers.begin(), interested.handlers.end());
+            light_data = interested.light_data;
+        }
+
+        if (dispatch_handlers.empty() && skip_unhandled_packets)
+        {
+            return;
+        }
+
+        std::shared_ptr<Message> msg = message_pool.CreateClientboundMessage(state, packet_id);
 
         if (msg)
         {
-            msg->Read(packet_iterator, length);
-            for (int i = 0; i < subscribed.size(); i++)
+#if PROTOCOL_VERSION > 756 /* > 1.17.1 */
+            // Always set, as pooled messages keep the value from their previous use
+            if (state == ConnectionState::Play && packet_id == ClientboundLevelChunkWithLightPacket::packet_id)
+            {
+                std::static_pointer_cast<ClientboundLevelChunkWithLightPacket>(msg)->SetSkipLightData(!light_data);
+            }
+#endif
+            if (lazy_parsing)
             {
-                msg->Dispatch(subscribed[i]);
+                msg->ReadLazy(packet_iterator, length);
+            }
+            else
+            {
+                msg->Read(packet_iterator, length);
+            }
+            try
+            {
+                for (int i = 0; i < dispatch_handlers.size(); i++)
+                {
+                    msg->Dispatch(dispatch_handlers[i]);
+                }
+            }
+            catch (const std::exception& e)
+            {
+                // Lazily read messages are parsed by the handlers, report it as a parsing error
+                if (!msg->IsParsed())
+                {
+                    LOG_FATAL("Exception while parsing " << msg->GetName() << ": " << e.what());
+                }
+                throw;
             }
         }
     }
+
+    const NetworkManager::InterestedHandlers& NetworkManager::GetInterestedHandlers(const ConnectionState state, const int packet_id)
+    {
+        static const InterestedHandlers no_handler;
+
+        // Way above any valid packet id, unknown packets can't be created anyway
+        // so there is no need to grow the cache if the server sends garbage
+        constexpr int max_packet_id = 0xFF;
+
+        const int state_index = static_cast<int>(state);
+        if (state_index < 0 || packet_id < 0 || packet_id > max_packet_id)
+        {
+            return no_handler;
+        }
+
+        if (interested_handlers.size() <= state_index)
+        {
+            interested_handlers.resize(state_index + 1);
+        }
+        if (interested_handlers[state_index].size() <= packet_id)
+        {
+            interested_handlers[state_index].resize(packet_id + 1);
+        }
+
+        InterestedHandlers& output = interested_handlers[state_index][packet_id];
+        if (!output.valid)
+        {
+            output.handlers.clear();
+            output.light_data = false;
+            for (const HandlerRegistration& registration : subscribed)
+            {
+                if (registration.filter.Contains(state, packet_id))
+                {
+                    output.handlers.push_back(registration.handler);
+                    output.light_data |= !registration.filter.GetSkipLightData();
+                }
+            }
+            output.valid = true;
+        }
+
+        return output;
+    }
     
-    void NetworkManager::OnNewRawData(const std::vector<unsigned char>& packet)
+    void NetworkManager::OnNewRawData(const unsigned char* data, const size_t length)
     {
+        std::vector<unsigned char> packet = packet_buffer_pool.Acquire(length);
+        packet.assign(data, data + length);
+
+        // Fast path, lock-free
+        if (overflow_size == 0 && packets_to_process.TryPush(std::move(packet)))
         {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (processing_thread_waiting)
+            {
+                {
+                    std::lock_guard<std::mutex> lck(mutex_process);
+                }
+                process_condition.notify_one();
+                num_queue_wakeups += 1;
+            }
+        }
+        // Queue is full (or already overflowed, and packets must stay in order)
+        else
+        {
+            num_queue_full += 1;
             std::unique_lock<std::mutex> lck(mutex_process);
-            packets_to_process.push(packet);
+            if (packet_queue_policy == PacketQueuePolicy::Block && overflow_size == 0)
+            {
+                network_thread_waiting = true;
+                // Pairs with the fence in PopPacket
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                queue_space_condition.wait(lck, [this]() { return packets_to_process.Size() < packets_to_process.Capacity() || state == ConnectionState::None; });
+                network_thread_waiting = false;
+                if (state == ConnectionState::None)
+                {
+                    return;
+                }
+                packets_to_process.TryPush(std::move(packet));
+            }
+            else
+            {
+                overflow_packets.push_back(std::move(packet));
+                overflow_size += 1;
+            }
+            lck.unlock();
+            process_condition.notify_one();
+            num_queue_wakeups += 1;
+        }
+
+        num_queue_packets += 1;
+        const size_t depth = packets_to_process.Size() + overflow_size;
+        if (depth > max_queue_depth)
+        {
+            max_queue_depth = depth;
         }
-        process_condition.notify_all();
     }
 
-    void NetworkManager::Handle(Message& msg)
+    bool NetworkManager::PopPacket(std::vector<unsigned char>& packet)
     {
+        if (!packets_to_process.TryPop(packet))
+        {
+            // Overflowed packets are always more recent than the ones
+            // in the ring, so they are only used once it's empty
+            if (overflow_size == 0)
+            {
+                return false;
+            }
+            std::lock_guard<std::mutex> lck(mutex_process);
+            packet = std::move(overflow_packets.front());
+            overflow_packets.pop_front();
+            overflow_size -= 1;
+            return true;
+        }
 
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (network_thread_waiting)
+        {
+            {
+                std::lock_guard<std::mutex> lck(mutex_process);
+            }
+            queue_space_condition.notify_one();
+        }
+        return true;
+    }
+
+    void NetworkManager::SetPacketQueuePolicy(const PacketQueuePolicy policy)
+    {
+        packet_queue_policy = policy;
+    }
+
+    PacketQueueMetrics NetworkManager::GetPacketQueueMetrics() const
+    {
+        PacketQueueMetrics output;
+        output.capacity = packets_to_process.Capacity();
+        output.depth = packets_to_process.Size() + overflow_size;
+        output.max_depth = max_queue_depth;
+        output.num_packets = num_queue_packets;
+        output.num_full = num_queue_full;
+        output.num_wakeups = num_queue_wakeups;
+        return output;
+    }
+
+    void NetworkManager::SetSkipUnhandledPackets(const bool skip)
+    {
+        skip_unhandled_packets = skip;
+    }
+
+    void NetworkManager::SetLazyParsing(const bool lazy)
+    {
+        lazy_parsing = lazy;
     }
 
     void NetworkManager::Handle(ClientboundLoginCompressionPacket& msg)
     {
+        std::lock_guard<std::mutex> lock(mutex_send);
+#ifdef USE_COMPRESSION
+        if (msg.GetCompressionThreshold() >= 0 && compression_context == nullptr)
+        {
+            compression_context = std::make_shared<CompressionContext>(compression_level);
+        }
+#endif
         compression = msg.GetCompressionThreshold();
     }
 
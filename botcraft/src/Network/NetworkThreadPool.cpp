@@ -0,0 +1,89 @@
+#include <algorithm>
+#include <string>
+
+#include "botcraft/Network/NetworkThreadPool.hpp"
+#include "botcraft/Network/NetworkThreadPoolIOContext.hpp"
+
+#include "botcraft/Utilities/Logger.hpp"
+
+namespace Botcraft
+{
+    NetworkThreadPool::NetworkThreadPool(const unsigned int num_threads)
+    {
+        const unsigned int thread_count = num_threads != 0 ? num_threads : std::max(1u, std::thread::hardware_concurrency());
+
+        io_contexts.reserve(thread_count);
+        threads.reserve(thread_count);
+        // One io_context per thread, so all handlers of a given
+        // connection are always executed sequentially on the same thread
+        for (unsigned int i = 0; i < thread_count; ++i)
+        {
+            io_contexts.push_back(std::make_unique<IOContext>());
+        }
+        for (unsigned int i = 0; i < thread_count; ++i)
+        {
+            IOContext* context = io_contexts[i].get();
+            threads.emplace_back([context, i]()
+                {
+                    Logger::GetInstance().RegisterThread("NetworkIOService - " + std::to_string(i));
+                    context->io_context.run();
+                    Logger::GetInstance().UnregisterThread(std::this_thread::get_id());
+                });
+        }
+        LOG_INFO("Network thread pool started with " << thread_count << " thread" << (thread_count > 1 ? "s" : ""));
+    }
+
+    NetworkThreadPool::~NetworkThreadPool()
+    {
+        for (auto& c : io_contexts)
+        {
+            c->work_guard.reset();
+            c->io_context.stop();
+        }
+
+        for (auto& t : threads)
+        {
+            if (t.joinable())
+            {
+                t.join();
+            }
+        }
+    }
+
+    unsigned int NetworkThreadPool::GetNumThreads() const
+    {
+        return static_cast<unsigned int>(threads.size());
+    }
+
+    unsigned int NetworkThreadPool::GetNumConnections() const
+    {
+        std::scoped_lock<std::mutex> lock(mutex_contexts);
+        unsigned int output = 0;
+        for (const auto& c : io_contexts)
+        {
+            output += c->num_connections;
+        }
+        return output;
+    }
+
+    NetworkThreadPool::IOContext& NetworkThreadPool::AcquireIOContext()
+    {
+        std::scoped_lock<std::mutex> lock(mutex_contexts);
+        IOContext* least_used = io_contexts[0].get();
+        for (size_t i = 1; i < io_contexts.size(); ++i)
+        {
+            if (io_contexts[i]->num_connections < least_used->num_connections)
+            {
+                least_used = io_contexts[i].get();
+            }
+        }
+        least_used->num_connections += 1;
+        return *least_used;
+    }
+
+    void NetworkThreadPool::ReleaseIOContext(IOContext& context)
+    {
+        std::scoped_lock<std::mutex> lock(mutex_contexts);
+        context.num_connections -= 1;
+    }
+} // Botcraft
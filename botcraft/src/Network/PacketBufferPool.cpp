@@ -0,0 +1,72 @@
+#include "botcraft/Network/PacketBufferPool.hpp"
+
+namespace Botcraft
+{
+    PacketBufferPool::PacketBufferPool(const size_t max_pooled_buffers, const size_t max_pooled_capacity) :
+        max_pooled_buffers(max_pooled_buffers), max_pooled_capacity(max_pooled_capacity)
+    {
+        // Reserve now so Release never has to grow the storage
+        buffers.reserve(max_pooled_buffers);
+        num_allocations = 0;
+        num_acquired = 0;
+    }
+
+    std::vector<unsigned char> PacketBufferPool::Acquire(const size_t min_capacity)
+    {
+        std::vector<unsigned char> output;
+        bool allocate = false;
+        {
+            std::scoped_lock<std::mutex> lock(mutex_buffers);
+            num_acquired += 1;
+            if (!buffers.empty())
+            {
+                // Buffers are recycled LIFO, the last released
+                // one is the most likely to still be in cache
+                output = std::move(buffers.back());
+                buffers.pop_back();
+            }
+            allocate = output.capacity() < min_capacity;
+            num_allocations += allocate;
+        }
+
+        if (allocate)
+        {
+            output.reserve(min_capacity);
+        }
+
+        return output;
+    }
+
+    void PacketBufferPool::Release(std::vector<unsigned char>&& buffer)
+    {
+        buffer.clear();
+        if (buffer.capacity() == 0 || buffer.capacity() > max_pooled_capacity)
+        {
+            return;
+        }
+
+        std::scoped_lock<std::mutex> lock(mutex_buffers);
+        if (buffers.size() < max_pooled_buffers)
+        {
+            buffers.push_back(std::move(buffer));
+        }
+    }
+
+    size_t PacketBufferPool::GetNumAllocations() const
+    {
+        std::scoped_lock<std::mutex> lock(mutex_buffers);
+        return num_allocations;
+    }
+
+    size_t PacketBufferPool::GetNumAcquired() const
+    {
+        std::scoped_lock<std::mutex> lock(mutex_buffers);
+        return num_acquired;
+    }
+
+    size_t PacketBufferPool::GetNumPooled() const
+    {
+        std::scoped_lock<std::mutex> lock(mutex_buffers);
+        return buffers.size();
+    }
+} // Botcraft
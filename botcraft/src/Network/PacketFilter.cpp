@@ -0,0 +1,97 @@
+#include "botcraft/Network/PacketFilter.hpp"
+
+using namespace ProtocolCraft;
+
+namespace Botcraft
+{
+    PacketFilter::PacketFilter()
+    {
+        all = false;
+        skip_light_data = false;
+    }
+
+    PacketFilter PacketFilter::All()
+    {
+        PacketFilter output;
+        output.all = true;
+        return output;
+    }
+
+    void PacketFilter::Add(const ConnectionState state, const int packet_id)
+    {
+        const int state_index = static_cast<int>(state);
+        if (state_index < 0 || packet_id < 0)
+        {
+            return;
+        }
+
+        if (packets.size() <= state_index)
+        {
+            packets.resize(state_index + 1);
+        }
+        if (packets[state_index].size() <= packet_id)
+        {
+            packets[state_index].resize(packet_id + 1, false);
+        }
+        packets[state_index][packet_id] = true;
+    }
+
+    void PacketFilter::Remove(const ConnectionState state, const int packet_id)
+    {
+        const int state_index = static_cast<int>(state);
+        if (state_index < 0 || packet_id < 0 ||
+            state_index >= packets.size() ||
+            packet_id >= packets[state_index].size())
+        {
+            return;
+        }
+        packets[state_index][packet_id] = false;
+    }
+
+    void PacketFilter::SetSkipLightData(const bool skip_light_data_)
+    {
+        skip_light_data = skip_light_data_;
+    }
+
+    bool PacketFilter::GetSkipLightData() const
+    {
+        return skip_light_data;
+    }
+
+    PacketFilter& PacketFilter::operator|=(const PacketFilter& other)
+    {
+        all |= other.all;
+        // Light is needed as soon as one of the filters needs it
+        skip_light_data &= other.skip_light_data;
+        for (size_t state_index = 0; state_index < other.packets.size(); ++state_index)
+        {
+            for (size_t packet_id = 0; packet_id < other.packets[state_index].size(); ++packet_id)
+            {
+                if (other.packets[state_index][packet_id])
+                {
+                    Add(static_cast<ConnectionState>(state_index), static_cast<int>(packet_id));
+                }
+            }
+        }
+        return *this;
+    }
+
+    bool PacketFilter::Contains(const ConnectionState state, const int packet_id) const
+    {
+        if (all)
+        {
+            return true;
+        }
+
+        const int state_index = static_cast<int>(state);
+        return state_index >= 0 && packet_id >= 0 &&
+            state_index < packets.size() &&
+            packet_id < packets[state_index].size() &&
+            packets[state_index][packet_id];
+    }
+
+    bool PacketFilter::IsAll() const
+    {
+        return all;
+    }
+} // Botcraft
@@ -1,5 +1,8 @@
+#include <cstring>
 #include <functional>
+#include <string>
 #include <asio/connect.hpp>
+#include <asio/post.hpp>
 #include <asio/write.hpp>
 #include <asio/ip/udp.hpp>
 
@@ -8,6 +11,7 @@
 #include "botcraft/Network/DNS/DNSMessage.hpp"
 #include "botcraft/Network/DNS/DNSSrvData.hpp"
 #include "botcraft/Network/TCP_Com.hpp"
+#include "botcraft/Network/NetworkThreadPoolIOContext.hpp"
 #ifdef USE_ENCRYPTION
 #include "botcraft/Network/AESEncrypter.hpp"
 #endif
@@ -17,24 +21,81 @@
 
 namespace Botcraft
 {
+    /// @brief Max length of a packet, the length is sent as a VarInt of at most 3 bytes
+    static constexpr int max_packet_length = (1 << 21) - 1;
+
+    /// @brief Read a VarInt packet length directly from raw bytes
+    /// @param data Pointer to the start of the VarInt
+    /// @param available Number of bytes available after data
+    /// @param length Output packet length, never above max_packet_length
+    /// @return Number of bytes used by the VarInt, 0 if not enough data is available to read it
+    static size_t ReadFrameLength(const unsigned char* data, const size_t available, int& length)
+    {
+        unsigned int value = 0;
+        for (size_t i = 0; i < 3; ++i)
+        {
+            if (i == available)
+            {
+                return 0;
+            }
+            value |= static_cast<unsigned int>(data[i] & 0x7F) << (7 * i);
+            if ((data[i] & 0x80) == 0)
+            {
+                length = static_cast<int>(value);
+                return i + 1;
+            }
+        }
+        // Don't allocate whatever size the peer announces
+        throw std::runtime_error("Packet length is above " + std::to_string(max_packet_length));
+    }
+
+    template<typename Handler>
+    auto TCP_Com::TrackHandler(Handler&& handler)
+    {
+        {
+            std::scoped_lock<std::mutex> lock(mutex_pending_handlers);
+            pending_handlers += 1;
+        }
+        return [this, handler = std::forward<Handler>(handler)](auto&&... args) mutable
+        {
+            handler(std::forward<decltype(args)>(args)...);
+            std::scoped_lock<std::mutex> lock(mutex_pending_handlers);
+            pending_handlers -= 1;
+            pending_handlers_condition.notify_all();
+        };
+    }
+
     TCP_Com::TCP_Com(const std::string& address,
-        std::function<void(const std::vector<unsigned char>&)> callback)
-        : socket(io_service)
+        std::function<void(const unsigned char*, const size_t)> callback,
+        const std::shared_ptr<NetworkThreadPool>& thread_pool_)
+        : thread_pool(thread_pool_),
+        pool_context(thread_pool_ ? &thread_pool_->AcquireIOContext() : nullptr),
+        owned_io_context(thread_pool_ ? nullptr : std::make_unique<asio::io_context>()),
+        io_context(thread_pool_ ? pool_context->io_context : *owned_io_context),
+        socket(io_context),
+        pending_handlers(0),
+        input_buffer(input_buffer_default_size),
+        input_start(0),
+        input_end(0)
     {
         NewPacketCallback = callback;
 
         SetIPAndPortFromAddress(address);
 
-        asio::ip::tcp::resolver resolver(io_service);
+        asio::ip::tcp::resolver resolver(io_context);
         asio::ip::tcp::resolver::query query(ip, std::to_string(port));
         asio::ip::tcp::resolver::iterator iterator = resolver.resolve(query);
         LOG_INFO("Trying to connect to " << ip << ":" << port);
         asio::async_connect(socket, iterator,
-            std::bind(&TCP_Com::handle_connect, this,
-            std::placeholders::_1));
+            TrackHandler(std::bind(&TCP_Com::handle_connect, this,
+            std::placeholders::_1)));
 
-        thread_com = std::thread([&] { io_service.run(); });
-        Logger::GetInstance().RegisterThread(thread_com.get_id(), "NetworkIOService");
+        // If no pool is given, this connection has its own thread
+        if (thread_pool == nullptr)
+        {
+            thread_com = std::thread([&] { io_context.run(); });
+            Logger::GetInstance().RegisterThread(thread_com.get_id(), "NetworkIOService");
+        }
     }
 
     TCP_Com::~TCP_Com()
@@ -44,27 +105,32 @@ namespace Botcraft
             Logger::GetInstance().UnregisterThread(thread_com.get_id());
             thread_com.join();
         }
+
+        if (pool_context != nullptr)
+        {
+            // Shared io_context, can't join the thread, so
+            // wait for all handlers using this to be done instead
+            close();
+            std::unique_lock<std::mutex> lock(mutex_pending_handlers);
+            pending_handlers_condition.wait(lock, [this]() { return pending_handlers == 0; });
+            thread_pool->ReleaseIOContext(*pool_context);
+        }
     }
 
     void TCP_Com::SendPacket(const std::vector<unsigned char>& msg)
     {
         std::vector<unsigned char> sized_packet;
+        sized_packet.reserve(msg.size() + 5);
         ProtocolCraft::WriteData<ProtocolCraft::VarInt>(static_cast<int>(msg.size()), sized_packet);
         sized_packet.insert(sized_packet.end(), msg.begin(), msg.end());
 
 #ifdef USE_ENCRYPTION
         if (encrypter != nullptr)
         {
-            std::vector<unsigned char> encrypted = encrypter->Encrypt(sized_packet);
-            io_service.post(std::bind(&TCP_Com::do_write, this, encrypted));
+            encrypter->Encrypt(sized_packet.data(), sized_packet.size());
         }
-        else
-        {
-            io_service.post(std::bind(&TCP_Com::do_write, this, sized_packet));
-        }
-#else
-        io_service.post(std::bind(&TCP_Com::do_write, this, sized_packet));
 #endif
+        asio::post(io_context, TrackHandler([this, packet = std::move(sized_packet)]() mutable { do_write(std::move(packet)); }));
     }
 
 #ifdef USE_ENCRYPTION
@@ -86,7 +152,7 @@ namespace Botcraft
 
     void TCP_Com::close()
     {
-        io_service.post(std::bind(&TCP_Com::do_close, this));
+        asio::post(io_context, TrackHandler(std::bind(&TCP_Com::do_close, this)));
     }
 
     void TCP_Com::handle_connect(const asio::error_code& error)
@@ -94,9 +160,7 @@ namespace Botcraft
         if (!error)
         {
             LOG_INFO("Connection to server established.");
-            socket.async_read_some(asio::buffer(read_msg.data(), read_msg.size()),
-                std::bind(&TCP_Com::handle_read, this,
-                std::placeholders::_1, std::placeholders::_2));
+            do_read();
         }
         else
         {
@@ -104,6 +168,13 @@ namespace Botcraft
         }
     }
 
+    void TCP_Com::do_read()
+    {
+        socket.async_read_some(asio::buffer(input_buffer.data() + input_end, input_buffer.size() - input_end),
+            TrackHandler(std::bind(&TCP_Com::handle_read, this,
+            std::placeholders::_1, std::placeholders::_2)));
+    }
+
     void TCP_Com::handle_read(const asio::error_code& error, std::size_t bytes_transferred)
     {
         if (!error)
@@ -111,60 +182,74 @@ namespace Botcraft
 #ifdef USE_ENCRYPTION
             if (encrypter != nullptr)
             {
-                std::vector<unsigned char> decrypted(bytes_transferred);
-                std::copy_n(read_msg.begin(), bytes_transferred, decrypted.data());
-                decrypted = encrypter->Decrypt(decrypted);
-                for (int i = 0; i < decrypted.size(); ++i)
-                {
-                    input_msg.push_back(decrypted[i]);
-                }
-            }
-            else
-            {
-                for (int i = 0; i < bytes_transferred; ++i)
-                {
-                    input_msg.push_back(read_msg[i]);
-                }
-            }
-#else
-            for (int i = 0; i < bytes_transferred; ++i)
-            {
-                input_msg.push_back(read_msg[i]);
+                encrypter->Decrypt(input_buffer.data() + input_end, bytes_transferred);
             }
 #endif
+            input_end += bytes_transferred;
 
-            while (input_msg.size() != 0)
+            // Size of the first incomplete packet in the buffer, if known
+            size_t incomplete_packet_size = 0;
+            while (input_start < input_end)
             {
-                std::vector<unsigned char>::const_iterator read_iter = input_msg.begin();
-                size_t max_length = input_msg.size();
-                int packet_length;
+                int packet_length = 0;
+                size_t varint_size = 0;
                 try
                 {
-                    packet_length = ProtocolCraft::ReadData<ProtocolCraft::VarInt>(read_iter, max_length);
+                    varint_size = ReadFrameLength(input_buffer.data() + input_start, input_end - input_start, packet_length);
                 }
-                catch (const std::runtime_error)
+                catch (const std::runtime_error& e)
                 {
-                    break;
+                    LOG_ERROR("Error reading packet length (" << e.what() << "), closing connection");
+                    do_close();
+                    return;
                 }
-                const int bytes_read = static_cast<int>(std::distance<std::vector<unsigned char>::const_iterator>(input_msg.begin(), read_iter));
-                std::vector<unsigned char> data_packet;
 
-                if (packet_length > 0 && input_msg.size() >= bytes_read + packet_length)
+                // Not enough data to read the packet length yet
+                if (varint_size == 0)
                 {
-                    data_packet = std::vector<unsigned char>(input_msg.begin() + bytes_read, input_msg.begin() + bytes_read + packet_length);
-
-                    NewPacketCallback(data_packet);
-                    input_msg.erase(input_msg.begin(), input_msg.begin() + bytes_read + packet_length);
+                    break;
                 }
-                else
+
+                if (input_end - input_start - varint_size < static_cast<size_t>(packet_length))
                 {
+                    incomplete_packet_size = varint_size + packet_length;
                     break;
                 }
+
+                // Packets are sent as views into the receive buffer, no copy
+                if (packet_length > 0)
+                {
+                    NewPacketCallback(input_buffer.data() + input_start + varint_size, static_cast<size_t>(packet_length));
+                }
+                input_start += varint_size + packet_length;
+            }
+
+            if (input_start == input_end)
+            {
+                input_start = 0;
+                input_end = 0;
+            }
+            // Move the beginning of the incomplete packet at the start of the buffer
+            else if (input_start > 0)
+            {
+                std::memmove(input_buffer.data(), input_buffer.data() + input_start, input_end - input_start);
+                input_end -= input_start;
+                input_start = 0;
+            }
+
+            // Make sure the whole incomplete packet will fit in the buffer
+            if (incomplete_packet_size > input_buffer.size())
+            {
+                input_buffer.resize(incomplete_packet_size);
+            }
+            // Shrink back if a big packet made the buffer grow and it's now empty
+            else if (input_end == 0 && input_buffer.size() > input_buffer_default_size)
+            {
+                input_buffer.resize(input_buffer_default_size);
+                input_buffer.shrink_to_fit();
             }
 
-            socket.async_read_some(asio::buffer(read_msg.data(), read_msg.size()),
-                std::bind(&TCP_Com::handle_read, this,
-                std::placeholders::_1, std::placeholders::_2));
+            do_read();
         }
         else
         {
@@ -172,11 +257,11 @@ namespace Botcraft
         }
     }
 
-    void TCP_Com::do_write(const std::vector<unsigned char>& msg)
+    void TCP_Com::do_write(std::vector<unsigned char>&& msg)
     {
         mutex_output.lock();
         bool write_in_progress = !output_msg.empty();
-        output_msg.push_back(msg);
+        output_msg.push_back(std::move(msg));
         mutex_output.unlock();
 
         if (!write_in_progress)
@@ -184,8 +269,8 @@ namespace Botcraft
             asio::async_write(socket,
                 asio::buffer(output_msg.front().data(),
                 output_msg.front().size()),
-                std::bind(&TCP_Com::handle_write, this,
-                std::placeholders::_1));
+                TrackHandler(std::bind(&TCP_Com::handle_write, this,
+                std::placeholders::_1)));
         }
     }
 
@@ -202,8 +287,8 @@ namespace Botcraft
                 asio::async_write(socket,
                     asio::buffer(output_msg.front().data(),
                     output_msg.front().size()),
-                    std::bind(&TCP_Com::handle_write, this,
-                    std::placeholders::_1));
+                    TrackHandler(std::bind(&TCP_Com::handle_write, this,
+                    std::placeholders::_1)));
             }
         }
         else
@@ -246,7 +331,7 @@ namespace Botcraft
 
         // If port is unknown we first try a SRV DNS lookup
         LOG_INFO("Performing SRV DNS lookup on " << "_minecraft._tcp." << address << " to find an endpoint");
-        asio::ip::udp::socket udp_socket(io_service);
+        asio::ip::udp::socket udp_socket(io_context);
 
         // Create the query
         DNSMessage query;
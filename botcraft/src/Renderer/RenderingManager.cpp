@@ -690,9 +690,9 @@ namespace Botcraft
         /*
         *  Packet handling methods
         */
-        void RenderingManager::Handle(ProtocolCraft::Message& msg)
+        PacketFilter RenderingManager::GetPacketFilter() const
         {
-
+            return HANDLED_PACKETS_FILTER(RenderingManager);
         }
 
         void RenderingManager::Handle(ProtocolCraft::ClientboundBlockUpdatePacket& msg)
@@ -17,12 +17,57 @@ namespace ProtocolCraft
 
         }
 
+        virtual void Read(ReadIterator& iter, size_t& length) override
+        {
+            lazy_data.clear();
+            parsed = true;
+            return ReadImpl(iter, length);
+        }
+
+        /// @brief Same as Read, but if this message supports lazy parsing (see IsLazyParsable),
+        /// only store the raw data. It will be parsed on first access to any of its fields
+        /// @param iter Iterator to the message data, after the id
+        /// @param length Remaining length of the data, all of it is consumed
+        void ReadLazy(ReadIterator& iter, size_t& length)
+        {
+            if (!IsLazyParsable())
+            {
+                return Read(iter, length);
+            }
+
+            lazy_data.assign(iter, iter + length);
+            iter += length;
+            length = 0;
+            parsed = false;
+        }
+
         virtual void Write(WriteContainer& container) const override
         {
+            EnsureParsed();
             WriteData<VarInt>(GetId(), container);
             return WriteImpl(container);
         }
 
+        virtual Json::Value Serialize() const override
+        {
+            EnsureParsed();
+            return SerializeImpl();
+        }
+
+        /// @brief Check if the data of this message have been parsed
+        /// @return False if the message has been read with ReadLazy and not accessed since
+        bool IsParsed() const
+        {
+            return parsed;
+        }
+
+        /// @brief Check if ReadLazy can defer the parsing of this message. True for big
+        /// messages whose getters and setters call EnsureParsed
+        virtual bool IsLazyParsable() const
+        {
+            return false;
+        }
+
         void Dispatch(Handler *handler)
         {
             return DispatchImpl(handler);
@@ -36,5 +81,29 @@ namespace ProtocolCraft
 
     protected:
         virtual void DispatchImpl(Handler *handler) = 0;
+
+        /// @brief Parse the data stored by ReadLazy, if not already done.
+        /// If the parsing throws, the raw data are kept and the message is still
+        /// not parsed, so later accesses throw again instead of reading invalid fields.
+        /// Not thread-safe, the first access must not be concurrent
+        void EnsureParsed() const
+        {
+            if (parsed)
+            {
+                return;
+            }
+
+            ReadIterator iter = lazy_data.begin();
+            size_t length = lazy_data.size();
+            const_cast<Message*>(this)->ReadImpl(iter, length);
+            parsed = true;
+            lazy_data.clear();
+            lazy_data.shrink_to_fit();
+        }
+
+    private:
+        /// @brief Raw data stored by ReadLazy, waiting to be parsed
+        mutable std::vector<unsigned char> lazy_data;
+        mutable bool parsed = true;
     };
 } // ProtocolCraft
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include "protocolCraft/enums.hpp"
 
@@ -10,4 +11,40 @@ namespace ProtocolCraft
 
     std::shared_ptr<Message> CreateClientboundMessage(const ConnectionState state, const int id);
     std::shared_ptr<Message> CreateServerboundMessage(const ConnectionState state, const int id);
+
+    /// @brief Recycle clientbound messages instead of allocating a new one for
+    /// each packet. A message is reused once all the shared_ptr returned for
+    /// it have been released, and is reset to its default value before that.
+    /// Not thread-safe, each reading thread should use its own pool.
+    class MessagePool
+    {
+    public:
+        /// @brief Create an empty pool
+        /// @param max_pooled_per_type Maximum number of messages kept for each message type
+        MessagePool(const size_t max_pooled_per_type = 4);
+
+        MessagePool(const MessagePool&) = delete;
+        MessagePool& operator=(const MessagePool&) = delete;
+
+        /// @brief Same as ProtocolCraft::CreateClientboundMessage, but reuse a previous message if one is available
+        /// @param state Current connection state
+        /// @param id Packet id
+        /// @return A default message with the given id, or nullptr if id is not valid in this state
+        std::shared_ptr<Message> CreateClientboundMessage(const ConnectionState state, const int id);
+
+        /// @brief Get the number of messages that had to be allocated
+        /// @return Number of new messages created by this pool
+        size_t GetNumAllocations() const;
+
+        /// @brief Get the number of messages that have been recycled
+        /// @return Number of messages reused instead of allocated
+        size_t GetNumReused() const;
+
+    private:
+        /// @brief Pooled messages, indexed by state then packet id
+        std::vector<std::vector<std::vector<std::shared_ptr<Message> > > > clientbound_messages;
+        const size_t max_pooled_per_type;
+        size_t num_allocations;
+        size_t num_reused;
+    };
 } //ProtocolCraft
@@ -44,24 +44,33 @@ namespace ProtocolCraft
 
         }
 
+        virtual bool IsLazyParsable() const override
+        {
+            return true;
+        }
+
         void SetNodes(const std::vector<CommandNode>& nodes_)
         {
+            EnsureParsed();
             nodes = nodes_;
         }
 
         void SetRootIndex(const int root_index_)
         {
+            EnsureParsed();
             root_index = root_index_;
         }
 
 
         const std::vector<CommandNode>& GetNodes() const
         {
+            EnsureParsed();
             return nodes;
         }
 
         int GetRootIndex() const
         {
+            EnsureParsed();
             return root_index;
         }
 
@@ -54,6 +54,14 @@ namespace ProtocolCraft
             light_data = light_data_;
         }
 
+        /// @brief Set whether light data are skipped when this packet is read. If true, light data
+        /// are left empty, and this packet should not be written or serialized
+        /// @param skip_light_data_ True to skip light data
+        void SetSkipLightData(const bool skip_light_data_)
+        {
+            skip_light_data = skip_light_data_;
+        }
+
 
         int GetX() const
         {
@@ -75,6 +83,16 @@ namespace ProtocolCraft
             return light_data;
         }
 
+        ClientboundLightUpdatePacketData& GetLightData()
+        {
+            return light_data;
+        }
+
+        bool GetSkipLightData() const
+        {
+            return skip_light_data;
+        }
+
     protected:
 
         virtual void ReadImpl(ReadIterator& iter, size_t& length) override
@@ -83,7 +101,15 @@ namespace ProtocolCraft
             z = ReadData<int>(iter, length);
 
             chunk_data = ReadData<ClientboundLevelChunkPacketData>(iter, length);
-            light_data = ReadData<ClientboundLightUpdatePacketData>(iter, length);
+            if (skip_light_data)
+            {
+                light_data = ClientboundLightUpdatePacketData();
+                ClientboundLightUpdatePacketData::Skip(iter, length);
+            }
+            else
+            {
+                light_data = ReadData<ClientboundLightUpdatePacketData>(iter, length);
+            }
         }
 
         virtual void WriteImpl(WriteContainer& container) const override
@@ -112,6 +138,8 @@ namespace ProtocolCraft
         int z = 0;
         ClientboundLevelChunkPacketData chunk_data;
         ClientboundLightUpdatePacketData light_data;
+
+        bool skip_light_data = false;
     };
 } //ProtocolCraft
 #endif
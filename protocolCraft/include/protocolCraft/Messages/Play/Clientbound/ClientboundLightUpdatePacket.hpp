@@ -188,6 +188,18 @@ namespace ProtocolCraft
             return block_updates;
         }
 
+        /// @brief Non-const access to the light arrays, to move them out of the packet without copy
+        std::vector<std::vector<char> >& GetSkyUpdates()
+        {
+            return sky_updates;
+        }
+
+        /// @brief Non-const access to the light arrays, to move them out of the packet without copy
+        std::vector<std::vector<char> >& GetBlockUpdates()
+        {
+            return block_updates;
+        }
+
 #if PROTOCOL_VERSION > 722 /* > 1.15.2 */
         bool GetTrustEdges() const
         {
@@ -199,6 +211,11 @@ namespace ProtocolCraft
         {
             return light_data;
         }
+
+        ClientboundLightUpdatePacketData& GetLightData()
+        {
+            return light_data;
+        }
 #endif
 
     protected:
@@ -55,44 +55,57 @@ namespace ProtocolCraft
 
         }
 
+        virtual bool IsLazyParsable() const override
+        {
+            return true;
+        }
+
         void SetReset(const bool reset_)
         {
+            EnsureParsed();
             reset = reset_;
         }
 
         void SetAdded(const std::map<Identifier, Advancement>& added_)
         {
+            EnsureParsed();
             added = added_;
         }
 
         void SetRemoved(const std::vector<Identifier>& removed_)
         {
+            EnsureParsed();
             removed = removed_;
         }
 
         void SetProgress(const std::map<Identifier, AdvancementProgress>& progress_)
         {
+            EnsureParsed();
             progress = progress_;
         }
 
 
         bool GetReset() const
         {
+            EnsureParsed();
             return reset;
         }
 
         const std::map<Identifier, Advancement>& GetAdded() const
         {
+            EnsureParsed();
             return added;
         }
 
         const std::vector<Identifier>& GetRemoved() const
         {
+            EnsureParsed();
             return removed;
         }
 
         const std::map<Identifier, AdvancementProgress>& GetProgress() const
         {
+            EnsureParsed();
             return progress;
         }
 
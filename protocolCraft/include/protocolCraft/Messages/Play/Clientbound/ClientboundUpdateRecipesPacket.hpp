@@ -50,15 +50,22 @@ namespace ProtocolCraft
 
         }
 
+        virtual bool IsLazyParsable() const override
+        {
+            return true;
+        }
+
 
         void SetRecipes(const std::vector<Recipe>& recipes_)
         {
+            EnsureParsed();
             recipes = recipes_;
         }
 
 
         const std::vector<Recipe>& GetRecipes() const
         {
+            EnsureParsed();
             return recipes;
         }
 
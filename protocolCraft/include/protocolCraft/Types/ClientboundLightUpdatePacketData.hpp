@@ -89,6 +89,53 @@ namespace ProtocolCraft
             return block_updates;
         }
 
+        /// @brief Non-const access to the light arrays, to move them out of the packet without copy
+        std::vector<std::vector<char> >& GetSkyUpdates()
+        {
+            return sky_updates;
+        }
+
+        /// @brief Non-const access to the light arrays, to move them out of the packet without copy
+        std::vector<std::vector<char> >& GetBlockUpdates()
+        {
+            return block_updates;
+        }
+
+        /// @brief Move iter after serialized light data, without reading nor allocating anything
+        /// @param iter Iterator to the light data
+        /// @param length Remaining length of the data
+        static void Skip(ReadIterator& iter, size_t& length)
+        {
+            const auto skip_bytes = [&](const size_t num_bytes)
+            {
+                if (length < num_bytes)
+                {
+                    throw std::runtime_error("Not enough input in ClientboundLightUpdatePacketData::Skip");
+                }
+                iter += num_bytes;
+                length -= num_bytes;
+            };
+
+#if PROTOCOL_VERSION < 763 /* < 1.20 */
+            skip_bytes(1); // trust_edges
+#endif
+            // Masks
+            for (int i = 0; i < 4; ++i)
+            {
+                const int num_longs = ReadData<VarInt>(iter, length);
+                skip_bytes(static_cast<size_t>(num_longs) * sizeof(unsigned long long int));
+            }
+            // Sky then block light arrays
+            for (int i = 0; i < 2; ++i)
+            {
+                const int num_arrays = ReadData<VarInt>(iter, length);
+                for (int j = 0; j < num_arrays; ++j)
+                {
+                    skip_bytes(static_cast<size_t>(ReadData<VarInt>(iter, length)));
+                }
+            }
+        }
+
     protected:
         virtual void ReadImpl(ReadIterator& iter, size_t& length) override
         {
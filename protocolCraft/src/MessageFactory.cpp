@@ -2,34 +2,119 @@
 #include "protocolCraft/Message.hpp"
 #include "protocolCraft/AllMessages.hpp"
 
-// Template black magic to loop at compile time
-template<std::size_t... indices, class LoopBody>
-void loop_impl(std::index_sequence<indices...>, LoopBody&& loop_body) {
-    (loop_body(std::integral_constant<std::size_t, indices>{}), ...);
+#include <array>
+#include <utility>
+
+template<typename TypesTuple, std::size_t... indices>
+constexpr int MaxPacketId(std::index_sequence<indices...>)
+{
+    int output = -1;
+    ((output = std::tuple_element_t<indices, TypesTuple>::packet_id > output ? std::tuple_element_t<indices, TypesTuple>::packet_id : output), ...);
+    return output;
+}
+
+template<typename T>
+std::shared_ptr<ProtocolCraft::Message> CreateMessage()
+{
+    return std::make_shared<T>();
 }
 
-template<std::size_t N, class LoopBody>
-void loop(LoopBody&& loop_body) {
-    loop_impl(std::make_index_sequence<N>{}, std::forward<LoopBody>(loop_body));
+template<typename T>
+void ResetMessage(ProtocolCraft::Message& msg)
+{
+    // Copy assignment, so vectors and strings keep their capacity
+    const T default_message{};
+    static_cast<T&>(msg) = default_message;
+}
+
+/// @brief Dense table of factory functions indexed by packet id, generated at compile time
+template<typename TypesTuple>
+struct MessageFactoryTable
+{
+    using Factory = std::shared_ptr<ProtocolCraft::Message>(*)();
+    using Reset = void(*)(ProtocolCraft::Message&);
+    static constexpr std::size_t size = MaxPacketId<TypesTuple>(std::make_index_sequence<std::tuple_size_v<TypesTuple>>{}) + 1;
+
+    template<std::size_t... indices>
+    static constexpr std::array<Factory, size> Generate(std::index_sequence<indices...>)
+    {
+        std::array<Factory, size> output{};
+        ((output[std::tuple_element_t<indices, TypesTuple>::packet_id] = &CreateMessage<std::tuple_element_t<indices, TypesTuple>>), ...);
+        return output;
+    }
+
+    template<std::size_t... indices>
+    static constexpr std::array<Reset, size> GenerateReset(std::index_sequence<indices...>)
+    {
+        std::array<Reset, size> output{};
+        ((output[std::tuple_element_t<indices, TypesTuple>::packet_id] = &ResetMessage<std::tuple_element_t<indices, TypesTuple>>), ...);
+        return output;
+    }
+
+    static constexpr std::array<Factory, size> table = Generate(std::make_index_sequence<std::tuple_size_v<TypesTuple>>{});
+    static constexpr std::array<Reset, size> reset_table = GenerateReset(std::make_index_sequence<std::tuple_size_v<TypesTuple>>{});
+};
+
+template<typename TypesTuple>
+bool AutomaticIsValidMessageId(const int id)
+{
+    using Table = MessageFactoryTable<TypesTuple>;
+    return id >= 0 && id < static_cast<int>(Table::size) && Table::table[id] != nullptr;
 }
 
 template<typename TypesTuple>
 std::shared_ptr<ProtocolCraft::Message> AutomaticMessageFactory(const int id)
 {
-    std::shared_ptr<ProtocolCraft::Message> output = nullptr;
+    if (!AutomaticIsValidMessageId<TypesTuple>(id))
+    {
+        return nullptr;
+    }
+    return MessageFactoryTable<TypesTuple>::table[id]();
+}
 
-    loop < std::tuple_size<TypesTuple>{} > (
-        [&](auto i)
-        {
-            using TupleElement = std::tuple_element_t<i, TypesTuple>;
-            if (id == TupleElement::packet_id)
-            {
-                output = std::make_shared<TupleElement>();
-            }
-        }
-    );
+template<typename TypesTuple>
+void AutomaticMessageReset(ProtocolCraft::Message& msg)
+{
+    using Table = MessageFactoryTable<TypesTuple>;
+    Table::reset_table[msg.GetId()](msg);
+}
 
-    return output;
+bool IsValidClientboundMessageId(const ProtocolCraft::ConnectionState state, const int id)
+{
+    switch (state)
+    {
+    case ProtocolCraft::ConnectionState::Login:
+        return AutomaticIsValidMessageId<ProtocolCraft::AllClientboundLoginMessages>(id);
+    case ProtocolCraft::ConnectionState::Status:
+        return AutomaticIsValidMessageId<ProtocolCraft::AllClientboundStatusMessages>(id);
+    case ProtocolCraft::ConnectionState::Play:
+        return AutomaticIsValidMessageId<ProtocolCraft::AllClientboundPlayMessages>(id);
+#if PROTOCOL_VERSION > 763 /* > 1.20.1 */
+    case ProtocolCraft::ConnectionState::Configuration:
+        return AutomaticIsValidMessageId<ProtocolCraft::AllClientboundConfigurationMessages>(id);
+#endif
+    default:
+        return false;
+    }
+}
+
+void ResetClientboundMessage(const ProtocolCraft::ConnectionState state, ProtocolCraft::Message& msg)
+{
+    switch (state)
+    {
+    case ProtocolCraft::ConnectionState::Login:
+        return AutomaticMessageReset<ProtocolCraft::AllClientboundLoginMessages>(msg);
+    case ProtocolCraft::ConnectionState::Status:
+        return AutomaticMessageReset<ProtocolCraft::AllClientboundStatusMessages>(msg);
+    case ProtocolCraft::ConnectionState::Play:
+        return AutomaticMessageReset<ProtocolCraft::AllClientboundPlayMessages>(msg);
+#if PROTOCOL_VERSION > 763 /* > 1.20.1 */
+    case ProtocolCraft::ConnectionState::Configuration:
+        return AutomaticMessageReset<ProtocolCraft::AllClientboundConfigurationMessages>(msg);
+#endif
+    default:
+        return;
+    }
 }
 
 namespace ProtocolCraft
@@ -73,4 +158,67 @@ namespace ProtocolCraft
             return nullptr;
         }
     }
+
+    MessagePool::MessagePool(const size_t max_pooled_per_type_) : max_pooled_per_type(max_pooled_per_type_)
+    {
+        num_allocations = 0;
+        num_reused = 0;
+    }
+
+    std::shared_ptr<Message> MessagePool::CreateClientboundMessage(const ConnectionState state, const int id)
+    {
+        // Ids come from the network, don't grow the pool for invalid ones
+        if (!IsValidClientboundMessageId(state, id))
+        {
+            return nullptr;
+        }
+
+        const int state_index = static_cast<int>(state);
+        if (state_index < 0)
+        {
+            return ProtocolCraft::CreateClientboundMessage(state, id);
+        }
+
+        if (clientbound_messages.size() <= state_index)
+        {
+            clientbound_messages.resize(state_index + 1);
+        }
+        if (clientbound_messages[state_index].size() <= id)
+        {
+            clientbound_messages[state_index].resize(id + 1);
+        }
+
+        std::vector<std::shared_ptr<Message> >& pooled = clientbound_messages[state_index][id];
+        for (const auto& m : pooled)
+        {
+            // Only owned by the pool, nobody else can be using it
+            if (m.use_count() == 1)
+            {
+                ResetClientboundMessage(state, *m);
+                num_reused += 1;
+                return m;
+            }
+        }
+
+        std::shared_ptr<Message> output = ProtocolCraft::CreateClientboundMessage(state, id);
+        if (output != nullptr)
+        {
+            num_allocations += 1;
+            if (pooled.size() < max_pooled_per_type)
+            {
+                pooled.push_back(output);
+            }
+        }
+        return output;
+    }
+
+    size_t MessagePool::GetNumAllocations() const
+    {
+        return num_allocations;
+    }
+
+    size_t MessagePool::GetNumReused() const
+    {
+        return num_reused;
+    }
 }
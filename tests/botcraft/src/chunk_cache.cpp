@@ -0,0 +1,126 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <botcraft/Game/World/ChunkCache.hpp>
+
+using namespace Botcraft;
+
+namespace
+{
+    Chunk CreateChunk(const unsigned char light)
+    {
+#if PROTOCOL_VERSION < 757 /* < 1.18 */
+        Chunk chunk(0, true);
+#else
+        Chunk chunk(-64, 384, 0, true);
+#endif
+        for (int y = chunk.GetMinY(); y < chunk.GetMinY() + 64; ++y)
+        {
+            for (int x = 0; x < CHUNK_WIDTH; ++x)
+            {
+#if PROTOCOL_VERSION < 347 /* < 1.13 */
+                chunk.SetBlock(Position(x, y, x), { x + y % 7, 0 });
+#else
+                chunk.SetBlock(Position(x, y, x), x + y % 7);
+#endif
+                chunk.SetSkyLight(Position(x, y, 3), light);
+                chunk.SetBlockLight(Position(3, y, x), (x + y) % 16);
+            }
+        }
+        return chunk;
+    }
+
+    void CheckChunk(const Chunk& chunk, const unsigned char light)
+    {
+        const Chunk expected = CreateChunk(light);
+        REQUIRE(chunk.GetMinY() == expected.GetMinY());
+        REQUIRE(chunk.GetHeight() == expected.GetHeight());
+        CHECK(chunk.GetHasSkyLight());
+        for (int section_y = 0; section_y < chunk.GetHeight() / SECTION_HEIGHT; ++section_y)
+        {
+            CHECK(chunk.HasSection(section_y) == expected.HasSection(section_y));
+        }
+        bool same_lights = true;
+        for (int y = chunk.GetMinY(); y < chunk.GetMinY() + chunk.GetHeight(); ++y)
+        {
+            for (int z = 0; z < CHUNK_WIDTH; ++z)
+            {
+                for (int x = 0; x < CHUNK_WIDTH; ++x)
+                {
+                    same_lights &= chunk.GetSkyLight(Position(x, y, z)) == expected.GetSkyLight(Position(x, y, z));
+                    same_lights &= chunk.GetBlockLight(Position(x, y, z)) == expected.GetBlockLight(Position(x, y, z));
+                }
+            }
+        }
+        CHECK(same_lights);
+    }
+}
+
+TEST_CASE("Chunk cache")
+{
+    const std::filesystem::path folder = std::filesystem::temp_directory_path() / "botcraft_chunk_cache_tests";
+    std::filesystem::remove_all(folder);
+
+    const std::string dimension = "minecraft:overworld";
+    {
+        ChunkCache cache(folder.string());
+        CHECK_FALSE(cache.Contains(dimension, -33, 5));
+        CHECK_FALSE(cache.Load(dimension, -33, 5).has_value());
+
+        cache.Save(dimension, -33, 5, CreateChunk(15));
+        cache.Save(dimension, 0, 0, CreateChunk(7));
+        CHECK(cache.Contains(dimension, -33, 5));
+        CHECK_FALSE(cache.Contains("minecraft:the_nether", -33, 5));
+        CHECK_FALSE(cache.Contains(dimension, -33, 4));
+
+        // Read back from memory
+        const std::optional<Chunk> chunk = cache.Load(dimension, -33, 5, 2);
+        REQUIRE(chunk.has_value());
+        CHECK(chunk->GetDimensionIndex() == 2);
+        CheckChunk(chunk.value(), 15);
+    }
+
+    SECTION("Read from disk")
+    {
+        ChunkCache cache(folder.string());
+        CHECK(cache.Contains(dimension, -33, 5));
+        const std::optional<Chunk> chunk = cache.Load(dimension, -33, 5);
+        REQUIRE(chunk.has_value());
+        CheckChunk(chunk.value(), 15);
+        CheckChunk(cache.Load(dimension, 0, 0).value(), 7);
+    }
+
+    SECTION("Overwrite")
+    {
+        ChunkCache cache(folder.string(), 0);
+        // Bigger than the previous version, moved at the end of the file
+        Chunk bigger = CreateChunk(3);
+        bigger.SetSkyLight(Position(0, bigger.GetMinY() + bigger.GetHeight() - 1, 0), 3);
+        cache.Save(dimension, -33, 5, bigger);
+        CHECK(cache.Load(dimension, -33, 5)->GetSkyLight(Position(0, bigger.GetMinY() + bigger.GetHeight() - 1, 0)) == 3);
+
+        cache.Save(dimension, -33, 5, CreateChunk(4));
+        CheckChunk(cache.Load(dimension, -33, 5).value(), 4);
+        CheckChunk(cache.Load(dimension, 0, 0).value(), 7);
+    }
+
+    SECTION("Invalid file")
+    {
+        const std::filesystem::path region_path = folder / "minecraft_overworld" / "r.-2.0.bcr";
+        REQUIRE(std::filesystem::exists(region_path));
+        {
+            std::ofstream file(region_path, std::ios::binary | std::ios::trunc);
+            file << "not a region file";
+        }
+
+        ChunkCache cache(folder.string());
+        CHECK_FALSE(cache.Load(dimension, -33, 5).has_value());
+        cache.Save(dimension, -33, 5, CreateChunk(1));
+        CheckChunk(cache.Load(dimension, -33, 5).value(), 1);
+    }
+
+    std::filesystem::remove_all(folder);
+}
@@ -0,0 +1,194 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <botcraft/Game/World/ChunkMap.hpp>
+
+using namespace Botcraft;
+
+namespace
+{
+    Chunk CreateChunk(const size_t dim_index)
+    {
+#if PROTOCOL_VERSION < 757 /* < 1.18 */
+        return Chunk(dim_index, true);
+#else
+        return Chunk(0, 16, dim_index, true);
+#endif
+    }
+}
+
+TEST_CASE("Chunk map")
+{
+    ChunkMap chunks;
+    CHECK(chunks.empty());
+    CHECK(chunks.find({ 0, 0 }) == chunks.end());
+    CHECK_THROWS_AS(chunks.at({ 0, 0 }), std::out_of_range);
+
+    SECTION("Insert")
+    {
+        auto [it, inserted] = chunks.insert({ { -1, 2 }, CreateChunk(3) });
+        CHECK(inserted);
+        CHECK(it->first == std::pair<int, int>(-1, 2));
+        CHECK(chunks.size() == 1);
+        CHECK(chunks.at({ -1, 2 }).GetDimensionIndex() == 3);
+
+        // Already present, not replaced
+        std::tie(it, inserted) = chunks.insert({ { -1, 2 }, CreateChunk(4) });
+        CHECK_FALSE(inserted);
+        CHECK(it->second.GetDimensionIndex() == 3);
+        CHECK(chunks.size() == 1);
+    }
+
+    SECTION("Erase while iterating")
+    {
+        for (int i = 0; i < 10; ++i)
+        {
+            chunks.insert({ { i, -i }, CreateChunk(i) });
+        }
+        for (auto it = chunks.begin(); it != chunks.end();)
+        {
+            it = it->second.GetDimensionIndex() % 2 == 0 ? chunks.erase(it) : std::next(it);
+        }
+        CHECK(chunks.size() == 5);
+        for (int i = 0; i < 10; ++i)
+        {
+            CHECK((chunks.find({ i, -i }) != chunks.end()) == (i % 2 == 1));
+        }
+    }
+
+    SECTION("Random operations")
+    {
+        // Compare with a std::map after a lot of random insertions and deletions in a small area, to get many collisions
+        std::map<std::pair<int, int>, size_t> reference;
+        std::mt19937 random_engine(42);
+        std::uniform_int_distribution<int> coord(-20, 20);
+        for (size_t i = 0; i < 20000; ++i)
+        {
+            const std::pair<int, int> key(coord(random_engine), coord(random_engine));
+            if (random_engine() % 3 == 0)
+            {
+                CHECK(chunks.erase(key) == reference.erase(key));
+            }
+            else
+            {
+                const bool inserted = chunks.insert({ key, CreateChunk(i) }).second;
+                CHECK(inserted == reference.insert({ key, i }).second);
+            }
+        }
+
+        REQUIRE(chunks.size() == reference.size());
+        for (const auto& [key, dim_index] : reference)
+        {
+            const auto it = chunks.find(key);
+            REQUIRE(it != chunks.end());
+            CHECK(it->second.GetDimensionIndex() == dim_index);
+        }
+        size_t num_iterated = 0;
+        for (const auto& [key, chunk] : chunks)
+        {
+            CHECK(reference.at(key) == chunk.GetDimensionIndex());
+            num_iterated += 1;
+        }
+        CHECK(num_iterated == reference.size());
+
+        chunks.clear();
+        CHECK(chunks.empty());
+        CHECK(chunks.find(reference.begin()->first) == chunks.end());
+    }
+
+    SECTION("Move")
+    {
+        for (int i = 0; i < 10; ++i)
+        {
+            chunks.insert({ { i, -i }, CreateChunk(i) });
+        }
+        // Cache the last chunk found, its index is not valid in an empty map
+        CHECK(chunks.at({ 9, -9 }).GetDimensionIndex() == 9);
+
+        ChunkMap moved(std::move(chunks));
+        CHECK(moved.size() == 10);
+        CHECK(moved.at({ 9, -9 }).GetDimensionIndex() == 9);
+        CHECK(chunks.empty());
+        CHECK(chunks.find({ 9, -9 }) == chunks.end());
+        CHECK(chunks.insert({ { 9, -9 }, CreateChunk(1) }).second);
+        CHECK(chunks.at({ 9, -9 }).GetDimensionIndex() == 1);
+
+        chunks = std::move(moved);
+        CHECK(chunks.size() == 10);
+        CHECK(chunks.at({ 9, -9 }).GetDimensionIndex() == 9);
+        CHECK(moved.empty());
+        CHECK(moved.find({ 9, -9 }) == moved.end());
+    }
+}
+
+namespace
+{
+    /// @brief The std::hash<std::pair<int, int>> previously used for the terrain
+    struct FloatPairHash
+    {
+        size_t operator()(const std::pair<int, int>& p) const
+        {
+            std::hash<float> hasher;
+            size_t value = hasher(p.first);
+            value ^= hasher(p.second) + 0x9e3779b9 + (value << 6) + (value >> 2);
+            return value;
+        }
+    };
+}
+
+TEST_CASE("Chunk map benchmark", "[.][benchmark]")
+{
+    // 32 chunks view distance
+    const int radius = 32;
+    ChunkMap chunks;
+    std::unordered_map<std::pair<int, int>, Chunk, FloatPairHash> legacy_chunks;
+    for (int x = -radius; x <= radius; ++x)
+    {
+        for (int z = -radius; z <= radius; ++z)
+        {
+            chunks.insert({ { x, z }, CreateChunk(0) });
+            legacy_chunks.insert({ { x, z }, CreateChunk(0) });
+        }
+    }
+
+    // Block queries, mostly in the same chunk as the previous one
+    std::vector<std::pair<int, int> > queries;
+    std::mt19937 random_engine(42);
+    std::uniform_int_distribution<int> coord(-radius * 16, radius * 16 + 15);
+    std::pair<int, int> current(0, 0);
+    for (int i = 0; i < 100000; ++i)
+    {
+        if (i % 16 == 0)
+        {
+            current = { coord(random_engine) >> 4, coord(random_engine) >> 4 };
+        }
+        queries.push_back(current);
+    }
+
+    BENCHMARK("std::unordered_map with float hash")
+    {
+        size_t found = 0;
+        for (const auto& q : queries)
+        {
+            found += legacy_chunks.find(q) != legacy_chunks.end();
+        }
+        return found;
+    };
+
+    BENCHMARK("ChunkMap")
+    {
+        size_t found = 0;
+        for (const auto& q : queries)
+        {
+            found += chunks.find(q) != chunks.end();
+        }
+        return found;
+    };
+}
@@ -0,0 +1,1019 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <asio/io_context.hpp>
+#include <asio/ip/tcp.hpp>
+#include <asio/write.hpp>
+
+#include <protocolCraft/BinaryReadWrite.hpp>
+
+#include <botcraft/Network/NetworkManager.hpp>
+#include <botcraft/Network/NetworkThreadPool.hpp>
+#include <botcraft/Network/PacketBufferPool.hpp>
+#include <botcraft/Network/PacketFilter.hpp>
+#include <botcraft/Network/TCP_Com.hpp>
+#ifdef USE_COMPRESSION
+#include <botcraft/Network/Compression.hpp>
+#endif
+#ifdef USE_ENCRYPTION
+#include <botcraft/Network/AESEncrypter.hpp>
+#endif
+#include <botcraft/Utilities/SPSCQueue.hpp>
+
+#include <botcraft/Game/Entities/EntityManager.hpp>
+#include <botcraft/Game/World/World.hpp>
+
+using namespace Botcraft;
+
+namespace
+{
+    /// @brief A minimal server accepting num_clients connections on localhost
+    class LoopbackServer
+    {
+    public:
+        LoopbackServer() : acceptor(io_context, asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0))
+        {
+
+        }
+
+        std::string GetAddress() const
+        {
+            return "127.0.0.1:" + std::to_string(acceptor.local_endpoint().port());
+        }
+
+        void Accept(const size_t num_clients)
+        {
+            for (size_t i = 0; i < num_clients; ++i)
+            {
+                sockets.emplace_back(std::make_unique<asio::ip::tcp::socket>(io_context));
+                acceptor.accept(*sockets.back());
+            }
+        }
+
+        /// @brief Send one timestamped packet to every connected client
+        void SendTimestamps()
+        {
+            for (auto& s : sockets)
+            {
+                const long long int now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+                std::vector<unsigned char> packet;
+                ProtocolCraft::WriteData<ProtocolCraft::VarInt>(static_cast<int>(sizeof(now)), packet);
+                packet.resize(packet.size() + sizeof(now));
+                std::memcpy(packet.data() + packet.size() - sizeof(now), &now, sizeof(now));
+                asio::write(*s, asio::buffer(packet));
+            }
+        }
+
+        /// @brief Send raw bytes to the first connected client
+        void SendRaw(const std::vector<unsigned char>& data)
+        {
+            asio::write(*sockets.front(), asio::buffer(data));
+        }
+
+        /// @brief Wait for the first connected client to close the connection
+        /// @return True if closed before the timeout
+        bool WaitClosed(const std::chrono::milliseconds timeout)
+        {
+            asio::ip::tcp::socket& s = *sockets.front();
+            s.non_blocking(true);
+            std::array<unsigned char, 256> buffer;
+            const auto start = std::chrono::steady_clock::now();
+            while (std::chrono::steady_clock::now() - start < timeout)
+            {
+                asio::error_code error;
+                s.read_some(asio::buffer(buffer), error);
+                if (error == asio::error::would_block)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                else if (error)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+    private:
+        asio::io_context io_context;
+        asio::ip::tcp::acceptor acceptor;
+        std::vector<std::unique_ptr<asio::ip::tcp::socket> > sockets;
+    };
+
+    /// @brief Received packets count and summed latency, shared by all clients
+    struct LatencyCounter
+    {
+        std::atomic<long long int> num_packets = 0;
+        std::atomic<long long int> total_latency_ns = 0;
+
+        void OnPacket(const unsigned char* data, const size_t length)
+        {
+            long long int sent;
+            std::memcpy(&sent, data, sizeof(sent));
+            const long long int now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+            total_latency_ns += now - sent;
+            num_packets += 1;
+        }
+
+        bool WaitFor(const long long int expected) const
+        {
+            const auto start = std::chrono::steady_clock::now();
+            while (num_packets < expected)
+            {
+                if (std::chrono::steady_clock::now() - start > std::chrono::seconds(10))
+                {
+                    return false;
+                }
+                std::this_thread::yield();
+            }
+            return true;
+        }
+    };
+
+    std::vector<std::unique_ptr<TCP_Com> > CreateClients(LoopbackServer& server, LatencyCounter& counter,
+        const size_t num_clients, const std::shared_ptr<NetworkThreadPool>& pool)
+    {
+        std::vector<std::unique_ptr<TCP_Com> > clients;
+        clients.reserve(num_clients);
+        std::thread accept_thread(&LoopbackServer::Accept, &server, num_clients);
+        for (size_t i = 0; i < num_clients; ++i)
+        {
+            clients.emplace_back(std::make_unique<TCP_Com>(server.GetAddress(),
+                [&counter](const unsigned char* data, const size_t length) { counter.OnPacket(data, length); }, pool));
+        }
+        accept_thread.join();
+        return clients;
+    }
+
+    void CloseClients(std::vector<std::unique_ptr<TCP_Com> >& clients)
+    {
+        for (auto& c : clients)
+        {
+            c->close();
+        }
+        clients.clear();
+    }
+}
+
+TEST_CASE("Shared network thread pool")
+{
+    const size_t num_clients = 64;
+    const int num_packets = 10;
+
+    std::shared_ptr<NetworkThreadPool> pool = std::make_shared<NetworkThreadPool>(2);
+    REQUIRE(pool->GetNumThreads() == 2);
+
+    LoopbackServer server;
+    LatencyCounter counter;
+    std::vector<std::unique_ptr<TCP_Com> > clients = CreateClients(server, counter, num_clients, pool);
+    REQUIRE(pool->GetNumConnections() == num_clients);
+
+    for (int i = 0; i < num_packets; ++i)
+    {
+        server.SendTimestamps();
+    }
+    REQUIRE(counter.WaitFor(num_clients * num_packets));
+    REQUIRE(counter.num_packets == num_clients * num_packets);
+
+    CloseClients(clients);
+    REQUIRE(pool->GetNumConnections() == 0);
+}
+
+TEST_CASE("Network thread pool benchmark", "[.][benchmark]")
+{
+    const size_t num_clients = 256;
+
+    auto run = [&](const std::shared_ptr<NetworkThreadPool>& pool)
+    {
+        LoopbackServer server;
+        LatencyCounter counter;
+        std::vector<std::unique_ptr<TCP_Com> > clients = CreateClients(server, counter, num_clients, pool);
+
+        long long int expected = 0;
+        BENCHMARK(pool ? "Shared pool, " + std::to_string(pool->GetNumThreads()) + " threads" : "One thread per client")
+        {
+            server.SendTimestamps();
+            expected += num_clients;
+            return counter.WaitFor(expected);
+        };
+
+        WARN((pool ? pool->GetNumThreads() : num_clients) << " network threads for " << num_clients << " clients, "
+            << "mean per-packet latency: " << counter.total_latency_ns / std::max(1LL, counter.num_packets.load()) / 1000.0 << " us");
+        CloseClients(clients);
+    };
+
+    run(nullptr);
+    run(std::make_shared<NetworkThreadPool>());
+}
+
+namespace
+{
+    /// @brief Append a framed packet of given size to a stream, filled with a pattern depending on index
+    void AppendPacket(std::vector<unsigned char>& stream, const int size, const int index)
+    {
+        ProtocolCraft::WriteData<ProtocolCraft::VarInt>(size, stream);
+        for (int i = 0; i < size; ++i)
+        {
+            stream.push_back(static_cast<unsigned char>(i + index));
+        }
+    }
+
+    /// @brief Create a stream looking like a login followed by chunk loading
+    /// (a few small packets, then big chunk packets mixed with small entity updates)
+    std::vector<unsigned char> CreateLoginAndChunksStream(const int num_chunks, int& num_packets)
+    {
+        std::vector<unsigned char> stream;
+        num_packets = 0;
+        for (const int size : { 3, 40, 1200, 25000, 60, 300, 5000 })
+        {
+            AppendPacket(stream, size, num_packets++);
+        }
+        for (int i = 0; i < num_chunks; ++i)
+        {
+            AppendPacket(stream, 20000 + (i * 7919) % 60000, num_packets++);
+            for (int j = 0; j < 8; ++j)
+            {
+                AppendPacket(stream, 10 + (i + j) % 40, num_packets++);
+            }
+        }
+        return stream;
+    }
+}
+
+TEST_CASE("Packet framing")
+{
+    const std::vector<int> sizes = { 1, 10, 127, 128, 1000, 16383, 16384, 70000, 300000, 2, 65536, 3 };
+    std::vector<unsigned char> stream;
+    for (size_t i = 0; i < sizes.size(); ++i)
+    {
+        AppendPacket(stream, sizes[i], static_cast<int>(i));
+    }
+
+    LoopbackServer server;
+    std::mutex mutex_received;
+    std::vector<std::vector<unsigned char> > received;
+    std::thread accept_thread(&LoopbackServer::Accept, &server, 1);
+    std::unique_ptr<TCP_Com> client = std::make_unique<TCP_Com>(server.GetAddress(),
+        [&](const unsigned char* data, const size_t length)
+        {
+            std::scoped_lock<std::mutex> lock(mutex_received);
+            received.emplace_back(data, data + length);
+        });
+    accept_thread.join();
+
+    // Send the stream in small irregular pieces to split packets and VarInt headers
+    size_t offset = 0;
+    size_t piece_size = 1;
+    while (offset < stream.size())
+    {
+        const size_t length = std::min(piece_size, stream.size() - offset);
+        server.SendRaw(std::vector<unsigned char>(stream.begin() + offset, stream.begin() + offset + length));
+        offset += length;
+        piece_size = piece_size * 3 + 1;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - start < std::chrono::seconds(10))
+    {
+        std::scoped_lock<std::mutex> lock(mutex_received);
+        if (received.size() == sizes.size())
+        {
+            break;
+        }
+    }
+    client->close();
+    client.reset();
+
+    REQUIRE(received.size() == sizes.size());
+    for (size_t i = 0; i < sizes.size(); ++i)
+    {
+        REQUIRE(received[i].size() == sizes[i]);
+        bool content_ok = true;
+        for (int j = 0; j < sizes[i]; ++j)
+        {
+            content_ok &= received[i][j] == static_cast<unsigned char>(j + i);
+        }
+        REQUIRE(content_ok);
+    }
+}
+
+TEST_CASE("Packet length above the protocol max")
+{
+    std::vector<unsigned char> stream;
+    AppendPacket(stream, 10, 0);
+    // Announce a ~256 MB packet, way above the 3 bytes VarInt max length
+    stream.insert(stream.end(), { 0xFF, 0xFF, 0xFF, 0x7F });
+    AppendPacket(stream, 10, 1);
+
+    LoopbackServer server;
+    std::atomic<int> received_packets = 0;
+    std::thread accept_thread(&LoopbackServer::Accept, &server, 1);
+    std::unique_ptr<TCP_Com> client = std::make_unique<TCP_Com>(server.GetAddress(),
+        [&](const unsigned char* data, const size_t length)
+        {
+            received_packets += 1;
+        });
+    accept_thread.join();
+
+    server.SendRaw(stream);
+    // Connection is closed without reading anything after the invalid length
+    CHECK(server.WaitClosed(std::chrono::seconds(10)));
+    CHECK(received_packets == 1);
+
+    client->close();
+    client.reset();
+}
+
+TEST_CASE("Packet framing benchmark", "[.][benchmark]")
+{
+    int num_packets = 0;
+    const std::vector<unsigned char> stream = CreateLoginAndChunksStream(1000, num_packets);
+
+    auto run = [&](const bool encrypted)
+    {
+        LoopbackServer server;
+        std::atomic<int> received_packets = 0;
+        std::atomic<size_t> received_bytes = 0;
+        std::thread accept_thread(&LoopbackServer::Accept, &server, 1);
+        std::unique_ptr<TCP_Com> client = std::make_unique<TCP_Com>(server.GetAddress(),
+            [&](const unsigned char* data, const size_t length)
+            {
+                received_bytes += length;
+                received_packets += 1;
+            });
+        accept_thread.join();
+
+#ifdef USE_ENCRYPTION
+        const std::vector<unsigned char> shared_secret = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F };
+        std::shared_ptr<AESEncrypter> server_encrypter = std::make_shared<AESEncrypter>();
+        server_encrypter->InitContexts(shared_secret);
+        if (encrypted)
+        {
+            std::shared_ptr<AESEncrypter> client_encrypter = std::make_shared<AESEncrypter>();
+            client_encrypter->InitContexts(shared_secret);
+            client->SetEncrypter(client_encrypter);
+        }
+        std::vector<unsigned char> encrypted_stream;
+#endif
+
+        int expected = 0;
+        double total_seconds = 0.0;
+        BENCHMARK(encrypted ? "Login + 1000 chunks stream, encrypted" : "Login + 1000 chunks stream")
+        {
+            expected += num_packets;
+#ifdef USE_ENCRYPTION
+            if (encrypted)
+            {
+                // Server side encryption is not part of the measured time
+                encrypted_stream = stream;
+                server_encrypter->Encrypt(encrypted_stream.data(), encrypted_stream.size());
+            }
+#endif
+            const auto start = std::chrono::steady_clock::now();
+#ifdef USE_ENCRYPTION
+            server.SendRaw(encrypted ? encrypted_stream : stream);
+#else
+            server.SendRaw(stream);
+#endif
+            while (received_packets < expected)
+            {
+                std::this_thread::yield();
+            }
+            total_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            return received_packets.load();
+        };
+
+        WARN((encrypted ? "Encrypted framing" : "Framing") << " throughput: " << received_bytes / 1048576.0 / total_seconds << " MB/s");
+        client->close();
+    };
+
+    run(false);
+#ifdef USE_ENCRYPTION
+    run(true);
+#endif
+}
+
+#ifdef USE_ENCRYPTION
+TEST_CASE("AES in place")
+{
+    const std::vector<unsigned char> shared_secret = { 0x10, 0x21, 0x32, 0x43, 0x54, 0x65, 0x76, 0x87, 0x98, 0xA9, 0xBA, 0xCB, 0xDC, 0xED, 0xFE, 0x0F };
+    AESEncrypter reference;
+    reference.InitContexts(shared_secret);
+    AESEncrypter in_place;
+    in_place.InitContexts(shared_secret);
+
+    std::vector<unsigned char> data(10000);
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        data[i] = static_cast<unsigned char>(i * 7 + 3);
+    }
+
+    const std::vector<unsigned char> expected = reference.Encrypt(data);
+    REQUIRE(expected.size() == data.size());
+
+    // Irregular pieces, as CFB8 state must carry over between calls
+    std::vector<unsigned char> encrypted = data;
+    size_t offset = 0;
+    size_t piece_size = 1;
+    while (offset < encrypted.size())
+    {
+        const size_t length = std::min(piece_size, encrypted.size() - offset);
+        in_place.Encrypt(encrypted.data() + offset, length);
+        offset += length;
+        piece_size = piece_size * 2 + 1;
+    }
+    CHECK(encrypted == expected);
+
+    in_place.Decrypt(encrypted.data(), encrypted.size());
+    CHECK(encrypted == data);
+}
+
+TEST_CASE("Encrypted packet framing")
+{
+    const std::vector<int> sizes = { 1, 10, 127, 128, 1000, 16383, 16384, 70000, 300000, 2, 65536, 3 };
+    std::vector<unsigned char> stream;
+    for (size_t i = 0; i < sizes.size(); ++i)
+    {
+        AppendPacket(stream, sizes[i], static_cast<int>(i));
+    }
+
+    const std::vector<unsigned char> shared_secret = { 0xFF, 0x01, 0xFE, 0x02, 0xFD, 0x03, 0xFC, 0x04, 0xFB, 0x05, 0xFA, 0x06, 0xF9, 0x07, 0xF8, 0x08 };
+    AESEncrypter server_encrypter;
+    server_encrypter.InitContexts(shared_secret);
+    server_encrypter.Encrypt(stream.data(), stream.size());
+
+    LoopbackServer server;
+    std::mutex mutex_received;
+    std::vector<std::vector<unsigned char> > received;
+    std::thread accept_thread(&LoopbackServer::Accept, &server, 1);
+    std::unique_ptr<TCP_Com> client = std::make_unique<TCP_Com>(server.GetAddress(),
+        [&](const unsigned char* data, const size_t length)
+        {
+            std::scoped_lock<std::mutex> lock(mutex_received);
+            received.emplace_back(data, data + length);
+        });
+    accept_thread.join();
+    std::shared_ptr<AESEncrypter> client_encrypter = std::make_shared<AESEncrypter>();
+    client_encrypter->InitContexts(shared_secret);
+    client->SetEncrypter(client_encrypter);
+
+    size_t offset = 0;
+    size_t piece_size = 1;
+    while (offset < stream.size())
+    {
+        const size_t length = std::min(piece_size, stream.size() - offset);
+        server.SendRaw(std::vector<unsigned char>(stream.begin() + offset, stream.begin() + offset + length));
+        offset += length;
+        piece_size = piece_size * 3 + 1;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - start < std::chrono::seconds(10))
+    {
+        std::scoped_lock<std::mutex> lock(mutex_received);
+        if (received.size() == sizes.size())
+        {
+            break;
+        }
+    }
+    client->close();
+    client.reset();
+
+    REQUIRE(received.size() == sizes.size());
+    for (size_t i = 0; i < sizes.size(); ++i)
+    {
+        REQUIRE(received[i].size() == sizes[i]);
+        bool content_ok = true;
+        for (int j = 0; j < sizes[i]; ++j)
+        {
+            content_ok &= received[i][j] == static_cast<unsigned char>(j + i);
+        }
+        REQUIRE(content_ok);
+    }
+}
+#endif
+
+TEST_CASE("Packet buffer pool")
+{
+    PacketBufferPool pool;
+
+    // Same pattern as NetworkManager: the network thread acquires a
+    // buffer per packet, the processing thread releases it, with a
+    // few packets waiting in the queue in between
+    auto run_stream = [&pool]()
+    {
+        std::vector<std::vector<unsigned char> > in_flight;
+        for (int i = 0; i < 200; ++i)
+        {
+            const size_t size = i % 9 == 0 ? 20000 + (i * 7919) % 60000 : 10 + i % 40;
+            std::vector<unsigned char> buffer = pool.Acquire(size);
+            REQUIRE(buffer.empty());
+            REQUIRE(buffer.capacity() >= size);
+            buffer.resize(size);
+            in_flight.push_back(std::move(buffer));
+            if (in_flight.size() > 4)
+            {
+                pool.Release(std::move(in_flight.front()));
+                in_flight.erase(in_flight.begin());
+            }
+        }
+        for (auto& b : in_flight)
+        {
+            pool.Release(std::move(b));
+        }
+    };
+
+    // Warm up, buffers are created and grown
+    run_stream();
+    run_stream();
+    const size_t warm_allocations = pool.GetNumAllocations();
+    CHECK(warm_allocations > 0);
+    CHECK(pool.GetNumPooled() > 0);
+
+    // Steady state, every buffer is recycled
+    for (int i = 0; i < 10; ++i)
+    {
+        run_stream();
+    }
+    CHECK(pool.GetNumAllocations() == warm_allocations);
+    CHECK(pool.GetNumAcquired() == 12 * 200);
+
+    SECTION("Oversized buffers are not kept")
+    {
+        PacketBufferPool small_pool(2, 1024);
+        small_pool.Release(small_pool.Acquire(4096));
+        CHECK(small_pool.GetNumPooled() == 0);
+        small_pool.Release(small_pool.Acquire(512));
+        small_pool.Release(small_pool.Acquire(512));
+        CHECK(small_pool.GetNumPooled() == 1);
+        CHECK(small_pool.GetNumAllocations() == 2);
+    }
+}
+
+#ifdef USE_COMPRESSION
+TEST_CASE("Compression context")
+{
+    std::vector<unsigned char> raw(100000);
+    for (size_t i = 0; i < raw.size(); ++i)
+    {
+        raw[i] = static_cast<unsigned char>((i * i) % 251);
+    }
+
+    CompressionContext context;
+    PacketBufferPool pool;
+
+    SECTION("Reused streams")
+    {
+        std::vector<unsigned char> compressed;
+        context.Compress(raw.data(), raw.size(), compressed);
+        REQUIRE(compressed.size() < raw.size());
+
+        for (int i = 0; i < 3; ++i)
+        {
+            std::vector<unsigned char> decompressed = pool.Acquire(raw.size());
+            decompressed.resize(raw.size());
+            context.Decompress(compressed.data(), compressed.size(), decompressed);
+            REQUIRE(decompressed == raw);
+            pool.Release(std::move(decompressed));
+        }
+        CHECK(pool.GetNumAllocations() == 1);
+    }
+
+    SECTION("Compressed data are appended")
+    {
+        std::vector<unsigned char> compressed = { 0x01, 0x02 };
+        context.Compress(raw.data(), raw.size(), compressed);
+        context.Compress(raw.data(), 1000, compressed);
+        REQUIRE(compressed[0] == 0x01);
+        REQUIRE(compressed[1] == 0x02);
+
+        std::vector<unsigned char> decompressed(raw.size());
+        // Inflate stops at the end of the first stream
+        context.Decompress(compressed.data() + 2, compressed.size() - 2, decompressed);
+        CHECK(decompressed == raw);
+    }
+
+    SECTION("Compression levels")
+    {
+        std::vector<unsigned char> fast;
+        std::vector<unsigned char> best;
+        context.SetCompressionLevel(1);
+        CHECK(context.GetCompressionLevel() == 1);
+        context.Compress(raw.data(), raw.size(), fast);
+        context.SetCompressionLevel(9);
+        context.Compress(raw.data(), raw.size(), best);
+        CHECK(best.size() <= fast.size());
+
+        std::vector<unsigned char> stored;
+        context.SetCompressionLevel(0);
+        context.Compress(raw.data(), raw.size(), stored);
+        CHECK(stored.size() > raw.size());
+
+        for (const auto* compressed : { &fast, &best, &stored })
+        {
+            std::vector<unsigned char> decompressed(raw.size());
+            context.Decompress(compressed->data(), compressed->size(), decompressed);
+            CHECK(decompressed == raw);
+        }
+
+        CHECK_THROWS(context.SetCompressionLevel(10));
+        CHECK_THROWS(CompressionContext(-2));
+    }
+
+    SECTION("Wrong decompressed size")
+    {
+        std::vector<unsigned char> compressed;
+        context.Compress(raw.data(), raw.size(), compressed);
+
+        std::vector<unsigned char> too_big(raw.size() + 1);
+        CHECK_THROWS(context.Decompress(compressed.data(), compressed.size(), too_big));
+        std::vector<unsigned char> too_small(raw.size() - 1);
+        CHECK_THROWS(context.Decompress(compressed.data(), compressed.size(), too_small));
+
+        // Context is still usable after an error
+        std::vector<unsigned char> decompressed(raw.size());
+        context.Decompress(compressed.data(), compressed.size(), decompressed);
+        CHECK(decompressed == raw);
+    }
+}
+
+TEST_CASE("Compression context benchmark", "[.][benchmark]")
+{
+    // Looks like a chunk packet: a lot of repeated palette indices
+    std::vector<unsigned char> raw(60000);
+    for (size_t i = 0; i < raw.size(); ++i)
+    {
+        raw[i] = static_cast<unsigned char>((i / 64) % 7 == 0 ? i % 13 : 0);
+    }
+
+    CompressionContext context;
+    // Small entity update packet and big chunk packet
+    for (const size_t size : { 300, 60000 })
+    {
+        std::vector<unsigned char> compressed;
+        context.Compress(raw.data(), size, compressed);
+        std::vector<unsigned char> decompressed(size);
+
+        BENCHMARK("Decompress " + std::to_string(size) + " bytes, persistent context")
+        {
+            context.Decompress(compressed.data(), compressed.size(), decompressed);
+            return decompressed[0];
+        };
+
+        BENCHMARK("Decompress " + std::to_string(size) + " bytes, new context per packet")
+        {
+            CompressionContext new_context;
+            new_context.Decompress(compressed.data(), compressed.size(), decompressed);
+            return decompressed[0];
+        };
+    }
+
+    for (const int level : { 1, 6, 9 })
+    {
+        context.SetCompressionLevel(level);
+        std::vector<unsigned char> output;
+        output.reserve(raw.size());
+        BENCHMARK("Compress, level " + std::to_string(level))
+        {
+            output.clear();
+            context.Compress(raw.data(), raw.size(), output);
+            return output.size();
+        };
+        WARN("Compression level " << level << ": " << raw.size() << " --> " << output.size() << " bytes");
+    }
+}
+#endif
+
+TEST_CASE("SPSC queue")
+{
+    SECTION("Single thread")
+    {
+        Utilities::SPSCQueue<int> queue(3);
+        CHECK(queue.Capacity() == 4);
+        CHECK(queue.Empty());
+
+        int value = 0;
+        CHECK_FALSE(queue.TryPop(value));
+        for (int i = 0; i < 4; ++i)
+        {
+            CHECK(queue.TryPush(std::move(i)));
+        }
+        int extra = 4;
+        CHECK_FALSE(queue.TryPush(std::move(extra)));
+        CHECK(queue.Size() == 4);
+
+        for (int i = 0; i < 4; ++i)
+        {
+            REQUIRE(queue.TryPop(value));
+            CHECK(value == i);
+        }
+        CHECK_FALSE(queue.TryPop(value));
+        CHECK(queue.Empty());
+    }
+
+    SECTION("Two threads")
+    {
+        Utilities::SPSCQueue<std::vector<unsigned char> > queue(16);
+        const int num_items = 100000;
+
+        std::thread producer([&]()
+            {
+                for (int i = 0; i < num_items; ++i)
+                {
+                    std::vector<unsigned char> item(sizeof(i));
+                    std::memcpy(item.data(), &i, sizeof(i));
+                    while (!queue.TryPush(std::move(item)))
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+
+        bool in_order = true;
+        for (int i = 0; i < num_items; ++i)
+        {
+            std::vector<unsigned char> item;
+            while (!queue.TryPop(item))
+            {
+                std::this_thread::yield();
+            }
+            int value;
+            std::memcpy(&value, item.data(), sizeof(value));
+            in_order &= value == i;
+        }
+        producer.join();
+
+        CHECK(in_order);
+        CHECK(queue.Empty());
+    }
+}
+
+TEST_CASE("SPSC queue benchmark", "[.][benchmark]")
+{
+    const int num_items = 100000;
+
+    BENCHMARK("Mutex + condition_variable queue")
+    {
+        std::deque<std::vector<unsigned char> > queue;
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::thread producer([&]()
+            {
+                for (int i = 0; i < num_items; ++i)
+                {
+                    std::vector<unsigned char> item(16);
+                    {
+                        std::scoped_lock<std::mutex> lock(mutex);
+                        queue.push_back(std::move(item));
+                    }
+                    condition.notify_all();
+                }
+            });
+        size_t received = 0;
+        for (int i = 0; i < num_items; ++i)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [&]() { return !queue.empty(); });
+            received += queue.front().size();
+            queue.pop_front();
+        }
+        producer.join();
+        return received;
+    };
+
+    BENCHMARK("SPSC queue")
+    {
+        Utilities::SPSCQueue<std::vector<unsigned char> > queue(1024);
+        std::thread producer([&]()
+            {
+                for (int i = 0; i < num_items; ++i)
+                {
+                    std::vector<unsigned char> item(16);
+                    while (!queue.TryPush(std::move(item)))
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        size_t received = 0;
+        for (int i = 0; i < num_items; ++i)
+        {
+            std::vector<unsigned char> item;
+            while (!queue.TryPop(item))
+            {
+                std::this_thread::yield();
+            }
+            received += item.size();
+        }
+        producer.join();
+        return received;
+    };
+}
+
+TEST_CASE("NetworkManager packet queue")
+{
+    const int num_packets = 5000;
+
+    LoopbackServer server;
+    std::thread accept_thread(&LoopbackServer::Accept, &server, 1);
+    // Offline login, the server never answers, so we stay in Login state
+    NetworkManager manager(server.GetAddress(), "BCTest", false);
+    accept_thread.join();
+
+    // Unknown login packet ids, they are received and queued but not parsed
+    std::vector<unsigned char> stream;
+    for (int i = 0; i < num_packets; ++i)
+    {
+        ProtocolCraft::WriteData<ProtocolCraft::VarInt>(3, stream);
+        ProtocolCraft::WriteData<ProtocolCraft::VarInt>(0x7F, stream);
+        stream.push_back(static_cast<unsigned char>(i));
+        stream.push_back(static_cast<unsigned char>(i >> 8));
+    }
+    server.SendRaw(stream);
+
+    const auto start = std::chrono::steady_clock::now();
+    PacketQueueMetrics metrics = manager.GetPacketQueueMetrics();
+    while (metrics.num_packets < num_packets || metrics.depth > 0)
+    {
+        if (std::chrono::steady_clock::now() - start > std::chrono::seconds(10))
+        {
+            break;
+        }
+        std::this_thread::yield();
+        metrics = manager.GetPacketQueueMetrics();
+    }
+
+    CHECK(metrics.num_packets == num_packets);
+    CHECK(metrics.depth == 0);
+    CHECK(metrics.max_depth > 0);
+    CHECK(metrics.max_depth <= num_packets);
+    CHECK(metrics.capacity > 0);
+    // Every buffer has been given back to the pool
+    CHECK(manager.GetPacketBufferPool().GetNumAcquired() == num_packets);
+
+    manager.Close();
+}
+
+namespace
+{
+    /// @brief Count all received packets
+    class CountingHandler : public ProtocolCraft::Handler
+    {
+    public:
+        std::atomic<int> num_received = 0;
+
+    protected:
+        virtual void Handle(ProtocolCraft::Message& msg) override
+        {
+            num_received += 1;
+        }
+    };
+
+    /// @brief Only handle login disconnect packets
+    class DisconnectHandler : public ProtocolCraft::Handler
+    {
+    public:
+        PacketFilter GetPacketFilter() const
+        {
+            return HANDLED_PACKETS_FILTER(DisconnectHandler);
+        }
+
+        std::atomic<int> num_disconnect = 0;
+
+    protected:
+        virtual void Handle(ProtocolCraft::ClientboundLoginDisconnectPacket& msg) override
+        {
+            num_disconnect += 1;
+        }
+    };
+}
+
+TEST_CASE("Packet filter")
+{
+    using namespace ProtocolCraft;
+
+    SECTION("Empty")
+    {
+        const PacketFilter filter;
+        CHECK_FALSE(filter.IsAll());
+        CHECK_FALSE(filter.Contains(ConnectionState::Play, ClientboundKeepAlivePacket::packet_id));
+    }
+
+    SECTION("All")
+    {
+        const PacketFilter filter = PacketFilter::All();
+        CHECK(filter.IsAll());
+        CHECK(filter.Contains(ConnectionState::Login, ClientboundLoginDisconnectPacket::packet_id));
+        CHECK(filter.Contains(ConnectionState::Play, ClientboundKeepAlivePacket::packet_id));
+    }
+
+    SECTION("Of")
+    {
+        PacketFilter filter = PacketFilter::Of<ClientboundKeepAlivePacket, ClientboundLoginDisconnectPacket>();
+        CHECK_FALSE(filter.IsAll());
+        CHECK(filter.Contains(ConnectionState::Play, ClientboundKeepAlivePacket::packet_id));
+        CHECK(filter.Contains(ConnectionState::Login, ClientboundLoginDisconnectPacket::packet_id));
+        // Same id, different state
+        CHECK_FALSE(filter.Contains(ConnectionState::Status, ClientboundLoginDisconnectPacket::packet_id));
+        CHECK_FALSE(filter.Contains(ConnectionState::Play, ClientboundSetTimePacket::packet_id));
+
+        filter |= PacketFilter::Of<ClientboundSetTimePacket>();
+        CHECK(filter.Contains(ConnectionState::Play, ClientboundSetTimePacket::packet_id));
+        CHECK(filter.Contains(ConnectionState::Play, ClientboundKeepAlivePacket::packet_id));
+
+        filter.Remove(ConnectionState::Play, ClientboundKeepAlivePacket::packet_id);
+        filter.Remove(ConnectionState::Status, 0x7F);
+        CHECK_FALSE(filter.Contains(ConnectionState::Play, ClientboundKeepAlivePacket::packet_id));
+        CHECK(filter.Contains(ConnectionState::Play, ClientboundSetTimePacket::packet_id));
+    }
+
+    SECTION("Skip light data")
+    {
+        PacketFilter filter;
+        CHECK_FALSE(filter.GetSkipLightData());
+        filter.SetSkipLightData(true);
+        PacketFilter other;
+        other.SetSkipLightData(true);
+        filter |= other;
+        CHECK(filter.GetSkipLightData());
+        // Needed as soon as one filter needs it
+        filter |= PacketFilter();
+        CHECK_FALSE(filter.GetSkipLightData());
+    }
+
+    SECTION("Handle overloads")
+    {
+        const PacketFilter filter = DisconnectHandler().GetPacketFilter();
+        CHECK_FALSE(filter.IsAll());
+        CHECK(filter.Contains(ConnectionState::Login, ClientboundLoginDisconnectPacket::packet_id));
+        CHECK_FALSE(filter.Contains(ConnectionState::Play, ClientboundKeepAlivePacket::packet_id));
+
+        const PacketFilter world_filter = World(false).GetPacketFilter();
+        CHECK_FALSE(world_filter.IsAll());
+        CHECK(world_filter.Contains(ConnectionState::Play, ClientboundBlockUpdatePacket::packet_id));
+        CHECK_FALSE(world_filter.Contains(ConnectionState::Play, ClientboundKeepAlivePacket::packet_id));
+
+        const PacketFilter entity_filter = EntityManager().GetPacketFilter();
+        CHECK(entity_filter.Contains(ConnectionState::Play, ClientboundAddEntityPacket::packet_id));
+        CHECK_FALSE(entity_filter.Contains(ConnectionState::Play, ClientboundBlockUpdatePacket::packet_id));
+    }
+}
+
+TEST_CASE("NetworkManager filtered dispatch")
+{
+    const int num_packets = 100;
+
+    LoopbackServer server;
+    std::thread accept_thread(&LoopbackServer::Accept, &server, 1);
+    // Offline login, the server never answers, so we stay in Login state
+    NetworkManager manager(server.GetAddress(), "BCTest", false);
+    accept_thread.join();
+
+    CountingHandler all_handler;
+    CountingHandler no_packet_handler;
+    DisconnectHandler disconnect_handler;
+    manager.AddHandler(&all_handler);
+    manager.AddHandler(&no_packet_handler, PacketFilter());
+    manager.AddHandler(&disconnect_handler, disconnect_handler.GetPacketFilter());
+
+    std::vector<unsigned char> disconnect_packet;
+    ProtocolCraft::WriteData<ProtocolCraft::VarInt>(ProtocolCraft::ClientboundLoginDisconnectPacket::packet_id, disconnect_packet);
+    ProtocolCraft::WriteData<std::string>("{\"text\":\"test\"}", disconnect_packet);
+
+    std::vector<unsigned char> stream;
+    for (int i = 0; i < num_packets; ++i)
+    {
+        ProtocolCraft::WriteData<ProtocolCraft::VarInt>(static_cast<int>(disconnect_packet.size()), stream);
+        stream.insert(stream.end(), disconnect_packet.begin(), disconnect_packet.end());
+    }
+    server.SendRaw(stream);
+
+    const auto start = std::chrono::steady_clock::now();
+    while (disconnect_handler.num_disconnect < num_packets || all_handler.num_received < num_packets)
+    {
+        if (std::chrono::steady_clock::now() - start > std::chrono::seconds(10))
+        {
+            break;
+        }
+        std::this_thread::yield();
+    }
+
+    CHECK(disconnect_handler.num_disconnect == num_packets);
+    CHECK(all_handler.num_received == num_packets);
+    CHECK(no_packet_handler.num_received == 0);
+
+    manager.Close();
+}
@@ -0,0 +1,626 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <botcraft/AI/PathfindingGraph.hpp>
+#include <botcraft/AI/PathfindingGrid.hpp>
+#include <botcraft/AI/PathfindingReplanner.hpp>
+#include <botcraft/AI/PathfindingSearch.hpp>
+#include <botcraft/AI/PathfindingService.hpp>
+#include <botcraft/AI/Tasks/PathfindingTask.hpp>
+#include <botcraft/Game/World/World.hpp>
+
+using namespace Botcraft;
+
+namespace
+{
+#if PROTOCOL_VERSION < 347 /* < 1.13 */
+    const BlockstateId air_id = { 0, 0 };
+    const BlockstateId stone_id = { 1, 0 };
+#else
+    const BlockstateId air_id = 0;
+    const BlockstateId stone_id = 1;
+#endif
+
+    /// @brief Load all chunks between min and max (included) with a stone floor at y = 0
+    /// @param world World to initialize
+    /// @param min_chunk Min chunk coordinate on both axis
+    /// @param max_chunk Max chunk coordinate on both axis
+    void InitFlatWorld(World& world, const int min_chunk, const int max_chunk)
+    {
+#if PROTOCOL_VERSION < 719 /* < 1.16 */
+        const Dimension dimension = Dimension::Overworld;
+#else
+        const std::string dimension = "minecraft:overworld";
+#endif
+
+#if PROTOCOL_VERSION > 756 /* > 1.17.1 */
+        world.SetDimensionMinY(dimension, 0);
+        world.SetDimensionHeight(dimension, 256);
+#endif
+        world.SetCurrentDimension(dimension);
+
+        for (int chunk_x = min_chunk; chunk_x <= max_chunk; ++chunk_x)
+        {
+            for (int chunk_z = min_chunk; chunk_z <= max_chunk; ++chunk_z)
+            {
+                world.LoadChunk(chunk_x, chunk_z, dimension);
+                for (int x = 0; x < CHUNK_WIDTH; ++x)
+                {
+                    for (int z = 0; z < CHUNK_WIDTH; ++z)
+                    {
+                        world.SetBlock(Position(chunk_x * CHUNK_WIDTH + x, 0, chunk_z * CHUNK_WIDTH + z), stone_id);
+                    }
+                }
+            }
+        }
+    }
+
+    /// @brief Add a 3 blocks high wall on the floor
+    void AddWall(World& world, const int x, const int z)
+    {
+        for (int y = 1; y < 4; ++y)
+        {
+            world.SetBlock(Position(x, y, z), stone_id);
+        }
+    }
+
+    /// @brief Check that all the positions of a path can be reached from the previous one
+    bool IsValidPath(World& world, const Position& start, const std::vector<Position>& path)
+    {
+        PathfindingGrid grid(world, true);
+        std::vector<std::pair<Position, float>> neighbours;
+        Position previous = start;
+        for (const Position& p : path)
+        {
+            neighbours.clear();
+            grid.GetNeighbours(previous, true, neighbours);
+            if (std::none_of(neighbours.begin(), neighbours.end(), [&](const std::pair<Position, float>& n) { return n.first == p; }))
+            {
+                return false;
+            }
+            previous = p;
+        }
+        return true;
+    }
+
+    /// @brief Carve a random maze with corridors of 1 block, cells are on even coordinates in [0, 2 * size - 1]
+    /// @return Walls positions
+    std::vector<std::pair<int, int> > CreateMaze(const int size, const unsigned int seed)
+    {
+        std::vector<bool> is_wall((2 * size + 1) * (2 * size + 1), true);
+        std::vector<bool> visited(size * size, false);
+        std::mt19937 random_engine(seed);
+
+        std::vector<std::pair<int, int> > stack = { { 0, 0 } };
+        visited[0] = true;
+        is_wall[1 * (2 * size + 1) + 1] = false;
+        while (!stack.empty())
+        {
+            const auto [cx, cz] = stack.back();
+            std::vector<std::pair<int, int> > next;
+            for (const auto& [dx, dz] : { std::pair<int, int>{ 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } })
+            {
+                const int nx = cx + dx;
+                const int nz = cz + dz;
+                if (nx >= 0 && nx < size && nz >= 0 && nz < size && !visited[nx * size + nz])
+                {
+                    next.push_back({ nx, nz });
+                }
+            }
+            if (next.empty())
+            {
+                stack.pop_back();
+                continue;
+            }
+            const auto [nx, nz] = next[random_engine() % next.size()];
+            visited[nx * size + nz] = true;
+            is_wall[(2 * nx + 1) * (2 * size + 1) + 2 * nz + 1] = false;
+            is_wall[(cx + nx + 1) * (2 * size + 1) + cz + nz + 1] = false;
+            stack.push_back({ nx, nz });
+        }
+
+        std::vector<std::pair<int, int> > walls;
+        for (int x = 0; x < 2 * size + 1; ++x)
+        {
+            for (int z = 0; z < 2 * size + 1; ++z)
+            {
+                if (is_wall[x * (2 * size + 1) + z])
+                {
+                    // Shift so cells are on even coordinates starting at 0
+                    walls.push_back({ x - 1, z - 1 });
+                }
+            }
+        }
+        return walls;
+    }
+}
+
+TEST_CASE("Pathfinding search")
+{
+    PathfindingSearch search;
+    CHECK(search.IsOpenEmpty());
+
+    CHECK(search.Push(Position(0, 0, 0), 0.0f, 10.0f, PathfindingSearch::invalid_index));
+    CHECK(search.PopBest() == 0);
+    CHECK(search.IsOpenEmpty());
+
+    CHECK(search.Push(Position(1, 0, 0), 1.0f, 9.0f, 0));
+    CHECK(search.Push(Position(0, 0, 1), 1.0f, 5.0f, 0));
+    CHECK(search.Push(Position(0, -1, 0), 1.0f, 7.0f, 0));
+    CHECK(search.GetNumNodes() == 4);
+    CHECK(search.FindNode(Position(0, -1, 0)) == 3);
+    CHECK(search.FindNode(Position(5, 5, 5)) == PathfindingSearch::invalid_index);
+
+    SECTION("Ordering and decrease key")
+    {
+        // Worse path, ignored
+        CHECK_FALSE(search.Push(Position(1, 0, 0), 2.0f, 9.0f, 0));
+        // Better path, moves before the others
+        CHECK(search.Push(Position(1, 0, 0), 0.5f, 0.0f, 0));
+        CHECK(search.GetNode(1).cost == 0.5f);
+        CHECK(search.PopBest() == 1);
+        CHECK(search.PopBest() == 2);
+        CHECK(search.PopBest() == 3);
+        CHECK(search.IsOpenEmpty());
+
+        // A closed node goes back in the open set if a better path is found
+        CHECK(search.Push(Position(0, 0, 1), 0.25f, 5.0f, 1));
+        CHECK_FALSE(search.IsOpenEmpty());
+        CHECK(search.PopBest() == 2);
+        CHECK(search.GetNode(2).parent == 1);
+    }
+
+    SECTION("Path")
+    {
+        CHECK(search.Push(Position(0, 0, 2), 2.0f, 1.0f, 2));
+        CHECK(search.GetPath(4) == std::vector<Position>{ Position(0, 0, 1), Position(0, 0, 2) });
+        // Path to the start only contains the start
+        CHECK(search.GetPath(0) == std::vector<Position>{ Position(0, 0, 0) });
+    }
+
+    SECTION("Many nodes")
+    {
+        // Force the table to grow and nodes to be sorted by the heap
+        std::mt19937 random_engine(42);
+        std::uniform_real_distribution<float> score(0.0f, 1000.0f);
+        for (int i = 0; i < 20000; ++i)
+        {
+            search.Push(Position(i % 100 - 50, i / 10000 - 64, i / 100 % 100 - 50), 1.0f, score(random_engine), 0);
+        }
+        CHECK(search.GetNumNodes() == 20004);
+        CHECK(search.FindNode(Position(-50, -63, -50)) == 10004);
+
+        float previous_score = 0.0f;
+        bool sorted = true;
+        while (!search.IsOpenEmpty())
+        {
+            const float current_score = search.GetNode(search.PopBest()).score;
+            sorted &= current_score >= previous_score;
+            previous_score = current_score;
+        }
+        CHECK(sorted);
+
+        search.Clear();
+        CHECK(search.GetNumNodes() == 0);
+        CHECK(search.FindNode(Position(-50, -63, -50)) == PathfindingSearch::invalid_index);
+
+        // Small searches after a big one
+        for (int n = 0; n < 3; ++n)
+        {
+            for (int i = 0; i < 100; ++i)
+            {
+                CHECK(search.Push(Position(i, n, 0), 1.0f, 0.0f, 0));
+            }
+            CHECK(search.GetNumNodes() == 100);
+            CHECK(search.FindNode(Position(42, n, 0)) == 42);
+            CHECK(search.FindNode(Position(42, n - 1, 0)) == PathfindingSearch::invalid_index);
+            CHECK(search.FindNode(Position(-50, -63, -50)) == PathfindingSearch::invalid_index);
+            search.Clear();
+        }
+    }
+}
+
+TEST_CASE("Pathfinding grid")
+{
+    World world = World(false);
+    InitFlatWorld(world, -1, 0);
+    AddWall(world, -3, 5);
+
+    PathfindingGrid grid(world, true);
+    CHECK(grid.GetState(Position(-3, 0, 5)) == BlockPathfindingState::Solid);
+    CHECK(grid.IsSolid(Position(-3, 0, 5)));
+    CHECK(grid.GetState(Position(-3, 3, 5)) == BlockPathfindingState::Solid);
+    CHECK(grid.GetState(Position(-3, 4, 5)) == BlockPathfindingState::Empty);
+    CHECK_FALSE(grid.IsSolid(Position(-3, 4, 5)));
+    // Not loaded
+    CHECK(grid.GetState(Position(20, 0, 0)) == BlockPathfindingState::Empty);
+    CHECK(grid.GetNumSectionReads() == 2);
+
+    // All the blocks of a section come from a single read
+    for (int x = -16; x < 0; ++x)
+    {
+        for (int y = 0; y < 16; ++y)
+        {
+            for (int z = 0; z < 16; ++z)
+            {
+                grid.GetState(Position(x, y, z));
+            }
+        }
+    }
+    CHECK(grid.GetNumSectionReads() == 2);
+
+    // Changes after the read are not seen
+    world.SetBlock(Position(-3, 4, 5), stone_id);
+    CHECK(grid.GetState(Position(-3, 4, 5)) == BlockPathfindingState::Empty);
+}
+
+TEST_CASE("Find path")
+{
+    World world = World(false);
+    InitFlatWorld(world, -1, 1);
+
+    SECTION("Straight line")
+    {
+        const std::vector<Position> path = FindPath(world, Position(0, 1, 0), Position(10, 1, 0), 0, 0, 0, true, true);
+        REQUIRE(path.size() == 10);
+        CHECK(path.front() == Position(1, 1, 0));
+        CHECK(path.back() == Position(10, 1, 0));
+    }
+
+    SECTION("Wall with a hole")
+    {
+        for (int z = -CHUNK_WIDTH; z < 2 * CHUNK_WIDTH; ++z)
+        {
+            if (z != 7)
+            {
+                AddWall(world, 5, z);
+            }
+        }
+        const std::vector<Position> path = FindPath(world, Position(0, 1, 0), Position(10, 1, 0), 0, 0, 0, true, true);
+        REQUIRE_FALSE(path.empty());
+        CHECK(path.back() == Position(10, 1, 0));
+        CHECK(std::find(path.begin(), path.end(), Position(5, 1, 7)) != path.end());
+        // No diagonal moves, 12 blocks to the hole and 12 back
+        CHECK(path.size() == 24);
+    }
+
+    SECTION("Unreachable goal")
+    {
+        for (int x = 8; x < 13; ++x)
+        {
+            for (int z = -2; z < 3; ++z)
+            {
+                if (x == 8 || x == 12 || z == -2 || z == 2)
+                {
+                    AddWall(world, x, z);
+                }
+            }
+        }
+        const std::vector<Position> path = FindPath(world, Position(0, 1, 0), Position(10, 1, 0), 0, 0, 0, true, true);
+        REQUIRE_FALSE(path.empty());
+        // Closest position to the goal
+        CHECK(path.back() == Position(7, 1, 0));
+    }
+}
+
+TEST_CASE("Pathfinding graph")
+{
+    World world = World(false);
+    InitFlatWorld(world, -1, 4);
+    // Wall across the whole world, with a single hole
+    for (int z = -CHUNK_WIDTH; z < 5 * CHUNK_WIDTH; ++z)
+    {
+        if (z != 40)
+        {
+            AddWall(world, 20, z);
+        }
+    }
+
+    PathfindingGraph graph;
+    const Position start(0, 1, 0);
+    const Position end(70, 1, 70);
+
+    // Same section, nothing to plan
+    CHECK(graph.FindPath(world, start, Position(10, 1, 10), true, true).empty());
+
+    const std::vector<Position> path = graph.FindPath(world, start, end, true, true);
+    REQUIRE_FALSE(path.empty());
+    // Stops when entering the section of the goal
+    CHECK(Position(path.back().x >> 4, path.back().y >> 4, path.back().z >> 4) == Position(4, 0, 4));
+    CHECK(std::find(path.begin(), path.end(), Position(20, 1, 40)) != path.end());
+    CHECK(IsValidPath(world, start, path));
+
+    const size_t num_clusters = graph.GetNumClusters();
+    CHECK(num_clusters > 0);
+
+    SECTION("Reuse")
+    {
+        CHECK(graph.FindPath(world, start, end, true, true) == path);
+        CHECK(graph.GetNumClusters() == num_clusters);
+    }
+
+    SECTION("Update")
+    {
+        // Move the hole
+        AddWall(world, 20, 40);
+        for (int y = 1; y < 4; ++y)
+        {
+            world.SetBlock(Position(20, y, 10), air_id);
+        }
+
+        const std::vector<Position> new_path = graph.FindPath(world, start, end, true, true);
+        REQUIRE_FALSE(new_path.empty());
+        CHECK(std::find(new_path.begin(), new_path.end(), Position(20, 1, 10)) != new_path.end());
+        CHECK(std::find(new_path.begin(), new_path.end(), Position(20, 1, 40)) == new_path.end());
+        CHECK(IsValidPath(world, start, new_path));
+    }
+
+    SECTION("Max clusters")
+    {
+        // Least recently used clusters are removed, but the search still has all it needs
+        PathfindingGraph small_graph(4);
+        CHECK(small_graph.FindPath(world, start, end, true, true) == path);
+        CHECK(small_graph.GetNumClusters() <= 4);
+    }
+
+    SECTION("Unreachable")
+    {
+        AddWall(world, 20, 40);
+
+        // Get as close as possible
+        const std::vector<Position> new_path = graph.FindPath(world, start, end, true, true);
+        REQUIRE_FALSE(new_path.empty());
+        CHECK(new_path.back().x < 20);
+        CHECK(IsValidPath(world, start, new_path));
+    }
+
+    graph.Clear();
+    CHECK(graph.GetNumClusters() == 0);
+}
+
+TEST_CASE("Pathfinding replanner")
+{
+    World world = World(false);
+    InitFlatWorld(world, -1, 1);
+
+    const Position start(0, 1, 0);
+    const Position goal(12, 1, 0);
+    PathfindingReplanner replanner(world, goal, true, true);
+
+    std::vector<Position> path = replanner.FindPath(start);
+    REQUIRE(path.size() == 12);
+    CHECK(path.back() == goal);
+    const int first_visits = replanner.GetNumLastVisits();
+
+    SECTION("Move start")
+    {
+        path = replanner.FindPath(Position(4, 1, 0));
+        CHECK(path.size() == 8);
+        CHECK(replanner.GetNumLastVisits() < first_visits);
+    }
+
+    SECTION("Block changes")
+    {
+        // Wall with a hole
+        for (int z = -CHUNK_WIDTH; z < 2 * CHUNK_WIDTH; ++z)
+        {
+            if (z != 5)
+            {
+                AddWall(world, 6, z);
+            }
+        }
+
+        path = replanner.FindPath(start);
+        REQUIRE_FALSE(path.empty());
+        CHECK(path.back() == goal);
+        CHECK(std::find(path.begin(), path.end(), Position(6, 1, 5)) != path.end());
+        CHECK(IsValidPath(world, start, path));
+        // As short as a search from scratch
+        CHECK(path.size() == FindPath(world, start, goal, 0, 0, 0, true, true).size());
+
+        // Close the hole
+        AddWall(world, 6, 5);
+        CHECK(replanner.FindPath(start).empty());
+
+        // Open it again
+        for (int y = 1; y < 4; ++y)
+        {
+            world.SetBlock(Position(6, y, 5), air_id);
+        }
+        path = replanner.FindPath(start);
+        REQUIRE_FALSE(path.empty());
+        CHECK(path.back() == goal);
+        CHECK(IsValidPath(world, start, path));
+    }
+
+    SECTION("Shortcut through unexplored positions")
+    {
+        // 3 blocks thick wall with a hole far from the straight line
+        for (int z = -CHUNK_WIDTH; z < 2 * CHUNK_WIDTH; ++z)
+        {
+            if (z != 10)
+            {
+                for (int x = 5; x < 8; ++x)
+                {
+                    AddWall(world, x, z);
+                }
+            }
+        }
+
+        PathfindingReplanner wall_replanner(world, goal, true, true);
+        path = wall_replanner.FindPath(start);
+        REQUIRE_FALSE(path.empty());
+        CHECK(path.size() > 12);
+
+        // Dig a tunnel, the positions inside were never reached by the search
+        for (int x = 5; x < 8; ++x)
+        {
+            for (int y = 1; y < 4; ++y)
+            {
+                world.SetBlock(Position(x, y, 0), air_id);
+            }
+        }
+        path = wall_replanner.FindPath(start);
+        CHECK(path.size() == 12);
+        CHECK(std::find(path.begin(), path.end(), Position(6, 1, 0)) != path.end());
+        CHECK(IsValidPath(world, start, path));
+    }
+}
+
+namespace
+{
+    void WaitDone(const PathfindingService::Request& request)
+    {
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        while (!request.IsDone() && std::chrono::steady_clock::now() - start < std::chrono::seconds(10))
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+TEST_CASE("Pathfinding service")
+{
+    World world = World(false);
+    InitFlatWorld(world, -1, 1);
+
+    PathfindingService service(2);
+    CHECK(service.GetNumThreads() == 0);
+
+    const int owner_a = 0;
+    const int owner_b = 1;
+
+    SECTION("Compute")
+    {
+        const std::shared_ptr<PathfindingService::Request> request = service.Submit(&owner_a, [&](const std::atomic<bool>& cancelled)
+            {
+                return FindPath(world, Position(0, 1, 0), Position(10, 1, 0), 0, 0, 0, true, true, 150000, &cancelled);
+            });
+        CHECK(service.GetNumThreads() == 2);
+        WaitDone(*request);
+        REQUIRE(request->IsDone());
+        CHECK_FALSE(request->IsCancelled());
+        REQUIRE(request->GetPath().size() == 10);
+        CHECK(request->GetPath().back() == Position(10, 1, 0));
+    }
+
+    SECTION("Replace")
+    {
+        // Search running until cancelled
+        const std::shared_ptr<PathfindingService::Request> first = service.Submit(&owner_a, [](const std::atomic<bool>& cancelled)
+            {
+                while (!cancelled)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                return std::vector<Position>{ Position(1, 1, 0) };
+            });
+        const std::shared_ptr<PathfindingService::Request> other = service.Submit(&owner_b, [](const std::atomic<bool>&)
+            {
+                return std::vector<Position>{ Position(2, 1, 0) };
+            });
+        const std::shared_ptr<PathfindingService::Request> second = service.Submit(&owner_a, [](const std::atomic<bool>&)
+            {
+                return std::vector<Position>{ Position(3, 1, 0) };
+            });
+
+        WaitDone(*first);
+        WaitDone(*other);
+        WaitDone(*second);
+        REQUIRE(first->IsDone());
+        CHECK(first->IsCancelled());
+        CHECK(first->GetPath().empty());
+        REQUIRE(other->IsDone());
+        CHECK_FALSE(other->IsCancelled());
+        CHECK(other->GetPath() == std::vector<Position>{ Position(2, 1, 0) });
+        REQUIRE(second->IsDone());
+        CHECK(second->GetPath() == std::vector<Position>{ Position(3, 1, 0) });
+    }
+
+    SECTION("Cancel")
+    {
+        const std::shared_ptr<PathfindingService::Request> request = service.Submit(&owner_a, [&](const std::atomic<bool>& cancelled)
+            {
+                while (!cancelled)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                // Cancelled searches return an empty path
+                return FindPath(world, Position(0, 1, 0), Position(10, 1, 0), 0, 0, 0, true, true, 150000, &cancelled);
+            });
+        request->Cancel();
+        WaitDone(*request);
+        REQUIRE(request->IsDone());
+        CHECK(request->GetPath().empty());
+    }
+}
+
+TEST_CASE("Find path benchmark", "[.][benchmark]")
+{
+    SECTION("Maze")
+    {
+        World world = World(false);
+        InitFlatWorld(world, -1, 4);
+        // 32x32 cells, corridors fill a 64x64 area
+        for (const auto& [x, z] : CreateMaze(32, 42))
+        {
+            AddWall(world, x, z);
+        }
+
+        BENCHMARK("Maze 64x64")
+        {
+            return FindPath(world, Position(0, 1, 0), Position(62, 1, 62), 0, 0, 0, true, true, 150000).size();
+        };
+    }
+
+    SECTION("Terrain")
+    {
+        // Generated hills, with at most one block of difference between neighbours so everything is walkable
+        World world = World(false);
+        InitFlatWorld(world, -1, 8);
+        std::mt19937 random_engine(42);
+        std::vector<int> heights(9 * CHUNK_WIDTH * 9 * CHUNK_WIDTH, 0);
+        for (int x = 0; x < 9 * CHUNK_WIDTH; ++x)
+        {
+            for (int z = 0; z < 9 * CHUNK_WIDTH; ++z)
+            {
+                const int previous_x = x > 0 ? heights[(x - 1) * 9 * CHUNK_WIDTH + z] : 0;
+                const int previous_z = z > 0 ? heights[x * 9 * CHUNK_WIDTH + z - 1] : previous_x;
+                int height = std::min(previous_x, previous_z) + static_cast<int>(random_engine() % 3);
+                height = std::clamp(height, std::max(previous_x, previous_z) - 1, std::min(previous_x, previous_z) + 1);
+                heights[x * 9 * CHUNK_WIDTH + z] = std::clamp(height, 0, 10);
+                for (int y = 1; y <= heights[x * 9 * CHUNK_WIDTH + z]; ++y)
+                {
+                    world.SetBlock(Position(x, y, z), stone_id);
+                }
+                // Some trees/obstacles
+                if (random_engine() % 20 == 0)
+                {
+                    for (int y = 1; y < 4; ++y)
+                    {
+                        world.SetBlock(Position(x, heights[x * 9 * CHUNK_WIDTH + z] + y, z), stone_id);
+                    }
+                }
+            }
+        }
+        const Position start(0, heights[0] + 1, 0);
+        const Position end(9 * CHUNK_WIDTH - 1, heights.back() + 1, 9 * CHUNK_WIDTH - 1);
+
+        BENCHMARK("Terrain 144x144")
+        {
+            return FindPath(world, start, end, 0, 0, 0, true, true, 150000).size();
+        };
+
+        PathfindingGraph graph;
+        BENCHMARK("Terrain 144x144 graph")
+        {
+            return graph.FindPath(world, start, end, true, true).size();
+        };
+    }
+}
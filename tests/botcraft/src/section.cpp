@@ -0,0 +1,428 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include <botcraft/Game/World/Chunk.hpp>
+#include <botcraft/Game/World/Section.hpp>
+
+using namespace Botcraft;
+
+TEST_CASE("Section palette")
+{
+    Section section;
+
+    // Empty section is only air, without any packed data
+    CHECK(section.GetBitsPerBlock() == 0);
+    CHECK(section.GetBlock(Section::CoordsToBlockIndex(3, 4, 5)) == 0);
+
+    std::vector<unsigned short> expected(CHUNK_WIDTH * CHUNK_WIDTH * SECTION_HEIGHT, 0);
+    std::mt19937 random_engine(42);
+
+    auto set_random_blocks = [&](const int num_different_ids, const int num_blocks)
+    {
+        std::uniform_int_distribution<int> coords(0, CHUNK_WIDTH - 1);
+        for (int i = 0; i < num_blocks; ++i)
+        {
+            const int x = coords(random_engine);
+            const int y = coords(random_engine);
+            const int z = coords(random_engine);
+            const unsigned short id = static_cast<unsigned short>(1 + random_engine() % num_different_ids);
+            section.SetBlock(Section::CoordsToBlockIndex(x, y, z), id);
+            expected[(y * CHUNK_WIDTH + z) * CHUNK_WIDTH + x] = id;
+        }
+    };
+
+    auto check_all_blocks = [&]()
+    {
+        for (int y = 0; y < SECTION_HEIGHT; ++y)
+        {
+            for (int z = 0; z < CHUNK_WIDTH; ++z)
+            {
+                for (int x = 0; x < CHUNK_WIDTH; ++x)
+                {
+                    if (section.GetBlock(Section::CoordsToBlockIndex(x, y, z)) != expected[(y * CHUNK_WIDTH + z) * CHUNK_WIDTH + x])
+                    {
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    };
+
+    // Setting the current value doesn't change anything
+    section.SetBlock(Section::CoordsToBlockIndex(0, 0, 0), 0);
+    CHECK(section.GetBitsPerBlock() == 0);
+
+    set_random_blocks(1, 500);
+    CHECK(section.GetBitsPerBlock() == 1);
+    CHECK(check_all_blocks());
+
+    set_random_blocks(3, 500);
+    CHECK(section.GetBitsPerBlock() == 2);
+    CHECK(check_all_blocks());
+
+    set_random_blocks(12, 2000);
+    CHECK(section.GetBitsPerBlock() == 4);
+    CHECK(check_all_blocks());
+
+    set_random_blocks(200, 4000);
+    CHECK(section.GetBitsPerBlock() == 8);
+    CHECK(check_all_blocks());
+
+    set_random_blocks(2000, 4000);
+    CHECK(section.GetBitsPerBlock() == 16);
+    CHECK(check_all_blocks());
+
+    section.Fill(7);
+    CHECK(section.GetBitsPerBlock() == 0);
+    CHECK(section.GetBlock(Section::CoordsToBlockIndex(15, 15, 15)) == 7);
+}
+
+TEST_CASE("Section lights")
+{
+    Section section;
+    const size_t empty_size = section.GetMemoryUsage();
+
+    // Setting 0 light doesn't allocate anything
+    section.SetBlockLight(1, 2, 3, 0);
+    section.SetSkyLight(1, 2, 3, 0);
+    CHECK(section.GetMemoryUsage() == empty_size);
+    CHECK(section.GetBlockLight(1, 2, 3) == 0);
+
+    section.SetBlockLight(1, 2, 3, 14);
+    section.SetBlockLight(2, 2, 3, 5);
+    section.SetSkyLight(1, 2, 3, 15);
+    CHECK(section.GetBlockLight(1, 2, 3) == 14);
+    CHECK(section.GetBlockLight(2, 2, 3) == 5);
+    CHECK(section.GetBlockLight(0, 2, 3) == 0);
+    CHECK(section.GetSkyLight(1, 2, 3) == 15);
+    CHECK(section.GetSkyLight(2, 2, 3) == 0);
+    CHECK(section.GetMemoryUsage() > empty_size);
+}
+
+namespace
+{
+    /// @brief Pack values in the 1.16+ network format, entries don't span across longs
+    std::vector<unsigned long long int> PackNetworkEntries(const std::vector<unsigned short>& values, const int bits_per_entry)
+    {
+        const int entries_per_long = 64 / bits_per_entry;
+        std::vector<unsigned long long int> output((values.size() + entries_per_long - 1) / entries_per_long, 0);
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            output[i / entries_per_long] |= static_cast<unsigned long long int>(values[i]) << ((i % entries_per_long) * bits_per_entry);
+        }
+        return output;
+    }
+
+    /// @brief Previous LoadChunkData implementation, decoding entries one by one
+    void LoadEntriesOneByOne(Section& section, const int bits_per_entry, const std::vector<int>& palette, const std::vector<unsigned long long int>& data_array)
+    {
+        const unsigned int individual_value_mask = static_cast<unsigned int>((1 << bits_per_entry) - 1);
+        int bit_offset = 0;
+        for (int block_y = 0; block_y < SECTION_HEIGHT; ++block_y)
+        {
+            for (int block_z = 0; block_z < CHUNK_WIDTH; ++block_z)
+            {
+                for (int block_x = 0; block_x < CHUNK_WIDTH; ++block_x)
+                {
+                    if (bits_per_entry == 0)
+                    {
+                        section.SetBlock(Section::CoordsToBlockIndex(block_x, block_y, block_z), palette[0]);
+                        continue;
+                    }
+                    if (64 - (bit_offset % 64) < bits_per_entry)
+                    {
+                        bit_offset += 64 - (bit_offset % 64);
+                    }
+                    unsigned int raw_id = static_cast<unsigned int>(data_array[bit_offset / 64] >> (bit_offset % 64));
+                    bit_offset += bits_per_entry;
+                    raw_id &= individual_value_mask;
+                    if (!palette.empty())
+                    {
+                        raw_id = palette[raw_id];
+                    }
+                    section.SetBlock(Section::CoordsToBlockIndex(block_x, block_y, block_z), static_cast<unsigned short>(raw_id));
+                }
+            }
+        }
+    }
+
+    struct NetworkSection
+    {
+        int bits_per_entry;
+        std::vector<int> palette;
+        std::vector<unsigned short> ids;
+        std::vector<unsigned long long int> data_array;
+    };
+
+    NetworkSection CreateNetworkSection(const int bits_per_entry, const bool global_palette, std::mt19937& random_engine)
+    {
+        NetworkSection output;
+        output.bits_per_entry = bits_per_entry;
+        std::vector<unsigned short> entries(CHUNK_WIDTH * CHUNK_WIDTH * SECTION_HEIGHT);
+        output.ids.resize(entries.size());
+        if (!global_palette)
+        {
+            const int palette_size = bits_per_entry == 0 ? 1 : (1 << bits_per_entry) - 1;
+            for (int i = 0; i < palette_size; ++i)
+            {
+                output.palette.push_back(1 + (i * 37) % 20000);
+            }
+        }
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            entries[i] = bits_per_entry == 0 ? 0 : static_cast<unsigned short>(random_engine() % (global_palette ? (1 << bits_per_entry) : output.palette.size()));
+            output.ids[i] = global_palette ? entries[i] : static_cast<unsigned short>(output.palette[entries[i]]);
+        }
+        if (bits_per_entry > 0)
+        {
+            output.data_array = PackNetworkEntries(entries, bits_per_entry);
+        }
+        return output;
+    }
+
+    bool CheckSectionIds(const Section& section, const std::vector<unsigned short>& ids)
+    {
+        size_t i = 0;
+        for (int y = 0; y < SECTION_HEIGHT; ++y)
+        {
+            for (int z = 0; z < CHUNK_WIDTH; ++z)
+            {
+                for (int x = 0; x < CHUNK_WIDTH; ++x)
+                {
+                    if (section.GetBlock(Section::CoordsToBlockIndex(x, y, z)) != ids[i])
+                    {
+                        return false;
+                    }
+                    ++i;
+                }
+            }
+        }
+        return true;
+    }
+}
+
+TEST_CASE("Section packed data loading")
+{
+    std::mt19937 random_engine(42);
+
+    for (int bits = 0; bits <= 8; ++bits)
+    {
+        const NetworkSection network_section = CreateNetworkSection(bits, false, random_engine);
+        Section section;
+        REQUIRE(section.LoadPackedData(bits, network_section.palette, network_section.data_array));
+        INFO("Bits per entry: " << bits);
+        CHECK(CheckSectionIds(section, network_section.ids));
+        // Still valid after modifications
+        section.SetBlock(Section::CoordsToBlockIndex(1, 2, 3), 12345);
+        CHECK(section.GetBlock(Section::CoordsToBlockIndex(1, 2, 3)) == 12345);
+        CHECK(section.GetBlock(Section::CoordsToBlockIndex(0, 0, 0)) == network_section.ids[0]);
+    }
+
+    for (int bits = 9; bits <= 16; ++bits)
+    {
+        const NetworkSection network_section = CreateNetworkSection(bits, true, random_engine);
+        Section section;
+        REQUIRE(section.LoadPackedData(bits, network_section.palette, network_section.data_array));
+        INFO("Bits per entry: " << bits);
+        CHECK(section.GetBitsPerBlock() == 16);
+        CHECK(CheckSectionIds(section, network_section.ids));
+    }
+
+    // Not sent by vanilla servers, but palette entries must still be converted to ids when stored on 16 bits
+    for (int bits = 9; bits <= 16; ++bits)
+    {
+        const NetworkSection network_section = CreateNetworkSection(bits, false, random_engine);
+        Section section;
+        REQUIRE(section.LoadPackedData(bits, network_section.palette, network_section.data_array));
+        INFO("Bits per entry with palette: " << bits);
+        CHECK(CheckSectionIds(section, network_section.ids));
+        section.SetBlock(Section::CoordsToBlockIndex(1, 2, 3), 12345);
+        CHECK(section.GetBlock(Section::CoordsToBlockIndex(1, 2, 3)) == 12345);
+        CHECK(section.GetBlock(Section::CoordsToBlockIndex(0, 0, 0)) == network_section.ids[0]);
+    }
+
+    SECTION("Invalid data")
+    {
+        Section section;
+        section.Fill(5);
+        // Not enough longs
+        CHECK_FALSE(section.LoadPackedData(4, { 1, 2 }, std::vector<unsigned long long int>(10, 0)));
+        // Palette too big for the number of bits
+        CHECK_FALSE(section.LoadPackedData(1, { 1, 2, 3 }, std::vector<unsigned long long int>(64, 0)));
+        CHECK(section.GetBlock(Section::CoordsToBlockIndex(0, 0, 0)) == 5);
+
+        // Entries outside the palette are air
+        CHECK(section.LoadPackedData(4, { 1, 2 }, std::vector<unsigned long long int>(256, 0xFFFFFFFFFFFFFFFFULL)));
+        CHECK(section.GetBlock(Section::CoordsToBlockIndex(0, 0, 0)) == 0);
+        CHECK(section.LoadPackedData(5, { 1, 2 }, std::vector<unsigned long long int>(342, 0xFFFFFFFFFFFFFFFFULL)));
+        CHECK(section.GetBlock(Section::CoordsToBlockIndex(0, 0, 0)) == 0);
+    }
+
+    SECTION("Palette not full")
+    {
+        Section section;
+        // 5 entries on 4 bits, all indices valid
+        REQUIRE(section.LoadPackedData(4, { 1, 2, 3, 4, 5 }, std::vector<unsigned long long int>(256, 0x0123401234012340ULL)));
+        CHECK(section.GetBitsPerBlock() == 4);
+        CHECK(section.GetBlock(Section::CoordsToBlockIndex(1, 0, 0)) == 5);
+        // Still room in the palette for new blocks
+        section.SetBlock(Section::CoordsToBlockIndex(0, 0, 0), 100);
+        CHECK(section.GetBitsPerBlock() == 4);
+        CHECK(section.GetBlock(Section::CoordsToBlockIndex(0, 0, 0)) == 100);
+        CHECK(section.GetBlock(Section::CoordsToBlockIndex(1, 0, 0)) == 5);
+    }
+}
+
+TEST_CASE("Section loading benchmark", "[.][benchmark]")
+{
+    std::mt19937 random_engine(42);
+    const NetworkSection single_value = CreateNetworkSection(0, false, random_engine);
+    const NetworkSection four_bits = CreateNetworkSection(4, false, random_engine);
+    const NetworkSection six_bits = CreateNetworkSection(6, false, random_engine);
+    const NetworkSection global = CreateNetworkSection(15, true, random_engine);
+
+    for (const NetworkSection* network_section : { &single_value, &four_bits, &six_bits, &global })
+    {
+        const std::string suffix = " (" + std::to_string(network_section->bits_per_entry) + " bits)";
+
+        BENCHMARK("One by one" + suffix)
+        {
+            Section section;
+            LoadEntriesOneByOne(section, network_section->bits_per_entry, network_section->palette, network_section->data_array);
+            return section.GetBlock(0);
+        };
+
+        BENCHMARK("Packed" + suffix)
+        {
+            Section section;
+            section.LoadPackedData(network_section->bits_per_entry, network_section->palette, network_section->data_array);
+            return section.GetBlock(0);
+        };
+    }
+}
+
+namespace
+{
+    /// @brief Deterministic overworld-like terrain: bedrock, stone with some ores
+    /// and caves, a few layers of dirt, grass, water in the low areas and air
+    void GenerateTerrain(Chunk& chunk, const int chunk_x, const int chunk_z, std::mt19937& random_engine)
+    {
+        const int min_y = chunk.GetMinY();
+        const int sea_level = min_y + 126;
+        std::uniform_int_distribution<int> ore_distribution(0, 99);
+        for (int z = 0; z < CHUNK_WIDTH; ++z)
+        {
+            for (int x = 0; x < CHUNK_WIDTH; ++x)
+            {
+                const int world_x = chunk_x * CHUNK_WIDTH + x;
+                const int world_z = chunk_z * CHUNK_WIDTH + z;
+                const int surface = sea_level + ((world_x * 7 + world_z * 13) % 17) - 8;
+                for (int y = min_y; y < min_y + chunk.GetHeight(); ++y)
+                {
+                    int id = 0;
+                    if (y == min_y)
+                    {
+                        id = 33; // bedrock
+                    }
+                    else if (y < surface - 4)
+                    {
+                        const int random_value = ore_distribution(random_engine);
+                        // stone, with a few different ores, gravel and caves
+                        id = random_value < 2 ? 0 : (random_value < 6 ? 100 + random_value : (random_value < 8 ? 118 : 1));
+                    }
+                    else if (y < surface)
+                    {
+                        id = 10; // dirt
+                    }
+                    else if (y == surface)
+                    {
+                        id = 9; // grass
+                    }
+                    else if (y <= sea_level)
+                    {
+                        id = 80; // water
+                    }
+
+                    if (id != 0)
+                    {
+#if PROTOCOL_VERSION < 347 /* < 1.13 */
+                        chunk.SetBlock(Position(x, y, z), { id, 0 });
+#else
+                        chunk.SetBlock(Position(x, y, z), id);
+#endif
+                    }
+                    chunk.SetSkyLight(Position(x, y, z), y > surface ? 15 : 0);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Chunk memory benchmark", "[.][benchmark]")
+{
+    const int radius = 4;
+    std::mt19937 random_engine(42);
+
+    size_t total_memory = 0;
+    size_t legacy_memory = 0;
+    int num_chunks = 0;
+    for (int chunk_x = -radius; chunk_x <= radius; ++chunk_x)
+    {
+        for (int chunk_z = -radius; chunk_z <= radius; ++chunk_z)
+        {
+#if PROTOCOL_VERSION < 757 /* < 1.18 */
+            Chunk chunk(0, true);
+#else
+            Chunk chunk(-64, 384, 0, true);
+#endif
+            GenerateTerrain(chunk, chunk_x, chunk_z, random_engine);
+            total_memory += chunk.GetMemoryUsage();
+            num_chunks += 1;
+
+            // Previous layout: 2 bytes per block + 2 light arrays, for every section with at least one block or light
+            for (int section_y = 0; section_y < chunk.GetHeight() / SECTION_HEIGHT; ++section_y)
+            {
+                if (chunk.HasSection(section_y))
+                {
+                    legacy_memory += CHUNK_WIDTH * CHUNK_WIDTH * SECTION_HEIGHT * 2 + 2 * CHUNK_WIDTH * CHUNK_WIDTH * SECTION_HEIGHT / 2;
+                }
+            }
+        }
+    }
+
+    WARN("Palette storage: " << total_memory / num_chunks / 1024 << " KiB per chunk");
+    WARN("Legacy storage: " << legacy_memory / num_chunks / 1024 << " KiB per chunk (sections data only)");
+    CHECK(total_memory < legacy_memory);
+}
+
+TEST_CASE("Chunk copy benchmark", "[.][benchmark]")
+{
+    std::mt19937 random_engine(42);
+#if PROTOCOL_VERSION < 757 /* < 1.18 */
+    Chunk chunk(0, true);
+#else
+    Chunk chunk(-64, 384, 0, true);
+#endif
+    GenerateTerrain(chunk, 0, 0, random_engine);
+
+    BENCHMARK("Copy")
+    {
+        return Chunk(chunk);
+    };
+
+    // Same cost as a full copy of all the sections
+    BENCHMARK("Copy and modify all sections")
+    {
+        Chunk copy(chunk);
+        for (int y = copy.GetMinY(); y < copy.GetMinY() + copy.GetHeight(); y += SECTION_HEIGHT)
+        {
+            copy.SetSkyLight(Position(0, y, 0), 1);
+        }
+        return copy;
+    };
+}
@@ -1,11 +1,105 @@
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <random>
+#include <thread>
+#include <vector>
 
 #include <botcraft/Game/AssetsManager.hpp>
+#include <botcraft/Game/World/ChunkCache.hpp>
 #include <botcraft/Game/World/World.hpp>
 #include <botcraft/Game/World/Biome.hpp>
 
 using namespace Botcraft;
 
+#if PROTOCOL_VERSION > 756 /* > 1.17.1 */
+/// @brief Create a chunk packet with 16 sections using a 4 bits palette, and full sky light
+/// @param seed Used to change the blocks of the chunk
+ProtocolCraft::ClientboundLevelChunkWithLightPacket CreateChunkPacket(const int x, const int z, const unsigned char seed)
+{
+    std::vector<unsigned char> buffer;
+    for (int section_y = 0; section_y < 16; ++section_y)
+    {
+        // Block count
+        buffer.push_back(0x10);
+        buffer.push_back(0x00);
+        // Blocks: 4 bits, 16 entries palette, 256 longs
+        buffer.push_back(4);
+        buffer.push_back(16);
+        for (unsigned char i = 0; i < 16; ++i)
+        {
+            buffer.push_back(1 + i);
+        }
+        buffer.push_back(0x80);
+        buffer.push_back(0x02);
+        for (int i = 0; i < 256 * 8; ++i)
+        {
+            buffer.push_back(static_cast<unsigned char>(i * 31 + section_y + seed));
+        }
+        // Biomes: single value
+        buffer.push_back(0);
+        buffer.push_back(0);
+        buffer.push_back(0);
+    }
+
+    ProtocolCraft::ClientboundLevelChunkPacketData chunk_data;
+    chunk_data.SetBuffer(buffer);
+
+    ProtocolCraft::ClientboundLightUpdatePacketData light_data;
+    light_data.SetSkyYMask({ (1ULL << 18) - 1 });
+    light_data.SetBlockYMask({});
+    light_data.SetEmptySkyYMask({});
+    light_data.SetEmptyBlockYMask({ (1ULL << 18) - 1 });
+    std::vector<std::vector<char> > sky_updates(18, std::vector<char>(2048, static_cast<char>(0xFF)));
+    std::vector<std::vector<char> > block_updates;
+    light_data.SetSkyUpdates(sky_updates);
+    light_data.SetBlockUpdates(block_updates);
+
+    ProtocolCraft::ClientboundLevelChunkWithLightPacket msg;
+    msg.SetX(x);
+    msg.SetZ(z);
+    msg.SetChunkData(chunk_data);
+    msg.SetLightData(light_data);
+    return msg;
+}
+
+/// @brief Create a block entity at (3, 100, 7) in chunk coordinates, with a single int "v" in its NBT
+ProtocolCraft::BlockEntityInfo CreateBlockEntity(const int value)
+{
+    std::vector<unsigned char> data = {
+        0x37, // Packed XZ
+        0x00, 0x64, // Y
+        0x07, // Type
+        0x0A, // TagCompound
+#if PROTOCOL_VERSION < 764 /* < 1.20.2 */
+        0x00, 0x00, // Name length
+#endif
+        0x03, // TagInt
+        0x00, 0x01, // Name length
+        0x76, // Name
+        static_cast<unsigned char>(value >> 24), static_cast<unsigned char>(value >> 16),
+        static_cast<unsigned char>(value >> 8), static_cast<unsigned char>(value),
+        0x00 // TagEnd
+    };
+    ProtocolCraft::ReadIterator iter = data.begin();
+    size_t length = data.size();
+    ProtocolCraft::BlockEntityInfo block_entity;
+    block_entity.Read(iter, length);
+    return block_entity;
+}
+
+/// @brief Handle a packet in a new thread, as if received by another bot
+void HandleFromNewThread(World& world, ProtocolCraft::Message& msg)
+{
+    std::thread thread([&]() { msg.Dispatch(&world); });
+    thread.join();
+}
+#endif
+
 TEST_CASE("Add/Remove chunks")
 {
     World world = World(false);
@@ -134,6 +228,31 @@ TEST_CASE("Neighbour chunk update")
         REQUIRE(world_terrain->at({ 0,1 }).GetBlock(Position(0, 0, -1)) != nullptr);
         REQUIRE(world_terrain->at({ 0,1 }).GetBlock(Position(0, 0, -1))->GetId() == id);
     }
+
+    SECTION("Whole border update")
+    {
+#if PROTOCOL_VERSION < 757 /* < 1.18 */
+        Chunk chunk(0, true);
+        Chunk neighbour(0, true);
+#else
+        Chunk chunk(0, 256, 0, true);
+        Chunk neighbour(0, 256, 0, true);
+#endif
+        chunk.SetBlock(Position(CHUNK_WIDTH - 1, 20, 3), id);
+        chunk.UpdateNeighbour(&neighbour, Orientation::East);
+        REQUIRE(neighbour.GetBlock(Position(-1, 20, 3)) != nullptr);
+        CHECK(neighbour.GetBlock(Position(-1, 20, 3))->GetId() == id);
+        CHECK(neighbour.GetBlock(Position(-1, 21, 3))->IsAir());
+        CHECK(chunk.GetBlock(Position(CHUNK_WIDTH, 20, 3))->IsAir());
+        // Sections that are air in both chunks are not created
+        CHECK_FALSE(chunk.HasSection(5));
+        CHECK_FALSE(neighbour.HasSection(5));
+
+        // Unloaded neighbours are replaced by the default block
+        chunk.UpdateNeighbour(nullptr, Orientation::East);
+        REQUIRE(chunk.GetBlock(Position(CHUNK_WIDTH, 20, 3)) != nullptr);
+        CHECK(chunk.GetBlock(Position(CHUNK_WIDTH, 20, 3))->GetName() == "default");
+    }
 }
 #endif
 
@@ -226,3 +345,623 @@ TEST_CASE("Set/Get lights")
     CHECK(world.GetSkyLight(Position(0, 0, 0)) == 12);
     CHECK(world.GetSkyLight(Position(1, 0, 0)) == 6);
 }
+
+TEST_CASE("World view")
+{
+    World world = World(false);
+
+#if PROTOCOL_VERSION < 719 /* < 1.16 */
+    const Dimension dimension = Dimension::Overworld;
+#else
+    const std::string dimension = "minecraft:overworld";
+#endif
+
+#if PROTOCOL_VERSION > 756 /* > 1.17.1 */
+    world.SetDimensionMinY(dimension, 0);
+    world.SetDimensionHeight(dimension, 256);
+#endif
+    world.SetCurrentDimension(dimension);
+
+    world.LoadChunk(0, 0, dimension);
+    world.LoadChunk(-1, 0, dimension);
+    world.LoadChunk(-1, -1, dimension);
+    // Chunk (0, -1) is not loaded
+    for (int i = 0; i < 32; ++i)
+    {
+#if PROTOCOL_VERSION < 347 /* < 1.13 */
+        world.SetBlock(Position(i - 16, i, i / 2 - 8), { 1, 0 });
+#else
+        world.SetBlock(Position(i - 16, i, i / 2 - 8), 1);
+#endif
+    }
+
+    const Position min(-20, -2, -10);
+    const Position max(10, 40, 12);
+    const Position size = max - min + Position(1, 1, 1);
+
+    std::vector<const Blockstate*> expected;
+    std::vector<Position> positions;
+    for (int y = min.y; y <= max.y; ++y)
+    {
+        for (int z = min.z; z <= max.z; ++z)
+        {
+            for (int x = min.x; x <= max.x; ++x)
+            {
+                positions.push_back(Position(x, y, z));
+                expected.push_back(world.GetBlock(positions.back()));
+            }
+        }
+    }
+
+    const std::vector<const Blockstate*> region = world.GetBlocks(min, max);
+    REQUIRE(region.size() == static_cast<size_t>(size.x * size.y * size.z));
+    CHECK(region == expected);
+    CHECK(world.GetBlocks(positions) == expected);
+    CHECK(world.GetBlocks(max, min).empty());
+
+    {
+        WorldView view = world.GetView();
+        CHECK(view.GetChunk(0, 0) != nullptr);
+        CHECK(view.GetChunk(0, -1) == nullptr);
+        CHECK(view.GetChunk(-1, -1) != nullptr);
+        CHECK(view.GetBlocks(min, max) == expected);
+        for (size_t i = 0; i < positions.size(); ++i)
+        {
+            CHECK(view.GetBlock(positions[i]) == expected[i]);
+        }
+    }
+
+    // View is destroyed, world can be modified again
+    world.UnloadChunk(0, 0);
+    CHECK(world.GetView().GetChunk(0, 0) == nullptr);
+}
+
+#if PROTOCOL_VERSION > 756 /* > 1.17.1 */
+TEST_CASE("Shared world chunk deduplication")
+{
+    World world = World(true);
+    const std::string dimension = "minecraft:overworld";
+    world.SetDimensionMinY(dimension, 0);
+    world.SetDimensionHeight(dimension, 256);
+    world.SetCurrentDimension(dimension);
+
+    ProtocolCraft::ClientboundLevelChunkWithLightPacket msg = CreateChunkPacket(0, 0, 0);
+    HandleFromNewThread(world, msg);
+    size_t hash = 0;
+    std::vector<unsigned long long int> revisions;
+    {
+        auto chunks = world.GetChunks();
+        REQUIRE(chunks->size() == 1);
+        const Chunk& chunk = chunks->at({ 0, 0 });
+        hash = chunk.GetContentHash();
+        CHECK(hash != 0);
+        CHECK(chunk.GetLoaders().size() == 1);
+        for (int i = 0; i < chunk.GetHeight() / SECTION_HEIGHT; ++i)
+        {
+            revisions.push_back(chunk.GetSectionRevision(i));
+        }
+    }
+    CHECK(world.GetSkyLight(Position(3, 100, 7)) == 15);
+
+    SECTION("Same data")
+    {
+        // Loaded from this thread, as the id of the previous joined thread could be reused
+        msg.Dispatch(&world);
+        auto chunks = world.GetChunks();
+        const Chunk& chunk = chunks->at({ 0, 0 });
+        CHECK(chunk.GetContentHash() == hash);
+        // Not decoded again, only a new loader
+        CHECK(chunk.GetLoaders().size() == 2);
+        CHECK(chunk.GetLoaders().count(std::this_thread::get_id()) == 1);
+        for (int i = 0; i < static_cast<int>(revisions.size()); ++i)
+        {
+            CHECK(chunk.GetSectionRevision(i) == revisions[i]);
+        }
+        CHECK(world.GetSkyLight(Position(3, 100, 7)) == 15);
+    }
+
+    SECTION("Modified chunk")
+    {
+        world.SetSkyLight(Position(3, 100, 7), 2);
+        CHECK(world.GetChunks()->at({ 0, 0 }).GetContentHash() == 0);
+
+        // Modified since loaded, must be decoded again
+        HandleFromNewThread(world, msg);
+        CHECK(world.GetChunks()->at({ 0, 0 }).GetContentHash() == hash);
+        CHECK(world.GetChunks()->at({ 0, 0 }).GetSectionRevision(0) != revisions[0]);
+        CHECK(world.GetSkyLight(Position(3, 100, 7)) == 15);
+    }
+
+    SECTION("Different data")
+    {
+        ProtocolCraft::ClientboundLevelChunkWithLightPacket other_msg = CreateChunkPacket(0, 0, 1);
+        HandleFromNewThread(world, other_msg);
+        const size_t other_hash = world.GetChunks()->at({ 0, 0 }).GetContentHash();
+        CHECK(other_hash != 0);
+        CHECK(other_hash != hash);
+    }
+
+    SECTION("Different block entities")
+    {
+        // Same sections and same number of block entities, only the NBT differs
+        ProtocolCraft::ClientboundLevelChunkWithLightPacket first_msg = CreateChunkPacket(0, 0, 0);
+        ProtocolCraft::ClientboundLevelChunkPacketData first_chunk_data = first_msg.GetChunkData();
+        first_chunk_data.SetBlockEntitiesData({ CreateBlockEntity(1) });
+        first_msg.SetChunkData(first_chunk_data);
+        HandleFromNewThread(world, first_msg);
+        const size_t first_hash = world.GetChunks()->at({ 0, 0 }).GetContentHash();
+        CHECK(world.GetBlockEntityData(Position(3, 100, 7))["v"].get<int>() == 1);
+
+        ProtocolCraft::ClientboundLevelChunkWithLightPacket second_msg = CreateChunkPacket(0, 0, 0);
+        ProtocolCraft::ClientboundLevelChunkPacketData second_chunk_data = second_msg.GetChunkData();
+        second_chunk_data.SetBlockEntitiesData({ CreateBlockEntity(2) });
+        second_msg.SetChunkData(second_chunk_data);
+        HandleFromNewThread(world, second_msg);
+        CHECK(world.GetChunks()->at({ 0, 0 }).GetContentHash() != first_hash);
+        CHECK(world.GetBlockEntityData(Position(3, 100, 7))["v"].get<int>() == 2);
+    }
+
+    // Each thread is still registered as a loader
+    world.UnloadChunk(0, 0, std::this_thread::get_id());
+    CHECK(world.GetChunks()->size() == 1);
+}
+
+TEST_CASE("World light policy")
+{
+    const std::string dimension = "minecraft:overworld";
+    const ProtocolCraft::ClientboundLevelChunkWithLightPacket original_msg = CreateChunkPacket(0, 0, 0);
+
+    SECTION("Eager")
+    {
+        World world = World(false);
+        CHECK(world.GetLightPolicy() == LightPolicy::Eager);
+        world.SetDimensionMinY(dimension, 0);
+        world.SetDimensionHeight(dimension, 256);
+        world.SetCurrentDimension(dimension);
+
+        ProtocolCraft::ClientboundLevelChunkWithLightPacket msg = original_msg;
+        HandleFromNewThread(world, msg);
+        CHECK(world.GetSkyLight(Position(3, 100, 7)) == 15);
+        CHECK(world.GetBlockLight(Position(3, 100, 7)) == 0);
+        // Packet is left intact for the other handlers
+        CHECK(msg.GetLightData().GetSkyUpdates() == original_msg.GetLightData().GetSkyUpdates());
+        CHECK(world.GetPacketFilter().Contains(ProtocolCraft::ConnectionState::Play, ProtocolCraft::ClientboundLightUpdatePacket::packet_id));
+        CHECK_FALSE(world.GetPacketFilter().GetSkipLightData());
+    }
+
+    SECTION("Raw")
+    {
+        World world = World(false, LightPolicy::Raw);
+        world.SetDimensionMinY(dimension, 0);
+        world.SetDimensionHeight(dimension, 256);
+        world.SetCurrentDimension(dimension);
+
+        ProtocolCraft::ClientboundLevelChunkWithLightPacket msg = original_msg;
+        HandleFromNewThread(world, msg);
+        CHECK(world.GetSkyLight(Position(3, 100, 7)) == 15);
+        // Light arrays have been moved out of the packet
+        CHECK(msg.GetLightData().GetSkyUpdates()[5].empty());
+
+        // Lights can still be modified
+        world.SetSkyLight(Position(3, 100, 7), 4);
+        CHECK(world.GetSkyLight(Position(3, 100, 7)) == 4);
+        CHECK(world.GetSkyLight(Position(4, 100, 7)) == 15);
+    }
+
+    SECTION("Ignore")
+    {
+        World world = World(false, LightPolicy::Ignore);
+        world.SetDimensionMinY(dimension, 0);
+        world.SetDimensionHeight(dimension, 256);
+        world.SetCurrentDimension(dimension);
+
+        ProtocolCraft::ClientboundLevelChunkWithLightPacket msg = original_msg;
+        HandleFromNewThread(world, msg);
+        CHECK(world.IsLoaded(Position(3, 100, 7)));
+        CHECK(world.GetSkyLight(Position(3, 100, 7)) == 0);
+
+        const PacketFilter filter = world.GetPacketFilter();
+        CHECK(filter.GetSkipLightData());
+        CHECK(filter.Contains(ProtocolCraft::ConnectionState::Play, ProtocolCraft::ClientboundLevelChunkWithLightPacket::packet_id));
+        CHECK_FALSE(filter.Contains(ProtocolCraft::ConnectionState::Play, ProtocolCraft::ClientboundLightUpdatePacket::packet_id));
+
+        // Light is still parsed if another handler needs it
+        PacketFilter combined = filter;
+        combined |= World(false).GetPacketFilter();
+        CHECK_FALSE(combined.GetSkipLightData());
+        CHECK(combined.Contains(ProtocolCraft::ConnectionState::Play, ProtocolCraft::ClientboundLightUpdatePacket::packet_id));
+    }
+}
+
+TEST_CASE("Shared world chunk loading benchmark", "[.][benchmark]")
+{
+    const std::string dimension = "minecraft:overworld";
+    const int num_bots = 50;
+    std::vector<ProtocolCraft::ClientboundLevelChunkWithLightPacket> packets;
+    for (int i = 0; i < 16; ++i)
+    {
+        packets.push_back(CreateChunkPacket(i % 4, i / 4, static_cast<unsigned char>(i)));
+    }
+
+    for (const bool is_shared : { false, true })
+    {
+        BENCHMARK(std::string(is_shared ? "Shared" : "Not shared") + " world, " + std::to_string(num_bots) + " bots, " + std::to_string(packets.size()) + " chunks")
+        {
+            World world = World(is_shared);
+            world.SetDimensionMinY(dimension, 0);
+            world.SetDimensionHeight(dimension, 256);
+            world.SetCurrentDimension(dimension);
+            std::thread thread([&]()
+                {
+                    for (int bot = 0; bot < num_bots; ++bot)
+                    {
+                        for (auto& msg : packets)
+                        {
+                            msg.Dispatch(&world);
+                        }
+                    }
+                });
+            thread.join();
+            return world.GetChunks()->size();
+        };
+    }
+}
+#endif
+
+#if PROTOCOL_VERSION > 756 /* > 1.17.1 */
+TEST_CASE("World contention benchmark", "[.][benchmark]")
+{
+    const std::string dimension = "minecraft:overworld";
+    const int num_readers = 4;
+    const std::chrono::milliseconds duration(1000);
+
+    std::vector<ProtocolCraft::ClientboundLevelChunkWithLightPacket> packets;
+    for (int i = 0; i < 64; ++i)
+    {
+        packets.push_back(CreateChunkPacket(i % 8, i / 8, static_cast<unsigned char>(i)));
+    }
+
+    for (const bool with_writer : { false, true })
+    {
+        World world = World(false);
+        world.SetDimensionMinY(dimension, 0);
+        world.SetDimensionHeight(dimension, 256);
+        world.SetCurrentDimension(dimension);
+        for (auto& msg : packets)
+        {
+            msg.Dispatch(&world);
+        }
+
+        std::atomic<bool> running = true;
+        std::atomic<size_t> total_reads = 0;
+        std::atomic<long long int> max_read_latency_ns = 0;
+        size_t chunk_loaded = 0;
+
+        std::vector<std::thread> readers;
+        for (int i = 0; i < num_readers; ++i)
+        {
+            readers.emplace_back([&, i]()
+                {
+                    std::mt19937 random_engine(i);
+                    std::uniform_int_distribution<int> horizontal(0, 8 * CHUNK_WIDTH - 1);
+                    std::uniform_int_distribution<int> vertical(0, 255);
+                    size_t reads = 0;
+                    long long int max_latency = 0;
+                    while (running)
+                    {
+                        const Position pos(horizontal(random_engine), vertical(random_engine), horizontal(random_engine));
+                        const auto start = std::chrono::steady_clock::now();
+                        world.GetSkyLight(pos);
+                        const long long int latency = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+                        max_latency = std::max(max_latency, latency);
+                        reads += 1;
+                    }
+                    total_reads += reads;
+                    long long int current_max = max_read_latency_ns;
+                    while (current_max < max_latency && !max_read_latency_ns.compare_exchange_weak(current_max, max_latency)) {}
+                });
+        }
+
+        std::thread writer;
+        if (with_writer)
+        {
+            writer = std::thread([&]()
+                {
+                    while (running)
+                    {
+                        for (auto& msg : packets)
+                        {
+                            msg.Dispatch(&world);
+                            chunk_loaded += 1;
+                        }
+                    }
+                });
+        }
+
+        std::this_thread::sleep_for(duration);
+        running = false;
+        for (auto& t : readers)
+        {
+            t.join();
+        }
+        if (writer.joinable())
+        {
+            writer.join();
+        }
+
+        WARN((with_writer ? "With writer: " : "Without writer: ") << num_readers << " readers, "
+            << total_reads * 1000 / duration.count() << " reads/s, max read latency " << max_read_latency_ns / 1000 << " us"
+            << (with_writer ? ", " + std::to_string(chunk_loaded * 1000 / duration.count()) + " chunks loaded/s" : ""));
+    }
+}
+#endif
+
+#if PROTOCOL_VERSION > 756 /* > 1.17.1 */
+TEST_CASE("World view benchmark", "[.][benchmark]")
+{
+    World world = World(false);
+    const std::string dimension = "minecraft:overworld";
+    world.SetDimensionMinY(dimension, 0);
+    world.SetDimensionHeight(dimension, 256);
+    world.SetCurrentDimension(dimension);
+    for (int i = 0; i < 16; ++i)
+    {
+        ProtocolCraft::ClientboundLevelChunkWithLightPacket msg = CreateChunkPacket(i % 4 - 2, i / 4 - 2, static_cast<unsigned char>(i));
+        msg.Dispatch(&world);
+    }
+
+    const Position min(-24, 40, -24);
+    const Position max(23, 87, 23);
+
+    BENCHMARK("World::GetBlock for each block")
+    {
+        size_t count = 0;
+        for (int y = min.y; y <= max.y; ++y)
+        {
+            for (int z = min.z; z <= max.z; ++z)
+            {
+                for (int x = min.x; x <= max.x; ++x)
+                {
+                    count += world.GetBlock(Position(x, y, z)) != nullptr;
+                }
+            }
+        }
+        return count;
+    };
+
+    BENCHMARK("WorldView::GetBlock for each block")
+    {
+        size_t count = 0;
+        WorldView view = world.GetView();
+        for (int y = min.y; y <= max.y; ++y)
+        {
+            for (int z = min.z; z <= max.z; ++z)
+            {
+                for (int x = min.x; x <= max.x; ++x)
+                {
+                    count += view.GetBlock(Position(x, y, z)) != nullptr;
+                }
+            }
+        }
+        return count;
+    };
+
+    BENCHMARK("World::GetBlocks region copy")
+    {
+        return world.GetBlocks(min, max).size();
+    };
+}
+#endif
+
+TEST_CASE("Chunk snapshots")
+{
+    World world = World(false);
+
+#if PROTOCOL_VERSION < 719 /* < 1.16 */
+    const Dimension dimension = Dimension::Overworld;
+#else
+    const std::string dimension = "minecraft:overworld";
+#endif
+
+#if PROTOCOL_VERSION > 756 /* > 1.17.1 */
+    world.SetDimensionMinY(dimension, 0);
+    world.SetDimensionHeight(dimension, 256);
+#endif
+    world.SetCurrentDimension(dimension);
+
+    world.LoadChunk(0, 0, dimension);
+    world.LoadChunk(1, 0, dimension);
+    world.LoadChunk(5, 5, dimension);
+    world.SetSkyLight(Position(1, 2, 3), 10);
+    world.SetSkyLight(Position(17, 2, 3), 11);
+
+    const ChunkMap snapshot = world.GetChunksSnapshot(Position(-10, 0, -10), Position(20, 10, 10));
+    REQUIRE(snapshot.size() == 2);
+    const Chunk& chunk = snapshot.at({ 0, 0 });
+    CHECK(chunk.GetSkyLight(Position(1, 2, 3)) == 10);
+    CHECK(snapshot.at({ 1, 0 }).GetSkyLight(Position(1, 2, 3)) == 11);
+
+    // Modifying the world doesn't change the snapshot
+    world.SetSkyLight(Position(1, 2, 3), 4);
+    world.SetSkyLight(Position(1, 100, 3), 5);
+    CHECK(world.GetSkyLight(Position(1, 2, 3)) == 4);
+    CHECK(chunk.GetSkyLight(Position(1, 2, 3)) == 10);
+    CHECK(chunk.GetSkyLight(Position(1, 100, 3)) == 0);
+    world.UnloadChunk(0, 0);
+    CHECK(chunk.GetSkyLight(Position(1, 2, 3)) == 10);
+
+    // Modifying a copy doesn't change the original either
+    Chunk copy = chunk;
+    copy.SetSkyLight(Position(1, 2, 3), 1);
+    CHECK(copy.GetSkyLight(Position(1, 2, 3)) == 1);
+    CHECK(chunk.GetSkyLight(Position(1, 2, 3)) == 10);
+}
+
+TEST_CASE("World chunk cache")
+{
+    const std::filesystem::path folder = std::filesystem::temp_directory_path() / "botcraft_world_chunk_cache_tests";
+    std::filesystem::remove_all(folder);
+
+    World world = World(false);
+
+#if PROTOCOL_VERSION < 719 /* < 1.16 */
+    const Dimension dimension = Dimension::Overworld;
+#else
+    const std::string dimension = "minecraft:overworld";
+#endif
+
+#if PROTOCOL_VERSION > 756 /* > 1.17.1 */
+    world.SetDimensionMinY(dimension, 0);
+    world.SetDimensionHeight(dimension, 256);
+#endif
+    world.SetCurrentDimension(dimension);
+
+    const std::shared_ptr<ChunkCache> cache = std::make_shared<ChunkCache>(folder.string());
+    world.SetChunkCache(cache);
+    CHECK(world.GetChunkCache() == cache);
+
+    world.LoadChunk(0, 0, dimension);
+    world.LoadChunk(-1, 0, dimension);
+    world.LoadChunk(3, 3, dimension);
+    world.SetSkyLight(Position(1, 2, 3), 10);
+    world.SetSkyLight(Position(-15, 2, 3), 11);
+    CHECK(world.GetLastKnownChunks(Position(-16, 0, 0), Position(15, 10, 15)).size() == 2);
+
+    // Unloaded chunks are saved in the cache
+    world.UnloadChunk(0, 0);
+    CHECK(world.GetChunks()->size() == 2);
+    CHECK(world.GetChunksSnapshot(Position(-16, 0, 0), Position(15, 10, 15)).size() == 1);
+    ChunkMap chunks = world.GetLastKnownChunks(Position(-16, 0, 0), Position(15, 10, 15));
+    REQUIRE(chunks.size() == 2);
+    CHECK(chunks.at({ 0, 0 }).GetSkyLight(Position(1, 2, 3)) == 10);
+    CHECK(chunks.at({ -1, 0 }).GetSkyLight(Position(1, 2, 3)) == 11);
+
+    world.UnloadAllChunks();
+    CHECK(world.GetChunks()->size() == 0);
+    chunks = world.GetLastKnownChunks(Position(-16, 0, 0), Position(63, 10, 63));
+    CHECK(chunks.size() == 3);
+    CHECK(chunks.at({ -1, 0 }).GetSkyLight(Position(1, 2, 3)) == 11);
+    CHECK(world.GetLastKnownBlock(Position(100, 0, 100)) == nullptr);
+
+    // Loaded chunks are more recent than the cached version
+    world.LoadChunk(0, 0, dimension);
+    CHECK(world.GetLastKnownChunks(Position(0, 0, 0), Position(0, 0, 0)).at({ 0, 0 }).GetSkyLight(Position(1, 2, 3)) == 0);
+
+    // Other dimensions are stored separately
+#if PROTOCOL_VERSION < 719 /* < 1.16 */
+    const Dimension nether = Dimension::Nether;
+#else
+    const std::string nether = "minecraft:the_nether";
+#endif
+#if PROTOCOL_VERSION > 756 /* > 1.17.1 */
+    world.SetDimensionMinY(nether, 0);
+    world.SetDimensionHeight(nether, 256);
+#endif
+    world.SetCurrentDimension(nether);
+    // Only the loaded chunk, nothing cached in this dimension
+    CHECK(world.GetLastKnownChunks(Position(-16, 0, 0), Position(63, 10, 63)).size() == 1);
+
+    world.SetChunkCache(nullptr);
+    world.UnloadAllChunks();
+    cache->Flush();
+    std::filesystem::remove_all(folder);
+}
+
+TEST_CASE("Last known blocks")
+{
+    const std::filesystem::path folder = std::filesystem::temp_directory_path() / "botcraft_last_known_blocks_tests";
+    std::filesystem::remove_all(folder);
+
+    World world = World(false);
+
+#if PROTOCOL_VERSION < 719 /* < 1.16 */
+    const Dimension dimension = Dimension::Overworld;
+#else
+    const std::string dimension = "minecraft:overworld";
+#endif
+
+#if PROTOCOL_VERSION > 756 /* > 1.17.1 */
+    world.SetDimensionMinY(dimension, 0);
+    world.SetDimensionHeight(dimension, 256);
+#endif
+    world.SetCurrentDimension(dimension);
+#if PROTOCOL_VERSION < 347 /* < 1.13 */
+    const BlockstateId id = { 1,0 };
+#else
+    const BlockstateId id = 1;
+#endif
+
+    world.SetChunkCache(std::make_shared<ChunkCache>(folder.string()));
+    world.LoadChunk(-1, -1, dimension);
+    world.SetBlock(Position(-3, 5, -7), id);
+    const Blockstate* block = world.GetBlock(Position(-3, 5, -7));
+    REQUIRE(block != nullptr);
+    CHECK(world.GetLastKnownBlock(Position(-3, 5, -7)) == block);
+
+    world.UnloadChunk(-1, -1);
+    CHECK(world.GetBlock(Position(-3, 5, -7)) == nullptr);
+    CHECK(world.GetLastKnownBlock(Position(-3, 5, -7)) == block);
+#if PROTOCOL_VERSION < 347 /* < 1.13 */
+    CHECK(world.GetLastKnownBlock(Position(-3, 6, -7)) == AssetsManager::getInstance().GetBlockstate(BlockstateId{ 0, 0 }));
+#else
+    CHECK(world.GetLastKnownBlock(Position(-3, 6, -7)) == AssetsManager::getInstance().GetBlockstate(0));
+#endif
+
+    world.SetChunkCache(nullptr);
+    std::filesystem::remove_all(folder);
+}
+
+#if PROTOCOL_VERSION > 756 /* > 1.17.1 */
+TEST_CASE("Chunk cache loading benchmark", "[.][benchmark]")
+{
+    const std::filesystem::path folder = std::filesystem::temp_directory_path() / "botcraft_chunk_cache_benchmark";
+    std::filesystem::remove_all(folder);
+
+    const std::string dimension = "minecraft:overworld";
+    std::vector<ProtocolCraft::ClientboundLevelChunkWithLightPacket> packets;
+    for (int i = 0; i < 64; ++i)
+    {
+        packets.push_back(CreateChunkPacket(i % 8, i / 8, static_cast<unsigned char>(i)));
+    }
+
+    {
+        World world = World(false);
+        world.SetDimensionMinY(dimension, 0);
+        world.SetDimensionHeight(dimension, 256);
+        world.SetCurrentDimension(dimension);
+        world.SetChunkCache(std::make_shared<ChunkCache>(folder.string()));
+        for (auto& msg : packets)
+        {
+            msg.Dispatch(&world);
+        }
+        world.UnloadAllChunks();
+    }
+
+    BENCHMARK("Network packets, " + std::to_string(packets.size()) + " chunks")
+    {
+        World world = World(false);
+        world.SetDimensionMinY(dimension, 0);
+        world.SetDimensionHeight(dimension, 256);
+        world.SetCurrentDimension(dimension);
+        for (auto& msg : packets)
+        {
+            msg.Dispatch(&world);
+        }
+        return world.GetChunks()->size();
+    };
+
+    BENCHMARK("Chunk cache, " + std::to_string(packets.size()) + " chunks")
+    {
+        // New cache each time, so the chunks are read from the files
+        ChunkCache cache(folder.string());
+        size_t num_chunks = 0;
+        for (int i = 0; i < static_cast<int>(packets.size()); ++i)
+        {
+            num_chunks += cache.Load(dimension, i % 8, i / 8).has_value();
+        }
+        return num_chunks;
+    };
+
+    std::filesystem::remove_all(folder);
+}
+#endif
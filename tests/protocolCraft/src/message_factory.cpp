@@ -0,0 +1,361 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "protocolCraft/AllMessages.hpp"
+#include "protocolCraft/MessageFactory.hpp"
+
+using namespace ProtocolCraft;
+
+namespace
+{
+    template<typename TypesTuple, typename Factory, std::size_t... indices>
+    bool CheckAllMessagesCreated(const ConnectionState state, Factory factory, std::index_sequence<indices...>)
+    {
+        bool output = true;
+        ((output &= dynamic_cast<std::tuple_element_t<indices, TypesTuple>*>(factory(state, std::tuple_element_t<indices, TypesTuple>::packet_id).get()) != nullptr), ...);
+        return output;
+    }
+
+    template<typename TypesTuple, typename Factory>
+    bool CheckAllMessagesCreated(const ConnectionState state, Factory factory)
+    {
+        return CheckAllMessagesCreated<TypesTuple>(state, factory, std::make_index_sequence<std::tuple_size_v<TypesTuple>>{});
+    }
+
+    /// @brief Previous MessageFactory implementation, comparing the id with all the messages in the tuple
+    template<typename TypesTuple, std::size_t... indices>
+    std::shared_ptr<Message> LinearMessageFactory(const int id, std::index_sequence<indices...>)
+    {
+        std::shared_ptr<Message> output = nullptr;
+        ((id == std::tuple_element_t<indices, TypesTuple>::packet_id ? (output = std::make_shared<std::tuple_element_t<indices, TypesTuple> >(), 0) : 0), ...);
+        return output;
+    }
+
+    /// @brief Read the id of a message, create it and read its content, like botcraft NetworkManager does
+    template<typename Factory>
+    std::shared_ptr<Message> CreateAndRead(Factory factory, const std::vector<unsigned char>& data)
+    {
+        ReadIterator iter = data.begin();
+        size_t length = data.size();
+        const int id = ReadData<VarInt>(iter, length);
+        std::shared_ptr<Message> msg = factory(id);
+        msg->Read(iter, length);
+        return msg;
+    }
+}
+
+TEST_CASE("Message factory")
+{
+    CHECK(CheckAllMessagesCreated<AllClientboundLoginMessages>(ConnectionState::Login, &CreateClientboundMessage));
+    CHECK(CheckAllMessagesCreated<AllClientboundStatusMessages>(ConnectionState::Status, &CreateClientboundMessage));
+    CHECK(CheckAllMessagesCreated<AllClientboundPlayMessages>(ConnectionState::Play, &CreateClientboundMessage));
+    CHECK(CheckAllMessagesCreated<AllServerboundHandshakeMessages>(ConnectionState::Handshake, &CreateServerboundMessage));
+    CHECK(CheckAllMessagesCreated<AllServerboundLoginMessages>(ConnectionState::Login, &CreateServerboundMessage));
+    CHECK(CheckAllMessagesCreated<AllServerboundStatusMessages>(ConnectionState::Status, &CreateServerboundMessage));
+    CHECK(CheckAllMessagesCreated<AllServerboundPlayMessages>(ConnectionState::Play, &CreateServerboundMessage));
+#if PROTOCOL_VERSION > 763 /* > 1.20.1 */
+    CHECK(CheckAllMessagesCreated<AllClientboundConfigurationMessages>(ConnectionState::Configuration, &CreateClientboundMessage));
+    CHECK(CheckAllMessagesCreated<AllServerboundConfigurationMessages>(ConnectionState::Configuration, &CreateServerboundMessage));
+#endif
+
+    CHECK(CreateClientboundMessage(ConnectionState::Play, -1) == nullptr);
+    CHECK(CreateClientboundMessage(ConnectionState::Play, 0x7FFF) == nullptr);
+    CHECK(CreateClientboundMessage(ConnectionState::None, ClientboundKeepAlivePacket::packet_id) == nullptr);
+    CHECK(CreateClientboundMessage(ConnectionState::Play, ClientboundKeepAlivePacket::packet_id)->GetId() == ClientboundKeepAlivePacket::packet_id);
+}
+
+TEST_CASE("Message factory benchmark", "[.][benchmark]")
+{
+    auto table_factory = [](const int id) { return CreateClientboundMessage(ConnectionState::Play, id); };
+    auto linear_factory = [](const int id) { return LinearMessageFactory<AllClientboundPlayMessages>(id, std::make_index_sequence<std::tuple_size_v<AllClientboundPlayMessages>>{}); };
+
+    ClientboundKeepAlivePacket keep_alive;
+    keep_alive.SetId_(42);
+    ClientboundSetTimePacket set_time;
+    set_time.SetGameTime(123456);
+    set_time.SetDayTime(6000);
+
+    for (const Message* msg : std::initializer_list<const Message*>{ &keep_alive, &set_time })
+    {
+        std::vector<unsigned char> data;
+        msg->Write(data);
+
+        BENCHMARK(std::string(msg->GetName()) + " create + read, table")
+        {
+            return CreateAndRead(table_factory, data);
+        };
+
+        BENCHMARK(std::string(msg->GetName()) + " create + read, linear search")
+        {
+            return CreateAndRead(linear_factory, data);
+        };
+
+        MessagePool pool;
+        BENCHMARK(std::string(msg->GetName()) + " create + read, pooled")
+        {
+            // Returned message is released before the next iteration and can be reused
+            return CreateAndRead([&pool](const int id) { return pool.CreateClientboundMessage(ConnectionState::Play, id); }, data)->GetId();
+        };
+    }
+
+    BENCHMARK("All play packet ids, table")
+    {
+        int num_created = 0;
+        for (int id = 0; id < 0x80; ++id)
+        {
+            num_created += table_factory(id) != nullptr;
+        }
+        return num_created;
+    };
+
+    BENCHMARK("All play packet ids, linear search")
+    {
+        int num_created = 0;
+        for (int id = 0; id < 0x80; ++id)
+        {
+            num_created += linear_factory(id) != nullptr;
+        }
+        return num_created;
+    };
+}
+
+TEST_CASE("Message pool")
+{
+    MessagePool pool(2);
+
+    std::shared_ptr<Message> first = pool.CreateClientboundMessage(ConnectionState::Play, ClientboundSetTimePacket::packet_id);
+    REQUIRE(first != nullptr);
+    std::static_pointer_cast<ClientboundSetTimePacket>(first)->SetGameTime(42);
+    const Message* first_address = first.get();
+    first.reset();
+
+    SECTION("Released messages are reused and reset")
+    {
+        std::shared_ptr<Message> second = pool.CreateClientboundMessage(ConnectionState::Play, ClientboundSetTimePacket::packet_id);
+        CHECK(second.get() == first_address);
+        CHECK(std::static_pointer_cast<ClientboundSetTimePacket>(second)->GetGameTime() == ClientboundSetTimePacket().GetGameTime());
+        CHECK(pool.GetNumAllocations() == 1);
+        CHECK(pool.GetNumReused() == 1);
+    }
+
+    SECTION("Messages still in use are not reused")
+    {
+        std::shared_ptr<Message> second = pool.CreateClientboundMessage(ConnectionState::Play, ClientboundSetTimePacket::packet_id);
+        std::shared_ptr<Message> third = pool.CreateClientboundMessage(ConnectionState::Play, ClientboundSetTimePacket::packet_id);
+        std::shared_ptr<Message> fourth = pool.CreateClientboundMessage(ConnectionState::Play, ClientboundSetTimePacket::packet_id);
+        CHECK(second != third);
+        CHECK(third != fourth);
+        CHECK(pool.GetNumAllocations() == 3);
+        fourth.reset();
+        third.reset();
+        // fourth was not pooled (max 2 per type), third is reused
+        std::shared_ptr<Message> fifth = pool.CreateClientboundMessage(ConnectionState::Play, ClientboundSetTimePacket::packet_id);
+        CHECK(pool.GetNumAllocations() == 3);
+    }
+
+    SECTION("Different types are not mixed")
+    {
+        std::shared_ptr<Message> keep_alive = pool.CreateClientboundMessage(ConnectionState::Play, ClientboundKeepAlivePacket::packet_id);
+        CHECK(dynamic_cast<ClientboundKeepAlivePacket*>(keep_alive.get()) != nullptr);
+        CHECK(pool.CreateClientboundMessage(ConnectionState::Play, -1) == nullptr);
+        CHECK(pool.CreateClientboundMessage(ConnectionState::Play, 0x7FFF) == nullptr);
+    }
+
+    SECTION("Invalid ids")
+    {
+        // Must not try to grow the pool up to the id
+        CHECK(pool.CreateClientboundMessage(ConnectionState::Play, std::numeric_limits<int>::max()) == nullptr);
+        CHECK(pool.CreateClientboundMessage(ConnectionState::Handshake, 0) == nullptr);
+        CHECK(pool.GetNumAllocations() == 1);
+    }
+}
+
+namespace
+{
+    std::vector<unsigned char> CreateAdvancementsData(const int num_removed)
+    {
+        std::vector<Identifier> removed(num_removed);
+        for (int i = 0; i < num_removed; ++i)
+        {
+            removed[i].SetNamespace("botcraft");
+            removed[i].SetName("advancement_" + std::to_string(i));
+        }
+        ClientboundUpdateAdvancementsPacket msg;
+        msg.SetReset(true);
+        msg.SetRemoved(removed);
+
+        std::vector<unsigned char> output;
+        msg.Write(output);
+        return output;
+    }
+}
+
+TEST_CASE("Lazy parsing")
+{
+    const std::vector<unsigned char> data = CreateAdvancementsData(10);
+
+    ReadIterator iter = data.begin();
+    size_t length = data.size();
+    REQUIRE(ReadData<VarInt>(iter, length) == ClientboundUpdateAdvancementsPacket::packet_id);
+
+    SECTION("Lazy parsable message")
+    {
+        ClientboundUpdateAdvancementsPacket msg;
+        CHECK(msg.IsLazyParsable());
+        msg.ReadLazy(iter, length);
+        // All data are consumed, even if not parsed yet
+        CHECK(length == 0);
+        CHECK(iter == data.end());
+        CHECK_FALSE(msg.IsParsed());
+
+        CHECK(msg.GetReset());
+        CHECK(msg.IsParsed());
+        REQUIRE(msg.GetRemoved().size() == 10);
+        CHECK(msg.GetRemoved()[3].GetName() == "advancement_3");
+
+        // Writing it back gives the same data
+        std::vector<unsigned char> written;
+        msg.Write(written);
+        CHECK(written == data);
+    }
+
+    SECTION("Write parses the data")
+    {
+        ClientboundUpdateAdvancementsPacket msg;
+        msg.ReadLazy(iter, length);
+        std::vector<unsigned char> written;
+        msg.Write(written);
+        CHECK(written == data);
+        CHECK(msg.IsParsed());
+    }
+
+    SECTION("Setters don't lose data")
+    {
+        ClientboundUpdateAdvancementsPacket msg;
+        msg.ReadLazy(iter, length);
+        msg.SetReset(false);
+        CHECK_FALSE(msg.GetReset());
+        CHECK(msg.GetRemoved().size() == 10);
+    }
+
+    SECTION("Invalid data")
+    {
+        ClientboundUpdateAdvancementsPacket msg;
+        // Truncated data, can't be parsed
+        size_t truncated_length = length / 2;
+        msg.ReadLazy(iter, truncated_length);
+        CHECK_THROWS(msg.GetRemoved());
+        // Still not parsed, next access fails again instead of returning partial data
+        CHECK_FALSE(msg.IsParsed());
+        CHECK_THROWS(msg.GetRemoved());
+    }
+
+    SECTION("Other messages are parsed immediately")
+    {
+        std::vector<unsigned char> keep_alive_data;
+        ClientboundKeepAlivePacket keep_alive;
+        keep_alive.SetId_(42);
+        keep_alive.Write(keep_alive_data);
+
+        ReadIterator keep_alive_iter = keep_alive_data.begin();
+        size_t keep_alive_length = keep_alive_data.size();
+        ReadData<VarInt>(keep_alive_iter, keep_alive_length);
+
+        ClientboundKeepAlivePacket msg;
+        CHECK_FALSE(msg.IsLazyParsable());
+        msg.ReadLazy(keep_alive_iter, keep_alive_length);
+        CHECK(msg.IsParsed());
+        CHECK(msg.GetId_() == 42);
+    }
+}
+
+#if PROTOCOL_VERSION > 756 /* > 1.17.1 */
+TEST_CASE("Skip chunk light data")
+{
+    ClientboundLightUpdatePacketData light_data;
+    light_data.SetSkyYMask({ 0b110 });
+    light_data.SetEmptySkyYMask({ 0b1 });
+    light_data.SetBlockYMask({ 0b10, 0 });
+    light_data.SetEmptyBlockYMask({});
+    std::vector<std::vector<char> > sky_updates(2, std::vector<char>(2048, 0x42));
+    std::vector<std::vector<char> > block_updates(1, std::vector<char>(2048, 0x11));
+    light_data.SetSkyUpdates(sky_updates);
+    light_data.SetBlockUpdates(block_updates);
+
+    ClientboundLevelChunkPacketData chunk_data;
+    chunk_data.SetBuffer(std::vector<unsigned char>(100, 0x07));
+
+    ClientboundLevelChunkWithLightPacket msg;
+    msg.SetX(-3);
+    msg.SetZ(12);
+    msg.SetChunkData(chunk_data);
+    msg.SetLightData(light_data);
+
+    std::vector<unsigned char> data;
+    msg.Write(data);
+
+    ReadIterator iter = data.begin();
+    size_t length = data.size();
+    REQUIRE(ReadData<VarInt>(iter, length) == ClientboundLevelChunkWithLightPacket::packet_id);
+
+    SECTION("Read")
+    {
+        ClientboundLevelChunkWithLightPacket read;
+        read.Read(iter, length);
+        CHECK(length == 0);
+        CHECK(read.GetLightData().GetSkyUpdates().size() == 2);
+        CHECK(read.GetLightData().GetBlockUpdates().size() == 1);
+    }
+
+    SECTION("Skip")
+    {
+        ClientboundLevelChunkWithLightPacket read;
+        read.SetSkipLightData(true);
+        read.Read(iter, length);
+        CHECK(length == 0);
+        CHECK(iter == data.end());
+        CHECK(read.GetX() == -3);
+        CHECK(read.GetZ() == 12);
+        CHECK(read.GetChunkData().GetBuffer() == chunk_data.GetBuffer());
+        CHECK(read.GetLightData().GetSkyYMask().empty());
+        CHECK(read.GetLightData().GetSkyUpdates().empty());
+        CHECK(read.GetLightData().GetBlockUpdates().empty());
+    }
+
+    SECTION("Truncated data")
+    {
+        ClientboundLevelChunkWithLightPacket read;
+        read.SetSkipLightData(true);
+        length -= 1;
+        CHECK_THROWS(read.Read(iter, length));
+    }
+}
+#endif
+
+TEST_CASE("Lazy parsing benchmark", "[.][benchmark]")
+{
+    const std::vector<unsigned char> data = CreateAdvancementsData(2000);
+
+    BENCHMARK("Read")
+    {
+        ClientboundUpdateAdvancementsPacket msg;
+        ReadIterator iter = data.begin() + 1;
+        size_t length = data.size() - 1;
+        msg.Read(iter, length);
+        return msg.IsParsed();
+    };
+
+    BENCHMARK("ReadLazy")
+    {
+        ClientboundUpdateAdvancementsPacket msg;
+        ReadIterator iter = data.begin() + 1;
+        size_t length = data.size() - 1;
+        msg.ReadLazy(iter, length);
+        return msg.IsParsed();
+    };
+}